@@ -0,0 +1,351 @@
+#include <cmath>
+#include <cstring>
+#include <ferrugo/core/ansi.hpp>
+#include <ferrugo/core/raster.hpp>
+#include <ferrugo/core/utf8.hpp>
+#include <sstream>
+
+#include "bench.hpp"
+
+using namespace ferrugo;
+
+// Every cell gets its own foreground and background, so each glyph costs a full style transition.
+void fill_gradient(core::area_t& area, int phase)
+{
+    auto ref = area.mut_ref();
+    for (int y = 0; y < area.m_extent.height; ++y)
+    {
+        for (int x = 0; x < area.m_extent.width; ++x)
+        {
+            const auto r = static_cast<std::uint8_t>(x + phase);
+            const auto g = static_cast<std::uint8_t>(y * 3 + phase);
+            const auto b = static_cast<std::uint8_t>(x ^ y);
+            const auto ch = static_cast<char32_t>('a' + (x + y + phase) % 26);
+            ref[core::location_t{ x, y }] = core::glyph_t{ core::character_t{ ch },
+                                                           core::glyph_style_t{ core::true_color_t{ r, g, b },
+                                                                                core::true_color_t{ b, r, g },
+                                                                                core::modes_t{ core::mode::none } } };
+        }
+    }
+}
+
+void bench_frame()
+{
+    core::area_t area{ { 256, 80 } };
+    fill_gradient(area, 0);
+
+    std::cout << "256x80 true color frame" << std::endl;
+    std::ostringstream stream;
+    std::size_t bytes = 0;
+    bench::run(
+        "  output",
+        200,
+        [&]
+        {
+            stream.str({});
+            core::buffer_t buffer{ stream };
+            core::output(area.ref(), buffer);
+            bytes = stream.tellp();
+        });
+    std::cout << "    " << bytes << " bytes" << std::endl;
+
+    for (const auto& [name, depth] : { std::pair{ "  output, 256 colors", core::color_depth_t::palette_256 },
+                                       std::pair{ "  output, 16 colors", core::color_depth_t::basic_16 } })
+    {
+        bench::run(
+            name,
+            200,
+            [&, depth = depth]
+            {
+                stream.str({});
+                core::buffer_t buffer{ stream };
+                buffer.m_color_depth = depth;
+                core::output(area.ref(), buffer);
+                bytes = stream.tellp();
+            });
+        std::cout << "    " << bytes << " bytes" << std::endl;
+    }
+
+    core::diff_renderer_t renderer{};
+    bench::run(
+        "  diff_renderer_t full redraw",
+        200,
+        [&]
+        {
+            renderer.invalidate();
+            bytes = renderer.render(area.ref()).size();
+        });
+    std::cout << "    " << bytes << " bytes" << std::endl;
+
+    // Every 8th row changes, as in a dashboard updating a few panels.
+    core::area_t next{ area.m_extent };
+    fill_gradient(next, 0);
+    for (int y = 0; y < next.m_extent.height; y += 8)
+    {
+        for (int x = 0; x < next.m_extent.width; ++x)
+        {
+            next.mut_ref()[core::location_t{ x, y }].character = core::character_t{ '#' };
+        }
+    }
+    int frame = 0;
+    bench::run(
+        "  diff_renderer_t partial update",
+        200,
+        [&]
+        {
+            bytes = renderer.render((++frame % 2 ? next : area).ref()).size();
+        });
+    std::cout << "    " << bytes << " bytes" << std::endl;
+    renderer.render(area.ref());
+    bench::run(
+        "  diff_renderer_t unchanged frame",
+        200,
+        [&]
+        {
+            bytes = renderer.render(area.ref()).size();
+            bench::do_not_optimize(bytes);
+        });
+}
+
+void bench_fill()
+{
+    core::area_t area{ { 400, 120 } };
+    std::cout << "400x120 back buffer" << std::endl;
+    const auto glyph = core::glyph_t{ core::character_t{ '.' },
+                                      core::glyph_style_t{ core::true_color_t{ 64, 0, 0 }, core::true_color_t{ 0, 0, 0 } } };
+    bench::run(
+        "  fill",
+        200,
+        [&]
+        {
+            area.mut_ref().fill(glyph);
+            bench::clobber();
+        });
+
+    core::area_t panel{ { 200, 60 } };
+    panel.mut_ref().fill(glyph);
+    bench::run(
+        "  blit 200x60, per cell",
+        200,
+        [&]
+        {
+            const auto dst = area.mut_ref();
+            for (int y = 0; y < panel.m_extent.height; ++y)
+            {
+                for (int x = 0; x < panel.m_extent.width; ++x)
+                {
+                    dst[core::location_t{ x + 10, y + 10 }] = panel.ref()[core::location_t{ x, y }];
+                }
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  blit 200x60",
+        200,
+        [&]
+        {
+            area.mut_ref().blit(panel.ref(), core::location_t{ 10, 10 });
+            bench::clobber();
+        });
+    bench::run(
+        "  scroll",
+        200,
+        [&]
+        {
+            area.mut_ref().scroll(1, glyph);
+            bench::clobber();
+        });
+}
+
+// A chart expensive enough per cell to be worth spreading over threads.
+void plot(const core::area_t::mut_ref_type& view, core::location_t origin, int frame)
+{
+    for (int y = 0; y < view.m_extent.height; ++y)
+    {
+        for (int x = 0; x < view.m_extent.width; ++x)
+        {
+            float v = 0.F;
+            for (int k = 1; k <= 16; ++k)
+            {
+                v += std::sin(0.05F * k * (origin.x + x) + 0.1F * (origin.y + y) + 0.01F * frame) / k;
+            }
+            const auto level = static_cast<std::uint8_t>(static_cast<int>(std::clamp(128.F + 64.F * v, 0.F, 255.F)) & 0xF0);
+            view[core::location_t{ x, y }] = core::glyph_t{ core::character_t{ '#' },
+                                                            core::glyph_style_t{ core::true_color_t{ level, 0, 0 } } };
+        }
+    }
+}
+
+void bench_tiles()
+{
+    core::area_t area{ { 400, 120 } };
+    core::thread_pool_t pool{};
+    std::cout << "400x120 chart, " << pool.size() << " threads" << std::endl;
+    int frame = 0;
+    bench::run(
+        "  sequential",
+        50,
+        [&]
+        {
+            plot(area.mut_ref(), core::location_t{}, ++frame);
+            bench::clobber();
+        });
+    const auto tiles = area.mut_ref().tiles(core::extent_t{ 100, 30 });
+    bench::run(
+        "  render_parallel, 100x30 tiles",
+        50,
+        [&]
+        {
+            ++frame;
+            core::render_parallel(
+                pool,
+                tiles,
+                [&](const core::area_t::mut_ref_type& tile, std::size_t i)
+                {
+                    const auto origin = core::location_t{ static_cast<int>(i % 4) * 100, static_cast<int>(i / 4) * 30 };
+                    plot(tile, origin, frame);
+                });
+            bench::clobber();
+        });
+}
+
+void bench_style()
+{
+    std::vector<core::glyph_t> glyphs(400 * 120);
+    std::cout << "styling " << glyphs.size() << " glyphs" << std::endl;
+    bench::run(
+        "  'x' | fg | bg | mode",
+        50,
+        [&]
+        {
+            for (std::size_t i = 0; i < glyphs.size(); ++i)
+            {
+                const auto level = static_cast<std::uint8_t>(i);
+                glyphs[i] = 'x' | core::fg(core::true_color_t{ level, 0, 0 }) | core::bg(core::basic_color_t::black)
+                            | core::mode::bold;
+            }
+            bench::clobber();
+        });
+}
+
+void bench_raster()
+{
+    const core::extent_t size{ 1000, 500 };
+    std::vector<float> chart(static_cast<std::size_t>(size.width * size.height));
+    for (int y = 0; y < size.height; ++y)
+    {
+        for (int x = 0; x < size.width; ++x)
+        {
+            const float curve = 250.F + 200.F * std::sin(static_cast<float>(x) * 0.02F);
+            chart[y * size.width + x] = std::exp(-std::abs(static_cast<float>(y) - curve) * 0.1F);
+        }
+    }
+    const core::image_ref_t<float> image{ chart.data(), size };
+    std::cout << "rasterizing a " << size.width << "x" << size.height << " px chart" << std::endl;
+
+    core::area_t braille{ { size.width / 2, size.height / 4 } };
+    bench::run(
+        "  braille, 500x125 cells",
+        200,
+        [&]
+        {
+            core::rasterize_braille(image, 0.5F, core::glyph_style_t{ core::true_color_t{ 0, 255, 0 } }, braille.mut_ref());
+            bench::clobber();
+        });
+    bench::run(
+        "  braille, 100x100 px dirty",
+        200,
+        [&]
+        {
+            core::rasterize_braille(
+                image, 0.5F, {}, braille.mut_ref(), core::bounds_t{ { 450, 200 }, { 100, 100 } });
+            bench::clobber();
+        });
+
+    std::vector<core::true_color_t> colormap(64);
+    for (std::size_t i = 0; i < colormap.size(); ++i)
+    {
+        colormap[i] = core::true_color_t{ static_cast<std::uint8_t>(i * 4), static_cast<std::uint8_t>(255 - i * 4), 64 };
+    }
+    core::area_t blocks{ { size.width, size.height / 2 } };
+    bench::run(
+        "  half blocks, 64 colors, 1000x250 cells",
+        50,
+        [&]
+        {
+            core::rasterize_half_blocks(image, colormap, blocks.mut_ref());
+            bench::clobber();
+        });
+
+    std::vector<float> small(static_cast<std::size_t>(size.width * size.height / 4));
+    core::area_t small_blocks{ { size.width / 2, size.height / 4 } };
+    bench::run(
+        "  downsample 2x2 + half blocks, 500x125 cells",
+        200,
+        [&]
+        {
+            const auto extent = core::downsample(image, 2, 2, small.data());
+            core::rasterize_half_blocks(core::image_ref_t<float>{ small.data(), extent }, colormap, small_blocks.mut_ref());
+            bench::clobber();
+        });
+}
+
+void bench_decode(const char* title, const std::string& text)
+{
+    std::cout << title << ", " << text.size() << " bytes" << std::endl;
+    std::string copy(text.size(), '\0');
+    bench::run(
+        "  memcpy",
+        200,
+        [&]
+        {
+            std::memcpy(copy.data(), text.data(), text.size());
+            bench::clobber();
+        });
+    bool valid = false;
+    bench::run(
+        "  utf8_valid",
+        200,
+        [&]
+        {
+            valid = core::utf8_valid(text);
+            bench::do_not_optimize(valid);
+        });
+    std::size_t count = 0;
+    bench::run(
+        "  utf8_to_u32",
+        200,
+        [&]
+        {
+            count = core::utf8_to_u32(text).size();
+            bench::do_not_optimize(count);
+        });
+    bench::run(
+        "  multibyte_string",
+        200,
+        [&]
+        {
+            count = core::multibyte_string{ text }.size();
+            bench::do_not_optimize(count);
+        });
+    std::cout << "    " << count << " code points" << std::endl;
+}
+
+int main()
+{
+    bench_frame();
+    bench_fill();
+    bench_tiles();
+    bench_style();
+    bench_raster();
+
+    std::string ascii;
+    std::string mixed;
+    while (ascii.size() < (1 << 20))
+    {
+        ascii += "The quick brown fox jumps over the lazy dog. ";
+        mixed += "Zażółć gęślą jaźń ⠺⠽⠯⠗ ☢ ";
+    }
+    bench_decode("ascii text", ascii);
+    bench_decode("mixed text", mixed);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string_view>
+
+namespace bench
+{
+
+template <class T>
+void do_not_optimize(T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber()
+{
+    asm volatile("" : : : "memory");
+}
+
+// Runs `func` `iterations` times and prints the mean time per iteration.
+template <class Func>
+double run(std::string_view name, std::size_t iterations, Func&& func)
+{
+    for (std::size_t i = 0; i < iterations / 10 + 1; ++i)
+    {
+        func();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        func();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+    std::cout << name << ": " << ns << " ns/iter" << std::endl;
+    return ns;
+}
+
+}  // namespace bench
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <ferrugo/core/ranges.hpp>
+#include <deque>
+#include <numeric>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace ferrugo;
+
+int main()
+{
+    std::vector<int> values(1'000'000);
+    std::iota(values.begin(), values.end(), 0);
+    const core::random_access_iterable<int> range = values;
+    const core::forward_iterable<int> forward = values;
+    const core::random_access_iterable<int> deque = std::deque<int>(values.begin(), values.end());
+
+    std::cout << "sum of " << values.size() << " ints" << std::endl;
+    long long sum = 0;
+    bench::run(
+        "  std::vector",
+        20,
+        [&]
+        {
+            sum = std::accumulate(values.begin(), values.end(), 0LL);
+            bench::do_not_optimize(sum);
+        });
+    bench::run(
+        "  forward_iterable",
+        20,
+        [&]
+        {
+            sum = std::accumulate(forward.begin(), forward.end(), 0LL);
+            bench::do_not_optimize(sum);
+        });
+    bench::run(
+        "  random_access_iterable",
+        20,
+        [&]
+        {
+            sum = std::accumulate(range.begin(), range.end(), 0LL);
+            bench::do_not_optimize(sum);
+        });
+    const auto sum_segments = [&](const core::random_access_iterable<int>& r)
+    {
+        sum = 0;
+        r.for_each_segment(
+            [&](core::random_access_iterable<int>::segment_type segment)
+            { sum = std::accumulate(segment.begin(), segment.end(), sum); });
+        bench::do_not_optimize(sum);
+    };
+    bench::run("  random_access_iterable, segments", 20, [&] { sum_segments(range); });
+    bench::run(
+        "  random_access_iterable over std::deque, iterators",
+        20,
+        [&]
+        {
+            sum = std::accumulate(deque.begin(), deque.end(), 0LL);
+            bench::do_not_optimize(sum);
+        });
+    bench::run("  random_access_iterable over std::deque, copy_out", 20, [&] { sum_segments(deque); });
+
+    std::cout << "10000 binary searches" << std::endl;
+    std::ptrdiff_t found = 0;
+    bench::run(
+        "  std::vector",
+        20,
+        [&]
+        {
+            for (int i = 0; i < 10000; ++i)
+            {
+                found += std::lower_bound(values.begin(), values.end(), i * 97) - values.begin();
+            }
+            bench::do_not_optimize(found);
+        });
+    bench::run(
+        "  random_access_iterable",
+        20,
+        [&]
+        {
+            for (int i = 0; i < 10000; ++i)
+            {
+                found += std::lower_bound(range.begin(), range.end(), i * 97) - range.begin();
+            }
+            bench::do_not_optimize(found);
+        });
+    bench::run(
+        "  random_access_iterable, segment",
+        20,
+        [&]
+        {
+            const auto segment = range.segment();
+            for (int i = 0; i < 10000; ++i)
+            {
+                found += std::lower_bound(segment.begin(), segment.end(), i * 97) - segment.begin();
+            }
+            bench::do_not_optimize(found);
+        });
+}
@@ -0,0 +1,64 @@
+#include <ferrugo/core/math.hpp>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace ferrugo;
+
+template <class T, class Func, class Ref>
+void bench_batch(std::string_view name, const std::vector<T>& input, Func func, Ref ref)
+{
+    std::vector<T> output(input.size());
+    std::cout << name << std::endl;
+    bench::run(
+        "  std",
+        20,
+        [&]
+        {
+            for (std::size_t i = 0; i < input.size(); ++i)
+            {
+                output[i] = ref(input[i]);
+            }
+            bench::clobber();
+        });
+    for (const auto& [label, acc] : { std::pair{ "  ulp1", math::accuracy::ulp1 },
+                                      std::pair{ "  ulp4", math::accuracy::ulp4 },
+                                      std::pair{ "  fast", math::accuracy::fast } })
+    {
+        bench::run(
+            label,
+            20,
+            [&]
+            {
+                func(std::span<const T>{ input }, std::span<T>{ output }, acc);
+                bench::clobber();
+            });
+    }
+}
+
+template <class T>
+std::vector<T> random_values(T first, T last, std::mt19937& gen)
+{
+    constexpr std::size_t count = 1'000'000;
+    std::uniform_real_distribution<T> dist{ first, last };
+    std::vector<T> result(count);
+    for (auto& v : result)
+    {
+        v = dist(gen);
+    }
+    return result;
+}
+
+int main()
+{
+    std::mt19937 gen{ 42 };
+    const auto angles = random_values<float>(-100.F, 100.F, gen);
+    const auto ratios = random_values<float>(-1.F, 1.F, gen);
+    const auto angles_d = random_values<double>(-100.0, 100.0, gen);
+    bench_batch("sin, 1M float", angles, math::sin, [](float x) { return std::sin(x); });
+    bench_batch("cos, 1M float", angles, math::cos, [](float x) { return std::cos(x); });
+    bench_batch("tan, 1M float", angles, math::tan, [](float x) { return std::tan(x); });
+    bench_batch("asin, 1M float", ratios, math::asin, [](float x) { return std::asin(x); });
+    bench_batch("sin, 1M double", angles_d, math::sin, [](double x) { return std::sin(x); });
+}
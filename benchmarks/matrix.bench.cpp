@@ -0,0 +1,333 @@
+#include <ferrugo/core/arrays/array.hpp>
+#include <ferrugo/core/arrays/quaternion.hpp>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace ferrugo;
+
+template <class T, std::size_t R, std::size_t D, std::size_t C>
+auto generic_multiply(const core::matrix<T, core::size<R, D>>& lhs, const core::matrix<T, core::size<D, C>>& rhs)
+    -> core::matrix<T, core::size<R, C>>
+{
+    core::matrix<T, core::size<R, C>> result{};
+    for (std::size_t r = 0; r < R; ++r)
+    {
+        for (std::size_t c = 0; c < C; ++c)
+        {
+            T sum = {};
+            for (std::size_t i = 0; i < D; ++i)
+            {
+                sum += lhs[{ r, i }] * rhs[{ i, c }];
+            }
+            result[{ r, c }] = sum;
+        }
+    }
+    return result;
+}
+
+template <class T, std::size_t D>
+auto random_matrix(std::mt19937& gen) -> core::square_matrix<T, D>
+{
+    std::uniform_real_distribution<double> dist{ -1.0, 1.0 };
+    core::square_matrix<T, D> result{};
+    for (std::size_t i = 0; i < D * D; ++i)
+    {
+        result[i] = static_cast<T>(dist(gen));
+    }
+    return result;
+}
+
+template <class T, std::size_t D>
+void bench_multiply(std::string_view name, std::mt19937& gen)
+{
+    constexpr std::size_t iterations = 1'000'000;
+    auto lhs = random_matrix<T, D>(gen);
+    const auto rhs = random_matrix<T, D>(gen);
+    std::cout << name << std::endl;
+    bench::run(
+        "  generic",
+        iterations,
+        [&]
+        {
+            bench::do_not_optimize(lhs);
+            auto result = generic_multiply(lhs, rhs);
+            bench::do_not_optimize(result);
+        });
+    bench::run(
+        "  operator*",
+        iterations,
+        [&]
+        {
+            bench::do_not_optimize(lhs);
+            auto result = lhs * rhs;
+            bench::do_not_optimize(result);
+        });
+}
+
+template <class T, std::size_t D>
+void bench_invert(std::string_view name, std::mt19937& gen)
+{
+    auto m = random_matrix<T, D>(gen);
+    for (std::size_t i = 0; i < D; ++i)
+    {
+        m[{ i, i }] += T(D);
+    }
+    std::cout << name << std::endl;
+    bench::run(
+        "  invert",
+        100'000,
+        [&]
+        {
+            bench::do_not_optimize(m);
+            auto result = core::invert(m);
+            bench::do_not_optimize(result);
+        });
+}
+
+template <class T, std::size_t D>
+auto eager_axpy(const core::square_matrix<T, D>& a, const core::square_matrix<T, D>& b, const core::square_matrix<T, D>& c)
+    -> core::square_matrix<T, D>
+{
+    core::square_matrix<T, D> scaled{ core::uninitialized };
+    std::transform(std::begin(b.m_data), std::end(b.m_data), std::begin(scaled.m_data), [](T v) { return v * T(2); });
+    core::square_matrix<T, D> sum{ core::uninitialized };
+    std::transform(
+        std::begin(a.m_data), std::end(a.m_data), std::begin(scaled.m_data), std::begin(sum.m_data), std::plus<>{});
+    core::square_matrix<T, D> result{ core::uninitialized };
+    std::transform(
+        std::begin(sum.m_data), std::end(sum.m_data), std::begin(c.m_data), std::begin(result.m_data), std::minus<>{});
+    return result;
+}
+
+template <class T, std::size_t D>
+void bench_elementwise(std::string_view name, std::mt19937& gen)
+{
+    constexpr std::size_t iterations = 200'000;
+    auto a = random_matrix<T, D>(gen);
+    const auto b = random_matrix<T, D>(gen);
+    const auto c = random_matrix<T, D>(gen);
+    std::cout << name << " a + b * 2 - c" << std::endl;
+    bench::run(
+        "  eager",
+        iterations,
+        [&]
+        {
+            bench::do_not_optimize(a);
+            auto result = eager_axpy(a, b, c);
+            bench::do_not_optimize(result);
+        });
+    bench::run(
+        "  lazy",
+        iterations,
+        [&]
+        {
+            using core::detail::lazy_elementwise;
+            bench::do_not_optimize(a);
+            core::square_matrix<T, D> result = lazy_elementwise(
+                std::minus<>{}, lazy_elementwise(std::plus<>{}, a, lazy_elementwise(std::multiplies<>{}, b, T(2))), c);
+            bench::do_not_optimize(result);
+        });
+    bench::run(
+        "  lazy() operators",
+        iterations,
+        [&]
+        {
+            bench::do_not_optimize(a);
+            core::square_matrix<T, D> result = core::lazy(a) + core::lazy(b) * T(2) - c;
+            bench::do_not_optimize(result);
+        });
+}
+
+void bench_transform_points(std::mt19937& gen)
+{
+    constexpr std::size_t count = 1'000'000;
+    std::uniform_real_distribution<float> dist{ -100.F, 100.F };
+    std::vector<core::vector_3d<float>> points(count);
+    for (auto& p : points)
+    {
+        p = core::vector_3d<float>{ dist(gen), dist(gen), dist(gen) };
+    }
+    std::vector<core::vector_3d<float>> out(count);
+    const auto m = random_matrix<float, 4>(gen);
+
+    std::cout << "transform 1M vector_3d<float>" << std::endl;
+    bench::run(
+        "  vector * matrix",
+        20,
+        [&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out[i] = points[i] * m;
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  transform_points",
+        20,
+        [&]
+        {
+            core::transform_points(points.data(), points.data() + count, out.data(), m);
+            bench::clobber();
+        });
+}
+
+void bench_point_cloud(std::mt19937& gen)
+{
+    constexpr std::size_t count = 1'000'000;
+    std::uniform_real_distribution<float> dist{ -100.F, 100.F };
+    std::vector<core::vector_3d<float>> points(count);
+    for (auto& p : points)
+    {
+        p = core::vector_3d<float>{ dist(gen), dist(gen), dist(gen) };
+    }
+    const auto soa = core::soa_vectors<float, 3>{ points.begin(), points.end() };
+    const auto query = core::vector_3d<float>{ 1.F, 2.F, 3.F };
+    std::vector<float> aos_out(count);
+    core::soa_vectors<float, 3>::component_type soa_out(count);
+
+    std::cout << "distance to a point, 1M vector_3d<float>" << std::endl;
+    bench::run(
+        "  aos",
+        20,
+        [&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                aos_out[i] = core::distance(points[i], query);
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  soa",
+        20,
+        [&]
+        {
+            core::distance(soa, query, soa_out.data());
+            bench::clobber();
+        });
+
+    std::cout << "normalize, 1M vector_3d<float>" << std::endl;
+    auto aos_copy = points;
+    auto soa_copy = soa;
+    bench::run(
+        "  aos",
+        20,
+        [&]
+        {
+            for (auto& p : aos_copy)
+            {
+                core::normalize(p);
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  soa",
+        20,
+        [&]
+        {
+            core::normalize(soa_copy);
+            bench::clobber();
+        });
+}
+
+template <class T>
+void bench_scene_graph(std::string_view name, std::size_t count, std::size_t iterations, std::mt19937& gen)
+{
+    std::uniform_real_distribution<T> dist{ -1, 1 };
+    std::vector<core::rigid_transform<T>> local(count);
+    for (auto& t : local)
+    {
+        const auto axis = core::unit(core::vector_3d<T>{ dist(gen), dist(gen), dist(gen) });
+        t = core::rigid_transform<T>{ core::quaternion<T>::from_axis_angle(axis, dist(gen)),
+                                      core::vector_3d<T>{ dist(gen), dist(gen), dist(gen) } };
+    }
+    std::vector<core::square_matrix_3d<T>> local_matrices(count);
+    std::transform(local.begin(), local.end(), local_matrices.begin(), core::to_matrix);
+
+    std::cout << name << " scene graph, binary tree of " << count << " nodes" << std::endl;
+    std::vector<core::square_matrix_3d<T>> world_matrices(count);
+    bench::run(
+        "  square_matrix_3d",
+        iterations,
+        [&]
+        {
+            world_matrices[0] = local_matrices[0];
+            for (std::size_t i = 1; i < count; ++i)
+            {
+                world_matrices[i] = local_matrices[i] * world_matrices[(i - 1) / 2];
+            }
+            bench::clobber();
+        });
+    std::vector<core::rigid_transform<T>> world(count);
+    bench::run(
+        "  rigid_transform",
+        iterations,
+        [&]
+        {
+            world[0] = local[0];
+            for (std::size_t i = 1; i < count; ++i)
+            {
+                world[i] = local[i] * world[(i - 1) / 2];
+            }
+            bench::clobber();
+        });
+}
+
+void bench_dyn_multiply(std::size_t n, std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> dist{ -1.0, 1.0 };
+    core::dyn_matrix<double> a(n, n);
+    core::dyn_matrix<double> b(n, n);
+    for (std::size_t i = 0; i < n * n; ++i)
+    {
+        a[i] = dist(gen);
+        b[i] = dist(gen);
+    }
+    std::cout << n << "x" << n << " dyn_matrix<double>" << std::endl;
+    bench::run(
+        "  1 thread",
+        3,
+        [&]
+        {
+            auto result = core::detail::dyn_multiply<double>(a.ref(), b.ref(), nullptr);
+            bench::do_not_optimize(result);
+        });
+    bench::run(
+        "  operator*",
+        3,
+        [&]
+        {
+            auto result = a * b;
+            bench::do_not_optimize(result);
+        });
+}
+
+int main()
+{
+    std::mt19937 gen{ 42 };
+    bench_multiply<float, 2>("2x2 float", gen);
+    bench_multiply<float, 3>("3x3 float", gen);
+    bench_multiply<float, 4>("4x4 float", gen);
+    bench_multiply<double, 2>("2x2 double", gen);
+    bench_multiply<double, 3>("3x3 double", gen);
+    bench_multiply<double, 4>("4x4 double", gen);
+    bench_multiply<double, 8>("8x8 double", gen);
+    bench_invert<double, 4>("4x4 double", gen);
+    bench_invert<double, 8>("8x8 double", gen);
+    bench_invert<double, 16>("16x16 double", gen);
+    bench_elementwise<float, 2>("2x2 float", gen);
+    bench_elementwise<float, 4>("4x4 float", gen);
+    bench_elementwise<float, 8>("8x8 float", gen);
+    bench_elementwise<float, 16>("16x16 float", gen);
+    bench_elementwise<float, 64>("64x64 float", gen);
+    bench_transform_points(gen);
+    bench_point_cloud(gen);
+    bench_scene_graph<float>("float", 4096, 1000, gen);
+    bench_scene_graph<double>("double", 4096, 1000, gen);
+    bench_scene_graph<float>("float", 1 << 20, 10, gen);
+    bench_scene_graph<double>("double", 1 << 20, 10, gen);
+    bench_dyn_multiply(512, gen);
+}
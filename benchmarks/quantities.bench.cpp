@@ -0,0 +1,146 @@
+#include <ferrugo/core/quantities.hpp>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace ferrugo;
+
+void bench_integrate(std::mt19937& gen)
+{
+    constexpr std::size_t count = 1'000'000;
+    std::uniform_real_distribution<double> dist{ -10.0, 10.0 };
+    std::vector<double> raw_x(count);
+    std::vector<double> raw_v(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        raw_x[i] = dist(gen);
+        raw_v[i] = dist(gen);
+    }
+    const double raw_dt = 0.01;
+
+    std::vector<quants::length_t<double>> aos_x(count);
+    std::vector<quants::velocity_t<double>> aos_v(count);
+    quants::length_array<double> x(count);
+    quants::velocity_array<double> v(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        aos_x[i] = quants::length_t<double>{ raw_x[i] };
+        aos_v[i] = quants::velocity_t<double>{ raw_v[i] };
+        x.set(i, aos_x[i]);
+        v.set(i, aos_v[i]);
+    }
+    const auto dt = quants::time_t<double>{ raw_dt };
+
+    std::cout << "x += v * dt, 1M double" << std::endl;
+    bench::run(
+        "  raw double",
+        100,
+        [&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                raw_x[i] += raw_v[i] * raw_dt;
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  std::vector<value_t>",
+        100,
+        [&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                aos_x[i] += aos_v[i] * dt;
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  quants::array",
+        100,
+        [&]
+        {
+            x += v * dt;
+            bench::clobber();
+        });
+}
+
+void bench_scalar_loops(std::mt19937& gen)
+{
+    constexpr std::size_t count = 1'000'000;
+    std::uniform_real_distribution<double> dist{ 0.5, 10.0 };
+    std::vector<double> raw_m(count);
+    std::vector<double> raw_v(count);
+    std::vector<double> raw_out(count);
+    std::vector<quants::mass_t<double>> m(count);
+    std::vector<quants::velocity_t<double>> v(count);
+    std::vector<quants::length_t<double, std::kilo>> km(count);
+    std::vector<quants::time_t<double, quants::scales::hour>> h(count);
+    std::vector<quants::velocity_t<double>> out(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        raw_m[i] = dist(gen);
+        raw_v[i] = dist(gen);
+        m[i] = quants::mass_t<double>{ raw_m[i] };
+        v[i] = quants::velocity_t<double>{ raw_v[i] };
+        km[i] = quants::length_t<double, std::kilo>{ raw_m[i] };
+        h[i] = quants::time_t<double, quants::scales::hour>{ raw_v[i] };
+    }
+
+    std::cout << "sum of m * v^2 / 2, 1M double" << std::endl;
+    bench::run(
+        "  raw double",
+        100,
+        [&]
+        {
+            double result = 0.0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                result += 0.5 * raw_m[i] * raw_v[i] * raw_v[i];
+            }
+            bench::do_not_optimize(result);
+        });
+    bench::run(
+        "  value_t",
+        100,
+        [&]
+        {
+            quants::energy_t<double> result{};
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                result += 0.5 * m[i] * v[i] * v[i];
+            }
+            bench::do_not_optimize(result);
+        });
+
+    std::cout << "km / h -> m / s, 1M double" << std::endl;
+    bench::run(
+        "  raw double",
+        100,
+        [&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                raw_out[i] = raw_m[i] / raw_v[i] * (1000.0 / 3600.0);
+            }
+            bench::clobber();
+        });
+    bench::run(
+        "  value_t",
+        100,
+        [&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out[i] = km[i] / h[i];
+            }
+            bench::clobber();
+        });
+}
+
+int main()
+{
+    std::mt19937 gen{ 42 };
+    bench_integrate(gen);
+    bench_scalar_loops(gen);
+}
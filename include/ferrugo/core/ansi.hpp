@@ -1,12 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <ferrugo/core/format_utils.hpp>
 #include <ferrugo/core/overloaded.hpp>
+#include <ferrugo/core/thread_pool.hpp>
 #include <ferrugo/core/type_traits.hpp>
+#include <ferrugo/core/utf8.hpp>
 #include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unistd.h>
 #include <variant>
 #include <vector>
 
@@ -26,9 +46,8 @@ struct multibyte
 
     multibyte(char32_t ch) : m_data{}, m_size{}
     {
-        auto state = std::mbstate_t{};
-        m_size = std::c32rtomb(m_data.data(), ch, &state);
-        if (m_size == std::size_t(-1))
+        m_size = utf8_encode(ch, m_data.data());
+        if (m_size == 0)
             throw std::runtime_error{ "u32_to_mb: error in conversion" };
     }
 
@@ -40,14 +59,14 @@ struct multibyte
 
     operator char32_t() const
     {
-        auto result = char32_t{};
-        auto mb_state = std::mbstate_t{};
-        auto const error = std::mbrtoc32(&result, m_data.data(), 4, &mb_state);
-        if (error == std::size_t(-1))
+        if (m_size == 0)
+            return U'\0';
+        const auto result = utf8_decode(begin(), end());
+        if (result.status == utf8_status::invalid || (result.status == utf8_status::ok && result.size != m_size))
             throw std::runtime_error{ "mb_to_u32: bad byte sequence" };
-        if (error == std::size_t(-2))
+        if (result.status == utf8_status::incomplete)
             throw std::runtime_error{ "mb_to_u32: incomplete byte sequence" };
-        return result;
+        return result.code_point;
     }
 
     std::size_t size() const
@@ -65,6 +84,16 @@ struct multibyte
         return begin() + size();
     }
 
+    friend bool operator==(const multibyte& lhs, const multibyte& rhs)
+    {
+        return lhs.m_size == rhs.m_size && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    friend bool operator!=(const multibyte& lhs, const multibyte& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const multibyte& item)
     {
         for (std::size_t i = 0; i < item.m_size; ++i)
@@ -86,22 +115,33 @@ struct multibyte_string : private std::vector<multibyte>
     using base_type::begin;
     using base_type::end;
 
-    multibyte_string(const std::string& str)
+    // Malformed bytes are replaced with U+FFFD.
+    multibyte_string(std::string_view str)
     {
-        std::setlocale(LC_ALL, "en_US.utf8");
-        char32_t c32;
         const char* ptr = str.data();
-        const char* end = str.data() + str.size();
-        std::mbstate_t state{};
-        while (std::size_t rc = std::mbrtoc32(&c32, ptr, end - ptr, &state))
+        const char* end = ptr + str.size();
+        this->reserve(str.size());
+        while (ptr != end)
         {
-            assert(rc != (std::size_t)-3);
-            if (rc == (std::size_t)-1)
-                break;
-            if (rc == (std::size_t)-2)
+            const char* ascii_end = detail::find_non_ascii(ptr, end);
+            for (; ptr != ascii_end; ++ptr)
+            {
+                this->emplace_back(ptr, ptr + 1);
+            }
+            if (ptr == end)
+            {
                 break;
-            this->emplace_back(ptr, ptr + rc);
-            ptr += rc;
+            }
+            const auto decoded = utf8_decode(ptr, end);
+            if (decoded.status == utf8_status::ok)
+            {
+                this->emplace_back(ptr, ptr + decoded.size);
+            }
+            else
+            {
+                this->emplace_back(replacement_character);
+            }
+            ptr += decoded.size;
         }
     }
 
@@ -152,6 +192,11 @@ public:
     {
     }
 
+    underlying_type value() const
+    {
+        return m_value;
+    }
+
     bool contains(bitmask b) const
     {
         return (m_value & b.m_value) != 0;
@@ -387,6 +432,184 @@ inline std::ostream& operator<<(std::ostream& os, const color_t& item)
     return os;
 }
 
+enum class color_depth_t
+{
+    true_color,
+    palette_256,
+    basic_16,
+    mono,
+};
+
+namespace detail
+{
+
+inline constexpr std::array<true_color_t, 16> basic_palette = { {
+    { 0, 0, 0 },
+    { 205, 0, 0 },
+    { 0, 205, 0 },
+    { 205, 205, 0 },
+    { 0, 0, 238 },
+    { 205, 0, 205 },
+    { 0, 205, 205 },
+    { 229, 229, 229 },
+    { 127, 127, 127 },
+    { 255, 0, 0 },
+    { 0, 255, 0 },
+    { 255, 255, 0 },
+    { 92, 92, 255 },
+    { 255, 0, 255 },
+    { 0, 255, 255 },
+    { 255, 255, 255 },
+} };
+
+inline constexpr std::array<std::uint8_t, 6> cube_levels = { 0, 95, 135, 175, 215, 255 };
+
+// The xterm colors: 16 basic ones, a 6x6x6 cube and 24 grays.
+inline constexpr true_color_t palette_to_rgb(std::uint8_t index)
+{
+    if (index < 16)
+    {
+        return basic_palette[index];
+    }
+    if (index < 232)
+    {
+        const int n = index - 16;
+        return { cube_levels[n / 36], cube_levels[n / 6 % 6], cube_levels[n % 6] };
+    }
+    const auto gray = static_cast<std::uint8_t>(8 + 10 * (index - 232));
+    return { gray, gray, gray };
+}
+
+inline constexpr int distance(const true_color_t& lhs, const true_color_t& rhs)
+{
+    const int r = lhs.red - rhs.red;
+    const int g = lhs.green - rhs.green;
+    const int b = lhs.blue - rhs.blue;
+    return r * r + g * g + b * b;
+}
+
+inline basic_color_t basic_from_index(int index)
+{
+    return static_cast<basic_color_t>(index < 8 ? index : index - 8 + 60);
+}
+
+// Nearest colors for every true color with 5 bits per channel, built on first use so that mapping a color is a single
+// load instead of a search.
+struct color_tables_t
+{
+    // Index 16 and up; the basic colors are left out since terminals let users redefine them.
+    std::array<std::uint8_t, 1 << 15> palette;
+    std::array<std::uint8_t, 1 << 15> basic;
+
+    static std::size_t index(const true_color_t& c)
+    {
+        return static_cast<std::size_t>(c.red >> 3) << 10 | static_cast<std::size_t>(c.green >> 3) << 5
+               | static_cast<std::size_t>(c.blue >> 3);
+    }
+
+    static const color_tables_t& instance()
+    {
+        static const color_tables_t result{};
+        return result;
+    }
+
+private:
+    color_tables_t()
+    {
+        const auto nearest_level = [](int v)
+        {
+            int best = 0;
+            for (int i = 1; i < 6; ++i)
+            {
+                best = std::abs(cube_levels[i] - v) < std::abs(cube_levels[best] - v) ? i : best;
+            }
+            return best;
+        };
+        for (std::size_t n = 0; n < palette.size(); ++n)
+        {
+            const true_color_t c{ static_cast<std::uint8_t>((n >> 10) << 3 | 4),
+                                  static_cast<std::uint8_t>((n >> 5 & 31) << 3 | 4),
+                                  static_cast<std::uint8_t>((n & 31) << 3 | 4) };
+
+            // Per channel, the nearest cube level is the nearest cube color; the nearest gray is found from the mean.
+            const int cube = 16 + 36 * nearest_level(c.red) + 6 * nearest_level(c.green) + nearest_level(c.blue);
+            const int gray = 232 + std::clamp(((c.red + c.green + c.blue) / 3 - 3) / 10, 0, 23);
+            palette[n] = static_cast<std::uint8_t>(
+                distance(c, palette_to_rgb(static_cast<std::uint8_t>(gray)))
+                        < distance(c, palette_to_rgb(static_cast<std::uint8_t>(cube)))
+                    ? gray
+                    : cube);
+
+            int best = 0;
+            for (int i = 1; i < 16; ++i)
+            {
+                best = distance(c, basic_palette[i]) < distance(c, basic_palette[best]) ? i : best;
+            }
+            basic[n] = static_cast<std::uint8_t>(best);
+        }
+    }
+};
+
+}  // namespace detail
+
+inline palette_color_t nearest_palette_color(const true_color_t& c)
+{
+    return palette_color_t{ detail::color_tables_t::instance().palette[detail::color_tables_t::index(c)] };
+}
+
+inline basic_color_t nearest_basic_color(const true_color_t& c)
+{
+    return detail::basic_from_index(detail::color_tables_t::instance().basic[detail::color_tables_t::index(c)]);
+}
+
+// The color as shown by a terminal supporting only `depth`; mono leaves the terminal's default colors.
+inline color_t downgrade(const color_t& col, color_depth_t depth)
+{
+    switch (depth)
+    {
+        case color_depth_t::true_color: return col;
+        case color_depth_t::palette_256:
+            if (const auto* c = std::get_if<true_color_t>(&col))
+            {
+                return nearest_palette_color(*c);
+            }
+            return col;
+        case color_depth_t::basic_16:
+            if (const auto* c = std::get_if<true_color_t>(&col))
+            {
+                return nearest_basic_color(*c);
+            }
+            if (const auto* c = std::get_if<palette_color_t>(&col))
+            {
+                return c->index < 16 ? detail::basic_from_index(c->index)
+                                     : nearest_basic_color(detail::palette_to_rgb(c->index));
+            }
+            return col;
+        default: return default_color_t{};
+    }
+}
+
+// From COLORTERM and TERM, as most terminal applications do.
+inline color_depth_t color_depth_from_environment()
+{
+    const auto env = [](const char* name) { return std::string_view{ std::getenv(name) ? std::getenv(name) : "" }; };
+    const auto colorterm = env("COLORTERM");
+    const auto term = env("TERM");
+    if (colorterm == "truecolor" || colorterm == "24bit")
+    {
+        return color_depth_t::true_color;
+    }
+    if (term.find("256color") != std::string_view::npos)
+    {
+        return color_depth_t::palette_256;
+    }
+    if (term.empty() || term == "dumb")
+    {
+        return color_depth_t::mono;
+    }
+    return color_depth_t::basic_16;
+}
+
 struct glyph_style_t
 {
     color_t foreground = default_color_t{};
@@ -426,11 +649,14 @@ struct glyph_t
     {
     }
 
-    glyph_t& operator=(glyph_t other)
+    friend bool operator==(const glyph_t& lhs, const glyph_t& rhs)
     {
-        std::swap(character, other.character);
-        std::swap(style, other.style);
-        return *this;
+        return lhs.character == rhs.character && lhs.style == rhs.style;
+    }
+
+    friend bool operator!=(const glyph_t& lhs, const glyph_t& rhs)
+    {
+        return !(lhs == rhs);
     }
 
     friend std::ostream& operator<<(std::ostream& os, const glyph_t& item)
@@ -449,6 +675,16 @@ struct extent_t
 {
     int width = 0;
     int height = 0;
+
+    friend bool operator==(const extent_t& lhs, const extent_t& rhs)
+    {
+        return lhs.width == rhs.width && lhs.height == rhs.height;
+    }
+
+    friend bool operator!=(const extent_t& lhs, const extent_t& rhs)
+    {
+        return !(lhs == rhs);
+    }
 };
 
 struct bounds_t
@@ -457,265 +693,1273 @@ struct bounds_t
     extent_t extent = {};
 };
 
-struct area_t
+namespace detail
 {
-    struct ref_type
-    {
-        explicit ref_type(const glyph_t* ptr, extent_t e) : m_ptr{ ptr }, m_extent{ e }
-        {
-        }
 
-        const glyph_t& operator[](location_t loc) const
-        {
-            return *(m_ptr + to_index(loc));
-        }
+// Colors packed into 26 bits: the alternative in the two high bits and its value below.
+inline std::uint32_t pack_color(const color_t& col)
+{
+    return std::visit(
+        ferrugo::core::overloaded{
+            [](const default_color_t&) { return std::uint32_t{ 0 }; },
+            [](const basic_color_t& c) { return std::uint32_t{ 1 } << 24 | static_cast<std::uint32_t>(c); },
+            [](const palette_color_t& c) { return std::uint32_t{ 2 } << 24 | c.index; },
+            [](const true_color_t& c)
+            { return std::uint32_t{ 3 } << 24 | std::uint32_t{ c.red } << 16 | std::uint32_t{ c.green } << 8 | c.blue; } },
+        col);
+}
 
-        std::size_t to_index(location_t loc) const
-        {
-            if (!((0 <= loc.x < m_extent.width) && (0 <= loc.y < m_extent.height)))
-            {
-                throw std::runtime_error{ "location out of bounds" };
-            }
-            return m_extent.width * loc.y + loc.x;
-        }
+inline color_t unpack_color(std::uint32_t value)
+{
+    switch (value >> 24)
+    {
+        case 1: return static_cast<basic_color_t>(value & 0xFF);
+        case 2: return palette_color_t{ static_cast<std::uint8_t>(value) };
+        case 3:
+            return true_color_t{ static_cast<std::uint8_t>(value >> 16),
+                                 static_cast<std::uint8_t>(value >> 8),
+                                 static_cast<std::uint8_t>(value) };
+        default: return default_color_t{};
+    }
+}
 
-        const glyph_t* m_ptr;
-        extent_t m_extent;
-    };
+// Styles packed into 62 bits; the default style packs to 0.
+inline std::uint64_t pack_style(const glyph_style_t& style)
+{
+    return std::uint64_t{ pack_color(style.foreground) } | std::uint64_t{ pack_color(style.background) } << 26
+           | static_cast<std::uint64_t>(style.mode_value.value()) << 52;
+}
 
-    struct mut_ref_type
+inline glyph_style_t unpack_style(std::uint64_t value)
+{
+    glyph_style_t result{ unpack_color(value & 0x3FFFFFF), unpack_color(value >> 26 & 0x3FFFFFF) };
+    for (std::uint32_t bits = static_cast<std::uint32_t>(value >> 52); bits != 0; bits &= bits - 1)
     {
-        explicit mut_ref_type(glyph_t* ptr, extent_t e) : m_ptr{ ptr }, m_extent{ e }
-        {
-        }
-
-        glyph_t& operator[](location_t loc) const
-        {
-            return *(m_ptr + to_index(loc));
-        }
+        result.mode_value |= static_cast<mode>(std::uint32_t{ 1 } << std::countr_zero(bits));
+    }
+    return result;
+}
 
-        std::size_t to_index(location_t loc) const
-        {
-            if (!((0 <= loc.x < m_extent.width) && (0 <= loc.y < m_extent.height)))
-            {
-                throw std::runtime_error{ "location out of bounds" };
-            }
-            return m_extent.width * loc.y + loc.x;
-        }
+}  // namespace detail
 
-        void fill(glyph_t value)
-        {
-            for (int y = 0; y < m_extent.height; ++y)
-            {
-                for (int x = 0; x < m_extent.width; ++x)
-                {
-                    (*this)[location_t{ x, y }] = value;
-                }
-            }
-        }
+// A glyph packed into 8 bytes: its code point (21 bits are enough for every scalar value) and the index of its style
+// in the style_table_t of its area. There is no padding, so rows of cells can be compared and copied as plain memory.
+struct cell_t
+{
+    std::uint32_t m_code_point = U' ';
+    std::uint16_t m_style = 0;
+    std::uint16_t m_reserved = 0;
 
-        glyph_t* m_ptr;
-        extent_t m_extent;
-    };
+    cell_t() = default;
 
-    explicit area_t(extent_t e) : m_extent{ e }, m_data(e.width * e.height, glyph_t{})
+    cell_t(char32_t code_point, std::uint16_t style) : m_code_point{ code_point }, m_style{ style }
     {
     }
 
-    ref_type ref() const
+    friend bool operator==(const cell_t& lhs, const cell_t& rhs)
     {
-        return ref_type{ m_data.data(), m_extent };
+        return lhs.m_code_point == rhs.m_code_point && lhs.m_style == rhs.m_style;
     }
 
-    mut_ref_type mut_ref()
+    friend bool operator!=(const cell_t& lhs, const cell_t& rhs)
     {
-        return mut_ref_type{ m_data.data(), m_extent };
+        return !(lhs == rhs);
     }
-
-    extent_t m_extent;
-    std::vector<glyph_t> m_data;
 };
 
-enum class ground_type_t
-{
-    foreground,
-    background
-};
+static_assert(sizeof(cell_t) == 8, "cell_t: unexpected padding");
 
-struct buffer_t
+// The distinct glyph styles of one area, each stored once; its cells refer to their style by the index here. Index 0
+// is the default style, and equal indices mean equal styles. When every index is taken, the ones no cell of the area
+// refers to are reclaimed, and filling the whole area starts the table over, so an area may go through any number of
+// styles over its lifetime. Interning is thread safe and served from a per-thread cache in the common case of a few
+// styles being used over and over.
+class style_table_t
 {
-    std::ostream& m_os;
-    glyph_style_t m_prev_style = {};
-    using args_t = std::vector<int>;
+public:
+    static constexpr std::size_t capacity = std::size_t{ 1 } << 16;
 
-    explicit buffer_t(std::ostream& os) : m_os{ os }
+    explicit style_table_t(std::span<const cell_t> cells) : m_id{ next_id() }, m_cells{ cells }
     {
-        // reset();
+        m_chunks[0] = std::make_unique<std::uint64_t[]>(chunk_size);
+        m_indices.emplace(0, 0);
     }
 
-    buffer_t& set_style(const glyph_style_t& style)
+    style_table_t(const style_table_t& other, std::span<const cell_t> cells) : m_id{ next_id() }, m_cells{ cells }
     {
-        static const std::map<mode, std::tuple<args_t, args_t>> map = {
-            { mode::bold, { args_t{ 1 }, args_t{ 21 } } },   { mode::dim, { args_t{ 2 }, args_t{ 22 } } },
-            { mode::italic, { args_t{ 3 }, args_t{ 23 } } }, { mode::underline, { args_t{ 4 }, args_t{ 24 } } },
-            { mode::blink, { args_t{ 5 }, args_t{ 25 } } },  { mode::inverse, { args_t{ 7 }, args_t{ 27 } } },
-            { mode::hidden, { args_t{ 8 }, args_t{ 28 } } }, { mode::crossed_out, { args_t{ 9 }, args_t{ 29 } } },
-        };
-        for (const mode m : { mode::bold,
-                              mode::dim,
-                              mode::italic,
-                              mode::underline,
-                              mode::blink,
-                              mode::inverse,
-                              mode::crossed_out,
-                              mode::standout })
-        {
-            if (style.mode_value.contains(m) != m_prev_style.mode_value.contains(m))
-            {
-                const auto iter = map.find(m);
-                if (iter != map.end())
-                {
-                    const auto& [on_set, on_reset] = iter->second;
-                    if (style.mode_value.contains(m))
-                    {
-                        escape(on_set);
-                    }
-                    else
-                    {
-                        escape(on_reset);
-                    }
-                }
-            }
+        std::lock_guard<std::mutex> lock{ other.m_mutex };
+        for (std::size_t n = 0; n < m_chunks.size() && other.m_chunks[n]; ++n)
+        {
+            m_chunks[n] = std::make_unique<std::uint64_t[]>(chunk_size);
+            std::copy_n(other.m_chunks[n].get(), chunk_size, m_chunks[n].get());
         }
+        m_indices = other.m_indices;
+        m_free = other.m_free;
+        m_next = other.m_next;
+    }
+
+    style_table_t(const style_table_t&) = delete;
+    style_table_t& operator=(const style_table_t&) = delete;
+
+    std::uint16_t intern(const glyph_style_t& style)
+    {
+        struct entry_t
+        {
+            std::uint64_t table;
+            std::uint64_t key;
+            std::uint16_t index;
+        };
+        // Table ids start at 1, so zero-initialized entries never match.
+        thread_local std::array<entry_t, 256> cache{};
 
-        if (style.foreground != m_prev_style.foreground || style.background != m_prev_style.background)
+        const std::uint64_t key = detail::pack_style(style);
+        entry_t& entry = cache[(key * 0x9E3779B97F4A7C15) >> 56];
+        if (entry.table != m_id || entry.key != key)
         {
-            write_color(ground_type_t::foreground, style.foreground);
-            write_color(ground_type_t::background, style.background);
+            const std::uint16_t index = lookup_or_insert(key);
+            entry = entry_t{ m_id, key, index };
         }
-        m_prev_style = style;
-        return *this;
+        return entry.index;
     }
 
-    buffer_t& write(const multibyte& character)
+    // The packed style at `index`: equal for equal styles, also across tables.
+    std::uint64_t key(std::uint16_t index) const
     {
-        m_os << character;
-        return *this;
+        return m_chunks[index / chunk_size][index % chunk_size];
     }
 
-    buffer_t& new_line()
+    glyph_style_t operator[](std::uint16_t index) const
     {
-        m_prev_style = {};
-        escape({ 0 });
-        m_os << '\n';
-        return *this;
+        return detail::unpack_style(key(index));
     }
 
-    void escape(const args_t& args)
+    cell_t cell(const glyph_t& glyph)
     {
-        m_os << "\033[" << delimit(args, ";") << "m";
+        return cell_t{ static_cast<char32_t>(glyph.character), intern(glyph.style) };
     }
 
-    void write_color(ground_type_t type, const color_t& col)
+    glyph_t glyph(const cell_t& cell) const
     {
-        const args_t args = std::visit(
-            ferrugo::core::overloaded{ [&](const true_color_t& c) -> args_t {
-                                          return { type == ground_type_t::foreground ? 38 : 48, 2, c.red, c.green, c.blue };
-                                      },
-                                       [&](const palette_color_t& c) -> args_t {
-                                           return { type == ground_type_t::foreground ? 38 : 48, 5, c.index };
-                                       },
-                                       [&](const default_color_t& c) -> args_t
-                                       { return { type == ground_type_t::foreground ? 39 : 49 }; },
-                                       [&](const basic_color_t& c) -> args_t
-                                       { return { static_cast<int>(c) + (type == ground_type_t::foreground ? 30 : 40) }; } },
-            col);
-        escape(args);
+        return glyph_t{ character_t{ static_cast<char32_t>(cell.m_code_point) }, (*this)[cell.m_style] };
     }
 
-    void reset()
+    // Changes whenever an index may have been given to another style, e.g. for caches of the cells' styles.
+    std::uint64_t id() const
     {
-        escape({});
+        return m_id;
     }
-};
 
-inline void output(const area_t::ref_type& area_t, buffer_t& buf)
-{
-    for (int y = 0; y < area_t.m_extent.height; ++y)
+    std::size_t size() const
     {
-        for (int x = 0; x < area_t.m_extent.width; ++x)
-        {
-            const glyph_t& g = area_t[location_t{ x, y }];
-            buf.set_style(g.style).write(g.character);
-        }
-        buf.new_line();
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_indices.size();
     }
-    buf.reset();
-}
-
-struct glyph_style_applier_t
-{
-    using applier_type = std::function<void(glyph_style_t&)>;
-
-    applier_type applier;
 
-    explicit glyph_style_applier_t(applier_type applier) : applier{ std::move(applier) }
+    // Starts over when `cells` are all the cells of the area, which are about to take a single style.
+    void restart_if_whole_area(const cell_t* cells, std::size_t count)
     {
+        if (cells != m_cells.data() || count != m_cells.size() || m_parallel_writers.load() != 0)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_indices.clear();
+        m_indices.emplace(0, 0);
+        m_free.clear();
+        m_next = 1;
+        m_id = next_id();
     }
 
-    glyph_style_applier_t(modes_t m) : glyph_style_applier_t{ [=](glyph_style_t& s) { s.mode_value |= m; } }
+    // While the area is written from several threads, cells are not scanned for unused styles. The room for `count`
+    // new styles is made beforehand instead.
+    void begin_parallel_writes(std::size_t count)
     {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        if (m_parallel_writers.load() == 0 && m_free.size() + (capacity - m_next) < count)
+        {
+            compact();
+        }
+        ++m_parallel_writers;
     }
 
-    glyph_style_applier_t(mode m) : glyph_style_applier_t{ [=](glyph_style_t& s) { s.mode_value |= m; } }
+    void end_parallel_writes()
     {
+        --m_parallel_writers;
     }
 
-    glyph_style_t& operator()(glyph_style_t& s) const
+private:
+    static constexpr std::size_t chunk_size = 256;
+
+    static std::uint64_t next_id()
     {
-        applier(s);
-        return s;
+        static std::atomic<std::uint64_t> result{ 1 };
+        return result.fetch_add(1, std::memory_order_relaxed);
     }
 
-    glyph_t& operator()(glyph_t& g) const
+    std::uint16_t lookup_or_insert(std::uint64_t key)
     {
-        (*this)(g.style);
-        return g;
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        if (const auto it = m_indices.find(key); it != m_indices.end())
+        {
+            return it->second;
+        }
+        if (m_free.empty() && m_next == capacity)
+        {
+            if (m_parallel_writers.load() == 0)
+            {
+                compact();
+            }
+            if (m_free.empty())
+            {
+                throw std::runtime_error{ "style_table_t: too many distinct styles in one area" };
+            }
+        }
+        std::uint16_t index = 0;
+        if (!m_free.empty())
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            index = static_cast<std::uint16_t>(m_next++);
+            auto& chunk = m_chunks[index / chunk_size];
+            if (!chunk)
+            {
+                chunk = std::make_unique<std::uint64_t[]>(chunk_size);
+            }
+        }
+        m_chunks[index / chunk_size][index % chunk_size] = key;
+        m_indices.emplace(key, index);
+        return index;
     }
 
-    operator glyph_style_t() const
+    // Frees the indices no cell refers to. Interned indices are written to a cell before the next style is interned,
+    // so none is in use elsewhere.
+    void compact()
     {
-        glyph_style_t result{};
-        applier(result);
-        return result;
+        std::vector<bool> live(capacity);
+        live[0] = true;
+        for (const cell_t& cell : m_cells)
+        {
+            live[cell.m_style] = true;
+        }
+        for (auto it = m_indices.begin(); it != m_indices.end();)
+        {
+            if (live[it->second])
+            {
+                ++it;
+                continue;
+            }
+            m_free.push_back(it->second);
+            it = m_indices.erase(it);
+        }
+        m_id = next_id();
     }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::uint64_t, std::uint16_t> m_indices;
+    std::array<std::unique_ptr<std::uint64_t[]>, capacity / chunk_size> m_chunks;
+    std::vector<std::uint16_t> m_free;
+    std::size_t m_next = 1;
+    std::uint64_t m_id;
+    std::span<const cell_t> m_cells;
+    std::atomic<int> m_parallel_writers{ 0 };
 };
 
-inline glyph_style_applier_t operator|(glyph_style_applier_t lhs, glyph_style_applier_t rhs)
+// What area_t::mut_ref_type::operator[] returns in place of glyph_t&: assigning a glyph, its character or its style
+// writes through to the packed cell.
+struct cell_ref_t
 {
-    return glyph_style_applier_t{ [=](glyph_style_t& s)
-                                  {
-                                      lhs(s);
-                                      rhs(s);
-                                  } };
-}
+    struct character_ref_t
+    {
+        cell_t* m_cell;
 
-inline glyph_style_t& operator|=(glyph_style_t& g, const glyph_style_applier_t& applier)
-{
-    applier(g);
-    return g;
-}
+        operator character_t() const
+        {
+            return character_t{ static_cast<char32_t>(m_cell->m_code_point) };
+        }
 
-inline glyph_style_t operator|(glyph_style_t g, const glyph_style_applier_t& applier)
-{
-    applier(g);
-    return g;
-}
+        const character_ref_t& operator=(const character_t& value) const
+        {
+            m_cell->m_code_point = static_cast<char32_t>(value);
+            return *this;
+        }
+    };
 
-inline glyph_t operator|(glyph_t g, const glyph_style_applier_t& applier)
-{
-    applier(g);
-    return g;
+    struct style_ref_t
+    {
+        cell_t* m_cell;
+        style_table_t* m_styles;
+
+        operator glyph_style_t() const
+        {
+            return (*m_styles)[m_cell->m_style];
+        }
+
+        const style_ref_t& operator=(const glyph_style_t& value) const
+        {
+            m_cell->m_style = m_styles->intern(value);
+            return *this;
+        }
+    };
+
+    explicit cell_ref_t(cell_t* cell, style_table_t* styles) : character{ cell }, style{ cell, styles }
+    {
+    }
+
+    cell_ref_t(const cell_ref_t&) = default;
+
+    // A cell of another area is converted to the styles of this one.
+    const cell_ref_t& operator=(const cell_ref_t& other) const
+    {
+        *character.m_cell = style.m_styles == other.style.m_styles ? *other.character.m_cell
+                                                                   : style.m_styles->cell(static_cast<glyph_t>(other));
+        return *this;
+    }
+
+    const cell_ref_t& operator=(const glyph_t& value) const
+    {
+        *character.m_cell = style.m_styles->cell(value);
+        return *this;
+    }
+
+    operator glyph_t() const
+    {
+        return style.m_styles->glyph(*character.m_cell);
+    }
+
+    character_ref_t character;
+    style_ref_t style;
+};
+
+namespace detail
+{
+
+inline bounds_t clip(bounds_t bounds, extent_t extent)
+{
+    const int x0 = std::clamp(bounds.location.x, 0, extent.width);
+    const int y0 = std::clamp(bounds.location.y, 0, extent.height);
+    const int x1 = std::clamp(bounds.location.x + bounds.extent.width, x0, extent.width);
+    const int y1 = std::clamp(bounds.location.y + bounds.extent.height, y0, extent.height);
+    return bounds_t{ { x0, y0 }, { x1 - x0, y1 - y0 } };
+}
+
+}  // namespace detail
+
+// A rectangle of glyphs, stored as packed cells row after row. References may view a part of it, in which case
+// consecutive rows are m_row_stride cells apart.
+struct area_t
+{
+    struct ref_type
+    {
+        explicit ref_type(const cell_t* ptr, extent_t e, std::size_t row_stride, const style_table_t* styles)
+            : m_ptr{ ptr }
+            , m_extent{ e }
+            , m_row_stride{ row_stride }
+            , m_styles{ styles }
+        {
+        }
+
+        explicit ref_type(const cell_t* ptr, extent_t e, const style_table_t* styles)
+            : ref_type{ ptr, e, static_cast<std::size_t>(e.width), styles }
+        {
+        }
+
+        glyph_t operator[](location_t loc) const
+        {
+            return m_styles->glyph(*(m_ptr + to_index(loc)));
+        }
+
+        bool contains(location_t loc) const
+        {
+            return static_cast<unsigned>(loc.x) < static_cast<unsigned>(m_extent.width)
+                   && static_cast<unsigned>(loc.y) < static_cast<unsigned>(m_extent.height);
+        }
+
+        std::size_t to_index(location_t loc) const
+        {
+            if (!contains(loc))
+            {
+                throw std::runtime_error{ "location out of bounds" };
+            }
+            return m_row_stride * loc.y + loc.x;
+        }
+
+        // Unchecked
+        std::span<const cell_t> row(int y) const
+        {
+            assert(0 <= y && y < m_extent.height);
+            return { m_ptr + m_row_stride * y, static_cast<std::size_t>(m_extent.width) };
+        }
+
+        bool contiguous() const
+        {
+            return m_row_stride == static_cast<std::size_t>(m_extent.width) || m_extent.height <= 1;
+        }
+
+        // The part of `bounds` which lies within the area, viewing the same cells.
+        ref_type sub(bounds_t bounds) const
+        {
+            const auto clipped = detail::clip(bounds, m_extent);
+            return ref_type{
+                m_ptr + m_row_stride * clipped.location.y + clipped.location.x, clipped.extent, m_row_stride, m_styles
+            };
+        }
+
+        const cell_t* m_ptr;
+        extent_t m_extent;
+        std::size_t m_row_stride;
+        const style_table_t* m_styles;
+    };
+
+    struct mut_ref_type
+    {
+        explicit mut_ref_type(cell_t* ptr, extent_t e, std::size_t row_stride, style_table_t* styles)
+            : m_ptr{ ptr }
+            , m_extent{ e }
+            , m_row_stride{ row_stride }
+            , m_styles{ styles }
+        {
+        }
+
+        explicit mut_ref_type(cell_t* ptr, extent_t e, style_table_t* styles)
+            : mut_ref_type{ ptr, e, static_cast<std::size_t>(e.width), styles }
+        {
+        }
+
+        operator ref_type() const
+        {
+            return ref_type{ m_ptr, m_extent, m_row_stride, m_styles };
+        }
+
+        cell_ref_t operator[](location_t loc) const
+        {
+            return cell_ref_t{ m_ptr + to_index(loc), m_styles };
+        }
+
+        bool contains(location_t loc) const
+        {
+            return ref_type(*this).contains(loc);
+        }
+
+        std::size_t to_index(location_t loc) const
+        {
+            return ref_type(*this).to_index(loc);
+        }
+
+        // Unchecked
+        std::span<cell_t> row(int y) const
+        {
+            assert(0 <= y && y < m_extent.height);
+            return { m_ptr + m_row_stride * y, static_cast<std::size_t>(m_extent.width) };
+        }
+
+        bool contiguous() const
+        {
+            return ref_type(*this).contiguous();
+        }
+
+        // The part of `bounds` which lies within the area, viewing the same cells. Views which do not overlap may be
+        // written from different threads with render_parallel, which keeps unused styles from being reclaimed meanwhile.
+        mut_ref_type sub(bounds_t bounds) const
+        {
+            const auto clipped = detail::clip(bounds, m_extent);
+            return mut_ref_type{ m_ptr + m_row_stride * clipped.location.y + clipped.location.x,
+                                 clipped.extent,
+                                 m_row_stride,
+                                 m_styles };
+        }
+
+        // Splits the area into a grid of views of at most `tile` cells, row by row.
+        std::vector<mut_ref_type> tiles(extent_t tile) const
+        {
+            if (tile.width <= 0 || tile.height <= 0)
+            {
+                throw std::invalid_argument{ "area_t: tile extent must be positive" };
+            }
+            std::vector<mut_ref_type> result;
+            for (int y = 0; y < m_extent.height; y += tile.height)
+            {
+                for (int x = 0; x < m_extent.width; x += tile.width)
+                {
+                    result.push_back(sub(bounds_t{ { x, y }, tile }));
+                }
+            }
+            return result;
+        }
+
+        void fill(const glyph_t& value) const
+        {
+            if (contiguous())
+            {
+                const auto count = static_cast<std::size_t>(m_extent.width) * m_extent.height;
+                m_styles->restart_if_whole_area(m_ptr, count);
+                std::fill_n(m_ptr, count, m_styles->cell(value));
+                return;
+            }
+            fill_rect(bounds_t{ {}, m_extent }, value);
+        }
+
+        // Fills the part of `bounds` which lies within the area.
+        void fill_rect(bounds_t bounds, const glyph_t& value) const
+        {
+            const auto clipped = detail::clip(bounds, m_extent);
+            const cell_t cell = m_styles->cell(value);
+            for (int y = clipped.location.y; y < clipped.location.y + clipped.extent.height; ++y)
+            {
+                std::fill_n(row(y).begin() + clipped.location.x, clipped.extent.width, cell);
+            }
+        }
+
+        // Copies `src` with its top left corner at `dst`, leaving out what falls outside of the area. `src` may overlap
+        // the area, as when moving a part of it.
+        void blit(const ref_type& src, location_t dst) const
+        {
+            const int x0 = std::max(-dst.x, 0);
+            const int y0 = std::max(-dst.y, 0);
+            const int x1 = std::min(src.m_extent.width, m_extent.width - dst.x);
+            const int y1 = std::min(src.m_extent.height, m_extent.height - dst.y);
+            if (x0 >= x1 || y0 >= y1)
+            {
+                return;
+            }
+            if (src.m_styles != m_styles)
+            {
+                // Another area: the styles are interned here, once for each run of equal ones.
+                for (int y = y0; y < y1; ++y)
+                {
+                    const cell_t* in = src.row(y).data();
+                    cell_t* out = row(dst.y + y).data() + dst.x;
+                    std::uint16_t from = in[x0].m_style;
+                    std::uint16_t to = m_styles->intern((*src.m_styles)[from]);
+                    for (int x = x0; x < x1; ++x)
+                    {
+                        if (in[x].m_style != from)
+                        {
+                            from = in[x].m_style;
+                            to = m_styles->intern((*src.m_styles)[from]);
+                        }
+                        out[x] = cell_t{ static_cast<char32_t>(in[x].m_code_point), to };
+                    }
+                }
+                return;
+            }
+            const auto copy_row = [&](int y)
+            {
+                std::memmove(
+                    row(dst.y + y).data() + dst.x + x0,
+                    src.row(y).data() + x0,
+                    static_cast<std::size_t>(x1 - x0) * sizeof(cell_t));
+            };
+            // When the destination rows lie after the source rows in memory, overlapping rows must be copied from
+            // the bottom up, so that no source row is overwritten before it is read.
+            if (std::greater<>{}(row(dst.y + y0).data() + dst.x, src.row(y0).data()))
+            {
+                for (int y = y1 - 1; y >= y0; --y)
+                {
+                    copy_row(y);
+                }
+            }
+            else
+            {
+                for (int y = y0; y < y1; ++y)
+                {
+                    copy_row(y);
+                }
+            }
+        }
+
+        // Moves the content up by `dy` rows (down if negative) and fills the rows left behind with `value`.
+        void scroll(int dy, const glyph_t& value = {}) const
+        {
+            const int height = m_extent.height;
+            const auto width = static_cast<std::size_t>(m_extent.width);
+            if (dy >= height || -dy >= height)
+            {
+                fill(value);
+                return;
+            }
+            if (dy > 0)
+            {
+                if (contiguous())
+                {
+                    std::memmove(m_ptr, m_ptr + dy * width, (height - dy) * width * sizeof(cell_t));
+                }
+                else
+                {
+                    blit(sub(bounds_t{ { 0, dy }, m_extent }), location_t{ 0, 0 });
+                }
+                fill_rect(bounds_t{ { 0, height - dy }, { m_extent.width, dy } }, value);
+            }
+            else if (dy < 0)
+            {
+                if (contiguous())
+                {
+                    std::memmove(
+                        m_ptr + static_cast<std::size_t>(-dy) * width, m_ptr, (height + dy) * width * sizeof(cell_t));
+                }
+                else
+                {
+                    blit(*this, location_t{ 0, -dy });
+                }
+                fill_rect(bounds_t{ { 0, 0 }, { m_extent.width, -dy } }, value);
+            }
+        }
+
+        cell_t* m_ptr;
+        extent_t m_extent;
+        std::size_t m_row_stride;
+        style_table_t* m_styles;
+    };
+
+    explicit area_t(extent_t e)
+        : m_extent{ e }
+        , m_data(static_cast<std::size_t>(e.width) * e.height, cell_t{})
+        , m_styles{ std::make_unique<style_table_t>(m_data) }
+    {
+    }
+
+    area_t(const area_t& other)
+        : m_extent{ other.m_extent }
+        , m_data{ other.m_data }
+        , m_styles{ std::make_unique<style_table_t>(*other.m_styles, m_data) }
+    {
+    }
+
+    area_t(area_t&&) = default;
+
+    area_t& operator=(const area_t& other)
+    {
+        return *this = area_t{ other };
+    }
+
+    area_t& operator=(area_t&&) = default;
+
+    ref_type ref() const
+    {
+        return ref_type{ m_data.data(), m_extent, m_styles.get() };
+    }
+
+    mut_ref_type mut_ref()
+    {
+        return mut_ref_type{ m_data.data(), m_extent, m_styles.get() };
+    }
+
+    extent_t m_extent;
+    std::vector<cell_t> m_data;
+    // Moves with m_data, whose cells it scans.
+    std::unique_ptr<style_table_t> m_styles;
+};
+
+// Calls fn(views[i], i) for every view on the pool and returns once all calls are done. The views must not overlap,
+// e.g. the tiles of an area or the regions of the widgets laid out on it.
+template <class Fn>
+void render_parallel(thread_pool_t& pool, const std::vector<area_t::mut_ref_type>& views, Fn&& fn)
+{
+    // Each cell may take a new style; room for them is made while no other thread writes to the areas.
+    std::vector<std::pair<style_table_t*, std::size_t>> tables;
+    for (const auto& view : views)
+    {
+        const auto count = static_cast<std::size_t>(view.m_extent.width) * view.m_extent.height;
+        const auto it = std::find_if(tables.begin(), tables.end(), [&](const auto& t) { return t.first == view.m_styles; });
+        if (it == tables.end())
+        {
+            tables.emplace_back(view.m_styles, count);
+        }
+        else
+        {
+            it->second += count;
+        }
+    }
+    struct parallel_writes_t
+    {
+        std::vector<std::pair<style_table_t*, std::size_t>>& m_tables;
+        std::size_t m_started = 0;
+
+        ~parallel_writes_t()
+        {
+            for (std::size_t n = 0; n < m_started; ++n)
+            {
+                m_tables[n].first->end_parallel_writes();
+            }
+        }
+    } writes{ tables };
+    for (; writes.m_started < tables.size(); ++writes.m_started)
+    {
+        tables[writes.m_started].first->begin_parallel_writes(tables[writes.m_started].second);
+    }
+    pool.parallel_for(views.size(), [&](std::size_t i) { fn(views[i], i); });
+}
+
+enum class ground_type_t
+{
+    foreground,
+    background
+};
+
+namespace detail
+{
+
+// "0" ... "255" with the length in the last byte, for color components and other small parameters.
+inline constexpr auto small_decimals = []
+{
+    std::array<std::array<char, 4>, 256> result{};
+    for (int n = 0; n < 256; ++n)
+    {
+        auto& item = result[n];
+        const int size = n < 10 ? 1 : n < 100 ? 2 : 3;
+        for (int i = size - 1, v = n; i >= 0; --i, v /= 10)
+        {
+            item[i] = static_cast<char>('0' + v % 10);
+        }
+        item[3] = static_cast<char>(size);
+    }
+    return result;
+}();
+
+// SGR parameters setting and resetting each mode, indexed by bit position; 0 where the terminal has none.
+inline constexpr std::array<std::uint8_t, 10> mode_set_codes = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 21 };
+inline constexpr std::array<std::uint8_t, 10> mode_reset_codes = { 0, 22, 22, 23, 24, 25, 27, 28, 29, 24 };
+
+}  // namespace detail
+
+// Accumulates terminal output in a contiguous buffer whose capacity is reused, so that steady-state frames do not
+// allocate. When constructed with a stream, the bytes are passed to it on flush() and on destruction.
+struct buffer_t
+{
+    std::string m_data;
+    std::ostream* m_os = nullptr;
+    // Colors beyond this depth are mapped to the nearest one available.
+    color_depth_t m_color_depth = color_depth_t::true_color;
+    // As sent, i.e. after downgrading
+    glyph_style_t m_prev_style = {};
+
+    buffer_t() = default;
+
+    explicit buffer_t(std::ostream& os) : m_os{ &os }
+    {
+    }
+
+    buffer_t(const buffer_t&) = delete;
+    buffer_t& operator=(const buffer_t&) = delete;
+
+    ~buffer_t()
+    {
+        flush();
+    }
+
+    std::string_view view() const
+    {
+        return m_data;
+    }
+
+    void clear()
+    {
+        m_data.clear();
+    }
+
+    void flush()
+    {
+        if (m_os && !m_data.empty())
+        {
+            m_os->write(m_data.data(), static_cast<std::streamsize>(m_data.size()));
+            m_data.clear();
+        }
+    }
+
+    // Emits a single SGR sequence covering every attribute that differs from the previous style.
+    buffer_t& set_style(const glyph_style_t& style)
+    {
+        if (m_color_depth == color_depth_t::true_color)
+        {
+            return write_style(style);
+        }
+        return write_style(glyph_style_t{ downgrade(style.foreground, m_color_depth),
+                                          downgrade(style.background, m_color_depth),
+                                          style.mode_value });
+    }
+
+    buffer_t& write_style(const glyph_style_t& style)
+    {
+        const auto prev = m_prev_style.mode_value.value();
+        const auto next = style.mode_value.value();
+        const bool fg_changed = style.foreground != m_prev_style.foreground;
+        const bool bg_changed = style.background != m_prev_style.background;
+        if (prev == next && !fg_changed && !bg_changed)
+        {
+            return *this;
+        }
+
+        const auto changed = static_cast<std::uint32_t>(prev ^ next);
+        // every changed mode, bold and dim set again after 22, and two 5-parameter colors at most
+        const std::size_t max_params
+            = static_cast<std::size_t>(std::popcount(changed)) + 2 + (fg_changed ? 5 : 0) + (bg_changed ? 5 : 0);
+        sequence_t sgr{ *this, max_params };
+        std::uint32_t reset_codes = 0;
+        for (std::uint32_t bits = changed & prev; bits != 0; bits &= bits - 1)
+        {
+            const std::uint32_t code = detail::mode_reset_codes[std::countr_zero(bits)];
+            if (code != 0 && !(reset_codes >> code & 1))
+            {
+                reset_codes |= std::uint32_t{ 1 } << code;
+                sgr.param(code);
+            }
+        }
+        std::uint32_t set_bits = changed & next;
+        if (reset_codes != 0)
+        {
+            // A shared reset (22 for bold and dim, 24 for both underlines) also cleared the modes which stay on.
+            for (std::uint32_t bits = static_cast<std::uint32_t>(prev & next); bits != 0; bits &= bits - 1)
+            {
+                const int bit = std::countr_zero(bits);
+                if (reset_codes >> detail::mode_reset_codes[bit] & 1)
+                {
+                    set_bits |= std::uint32_t{ 1 } << bit;
+                }
+            }
+        }
+        for (; set_bits != 0; set_bits &= set_bits - 1)
+        {
+            const std::uint32_t code = detail::mode_set_codes[std::countr_zero(set_bits)];
+            if (code != 0)
+            {
+                sgr.param(code);
+            }
+        }
+        if (fg_changed)
+        {
+            sgr.color(ground_type_t::foreground, style.foreground);
+        }
+        if (bg_changed)
+        {
+            sgr.color(ground_type_t::background, style.background);
+        }
+        sgr.finish('m');
+        m_prev_style = style;
+        return *this;
+    }
+
+    buffer_t& write(const multibyte& character)
+    {
+        m_data.append(character.begin(), character.end());
+        return *this;
+    }
+
+    buffer_t& write(char32_t character)
+    {
+        if (character < 0x80)
+        {
+            m_data.push_back(static_cast<char>(character));
+            return *this;
+        }
+        char bytes[4];
+        m_data.append(bytes, utf8_encode(character, bytes));
+        return *this;
+    }
+
+    buffer_t& new_line()
+    {
+        m_prev_style = {};
+        m_data.append("\033[0m\n");
+        return *this;
+    }
+
+    void escape(std::initializer_list<int> args)
+    {
+        control(args, 'm');
+    }
+
+    void control(std::initializer_list<int> args, char command)
+    {
+        sequence_t seq{ *this, args.size() };
+        for (const int arg : args)
+        {
+            seq.param(static_cast<std::uint32_t>(arg));
+        }
+        seq.finish(command, true);
+    }
+
+    buffer_t& move_to(location_t loc)
+    {
+        control({ loc.y + 1, loc.x + 1 }, 'H');
+        return *this;
+    }
+
+    buffer_t& move_right(int count)
+    {
+        if (count == 1)
+        {
+            m_data.append("\033[C");
+        }
+        else
+        {
+            control({ count }, 'C');
+        }
+        return *this;
+    }
+
+    buffer_t& clear_screen()
+    {
+        m_data.append("\033[2J");
+        return *this;
+    }
+
+    void write_color(ground_type_t type, const color_t& col)
+    {
+        sequence_t sgr{ *this, 5 };
+        sgr.color(type, downgrade(col, m_color_depth));
+        sgr.finish('m');
+    }
+
+    void reset()
+    {
+        m_data.append("\033[m");
+    }
+
+    // A control sequence introducer followed by ';'-separated parameters and a final command byte. Room for at most
+    // `max_params` parameters is reserved up front and the digits are written through a pointer; if no parameter is
+    // given, nothing is written.
+    struct sequence_t
+    {
+        buffer_t& m_buffer;
+        std::size_t m_start;
+        char* m_ptr;
+        bool m_empty = true;
+
+        sequence_t(buffer_t& buffer, std::size_t max_params) : m_buffer{ buffer }, m_start{ buffer.m_data.size() }
+        {
+            m_buffer.m_data.resize(m_start + 3 + 11 * max_params);
+            m_ptr = m_buffer.m_data.data() + m_start;
+            *m_ptr++ = '\033';
+            *m_ptr++ = '[';
+        }
+
+        void param(std::uint32_t value)
+        {
+            if (!m_empty)
+            {
+                *m_ptr++ = ';';
+            }
+            m_empty = false;
+            if (value < detail::small_decimals.size())
+            {
+                const auto& item = detail::small_decimals[value];
+                std::memcpy(m_ptr, item.data(), 4);
+                m_ptr += item[3];
+                return;
+            }
+            char digits[10];
+            char* last = std::end(digits);
+            char* first = last;
+            for (; value != 0; value /= 10)
+            {
+                *--first = static_cast<char>('0' + value % 10);
+            }
+            m_ptr = std::copy(first, last, m_ptr);
+        }
+
+        void color(ground_type_t type, const color_t& col)
+        {
+            const std::uint32_t base = type == ground_type_t::foreground ? 30 : 40;
+            if (const auto* c = std::get_if<true_color_t>(&col))
+            {
+                param(base + 8);
+                param(2);
+                param(c->red);
+                param(c->green);
+                param(c->blue);
+            }
+            else if (const auto* c = std::get_if<palette_color_t>(&col))
+            {
+                param(base + 8);
+                param(5);
+                param(c->index);
+            }
+            else if (const auto* c = std::get_if<basic_color_t>(&col))
+            {
+                param(base + static_cast<std::uint32_t>(*c));
+            }
+            else
+            {
+                param(base + 9);
+            }
+        }
+
+        // With `always`, the sequence is written even without parameters, e.g. "\033[C".
+        void finish(char command, bool always = false)
+        {
+            if (m_empty && !always)
+            {
+                m_buffer.m_data.resize(m_start);
+                return;
+            }
+            *m_ptr++ = command;
+            m_buffer.m_data.resize(static_cast<std::size_t>(m_ptr - m_buffer.m_data.data()));
+        }
+    };
+};
+
+inline void output(const area_t::ref_type& area_t, buffer_t& buf)
+{
+    for (int y = 0; y < area_t.m_extent.height; ++y)
+    {
+        const cell_t* row = area_t.row(y).data();
+        int style = -1;
+        for (int x = 0; x < area_t.m_extent.width; ++x)
+        {
+            if (row[x].m_style != style)
+            {
+                style = row[x].m_style;
+                buf.set_style((*area_t.m_styles)[row[x].m_style]);
+            }
+            buf.write(static_cast<char32_t>(row[x].m_code_point));
+        }
+        buf.new_line();
+    }
+    buf.reset();
+    buf.flush();
+}
+
+namespace detail
+{
+
+inline void write_all(int fd, const char* data, std::size_t size)
+{
+    while (size > 0)
+    {
+        const auto written = ::write(fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error{ errno, std::generic_category(), "write" };
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+inline int decimal_width(int value)
+{
+    int result = 1;
+    for (; value >= 10; value /= 10)
+    {
+        ++result;
+    }
+    return result;
+}
+
+}  // namespace detail
+
+// Presents frames on a terminal it owns. The last presented frame is kept, and only the cells which differ from it are
+// emitted: unchanged runs are skipped with cursor movement, style changes are merged into single SGR sequences and the
+// frame is written with a single write(). The cursor and the current style carry over from one frame to the next.
+struct diff_renderer_t
+{
+    explicit diff_renderer_t(color_depth_t depth = color_depth_t::true_color) : m_front{ extent_t{} }
+    {
+        m_buffer.m_color_depth = depth;
+    }
+
+    diff_renderer_t(const diff_renderer_t&) = delete;
+    diff_renderer_t& operator=(const diff_renderer_t&) = delete;
+
+    // The next frame is drawn in full, e.g. after something else wrote to the terminal.
+    void invalidate()
+    {
+        m_valid = false;
+    }
+
+    // Returns the bytes turning the last presented frame into `frame`, and takes `frame` as presented.
+    const std::string& render(const area_t::ref_type& frame)
+    {
+        m_buffer.clear();
+        if (!m_valid || frame.m_extent != m_front.m_extent)
+        {
+            // After clearing, the terminal holds blank cells in the default style, which is what a new front buffer holds.
+            m_front = area_t{ frame.m_extent };
+            m_front_keys.assign(m_front.m_data.size(), 0);
+            m_front_table = 0;
+            m_buffer.m_prev_style = {};
+            m_style = 0;
+            m_buffer.reset();
+            m_buffer.clear_screen();
+            m_cursor = location_t{ -1, -1 };
+            m_valid = true;
+        }
+
+        const style_table_t& styles = *frame.m_styles;
+        // The front buffer holds the cells of the last frame as they were, so when that frame indexed the same
+        // styles, unchanged rows compare equal as memory.
+        const bool same_styles = styles.id() == m_front_table;
+        const int width = frame.m_extent.width;
+        for (int y = 0; y < frame.m_extent.height; ++y)
+        {
+            const cell_t* row = frame.row(y).data();
+            cell_t* front_row = m_front.m_data.data() + static_cast<std::size_t>(y) * width;
+            std::uint64_t* front_keys = m_front_keys.data() + static_cast<std::size_t>(y) * width;
+            if (same_styles && std::memcmp(row, front_row, static_cast<std::size_t>(width) * sizeof(cell_t)) == 0)
+            {
+                continue;
+            }
+            for (int x = 0; x < width; ++x)
+            {
+                const std::uint64_t key = styles.key(row[x].m_style);
+                const bool unchanged = row[x].m_code_point == front_row[x].m_code_point && key == front_keys[x];
+                front_row[x] = row[x];
+                if (unchanged)
+                {
+                    continue;
+                }
+                move_to(row, styles, location_t{ x, y });
+                if (key != m_style)
+                {
+                    m_style = key;
+                    m_buffer.set_style(detail::unpack_style(key));
+                }
+                m_buffer.write(static_cast<char32_t>(row[x].m_code_point));
+                front_keys[x] = key;
+                m_cursor = location_t{ x + 1, y };
+            }
+        }
+        m_front_table = styles.id();
+        return m_buffer.m_data;
+    }
+
+    void present(const area_t::ref_type& frame, int fd = STDOUT_FILENO)
+    {
+        const std::string& bytes = render(frame);
+        detail::write_all(fd, bytes.data(), bytes.size());
+    }
+
+    // Code points as presented, with the style indices of the frame they came from.
+    area_t m_front;
+    // Packed styles as presented.
+    std::vector<std::uint64_t> m_front_keys;
+    // id() of the style table m_front indexes; 0 for none.
+    std::uint64_t m_front_table = 0;
+    buffer_t m_buffer;
+    std::uint64_t m_style = 0;  // packed m_buffer.m_prev_style
+    location_t m_cursor = { -1, -1 };
+    bool m_valid = false;
+
+    // Moves the cursor to loc within the same row either with an escape or by writing the unchanged cells in between
+    // again, whichever is shorter; the latter only when those cells are in the current style.
+    void move_to(const cell_t* row, const style_table_t& styles, location_t loc)
+    {
+        if (m_cursor.y == loc.y && m_cursor.x == loc.x)
+        {
+            return;
+        }
+        if (m_cursor.y == loc.y && 0 <= m_cursor.x && m_cursor.x < loc.x)
+        {
+            const int gap = loc.x - m_cursor.x;
+            const int escape_size = gap == 1 ? 3 : 3 + detail::decimal_width(gap);
+            int text_size = 0;
+            for (int x = m_cursor.x; x < loc.x && text_size < escape_size; ++x)
+            {
+                text_size = styles.key(row[x].m_style) == m_style
+                                ? text_size + static_cast<int>(utf8_size(row[x].m_code_point))
+                                : escape_size;
+            }
+            if (text_size < escape_size)
+            {
+                for (int x = m_cursor.x; x < loc.x; ++x)
+                {
+                    m_buffer.write(static_cast<char32_t>(row[x].m_code_point));
+                }
+            }
+            else
+            {
+                m_buffer.move_right(gap);
+            }
+            return;
+        }
+        m_buffer.move_to(loc);
+    }
+};
+
+// A change to a glyph style: the colors to set and the modes to turn on and off. Composing with `|` merges two deltas
+// field by field, the right one taking precedence, so a chain of them applies with a few stores.
+struct glyph_style_applier_t
+{
+    std::optional<color_t> foreground = {};
+    std::optional<color_t> background = {};
+    modes_t set_modes = {};
+    modes_t reset_modes = {};
+
+    glyph_style_applier_t() = default;
+
+    glyph_style_applier_t(modes_t m) : set_modes{ m }
+    {
+    }
+
+    glyph_style_applier_t(mode m) : set_modes{ m }
+    {
+    }
+
+    glyph_style_t& operator()(glyph_style_t& s) const
+    {
+        if (foreground)
+        {
+            s.foreground = *foreground;
+        }
+        if (background)
+        {
+            s.background = *background;
+        }
+        s.mode_value.reset(reset_modes).set(set_modes);
+        return s;
+    }
+
+    glyph_t& operator()(glyph_t& g) const
+    {
+        (*this)(g.style);
+        return g;
+    }
+
+    operator glyph_style_t() const
+    {
+        glyph_style_t result{};
+        (*this)(result);
+        return result;
+    }
+};
+
+inline glyph_style_applier_t operator|(glyph_style_applier_t lhs, const glyph_style_applier_t& rhs)
+{
+    if (rhs.foreground)
+    {
+        lhs.foreground = rhs.foreground;
+    }
+    if (rhs.background)
+    {
+        lhs.background = rhs.background;
+    }
+    lhs.set_modes.reset(rhs.reset_modes).set(rhs.set_modes);
+    lhs.reset_modes.reset(rhs.set_modes).set(rhs.reset_modes);
+    return lhs;
+}
+
+inline glyph_style_t& operator|=(glyph_style_t& g, const glyph_style_applier_t& applier)
+{
+    applier(g);
+    return g;
+}
+
+inline glyph_style_t operator|(glyph_style_t g, const glyph_style_applier_t& applier)
+{
+    applier(g);
+    return g;
+}
+
+inline glyph_t operator|(glyph_t g, const glyph_style_applier_t& applier)
+{
+    applier(g);
+    return g;
 }
 
 inline glyph_t operator|(character_t ch, const glyph_style_applier_t& applier)
@@ -734,12 +1978,24 @@ inline glyph_t operator|(const char* ch, const glyph_style_applier_t& applier)
 
 inline glyph_style_applier_t fg(const color_t& col)
 {
-    return glyph_style_applier_t{ [=](glyph_style_t& s) { s.foreground = col; } };
+    glyph_style_applier_t result{};
+    result.foreground = col;
+    return result;
 }
 
 inline glyph_style_applier_t bg(const color_t& col)
 {
-    return glyph_style_applier_t{ [=](glyph_style_t& s) { s.background = col; } };
+    glyph_style_applier_t result{};
+    result.background = col;
+    return result;
+}
+
+// Turns modes off, e.g. `style | clear_modes(mode::bold)`.
+inline glyph_style_applier_t clear_modes(modes_t m)
+{
+    glyph_style_applier_t result{};
+    result.reset_modes = m;
+    return result;
 }
 
 }  // namespace core
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace ferrugo
+{
+namespace core
+{
+
+template <class T, std::size_t Alignment = 64>
+struct aligned_allocator
+{
+    static_assert(Alignment >= alignof(T), "aligned_allocator: alignment weaker than the type's own");
+
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+
+    template <class U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+    }
+
+    void deallocate(T* ptr, std::size_t)
+    {
+        ::operator delete(ptr, std::align_val_t{ Alignment });
+    }
+
+    template <class U>
+    friend bool operator==(const aligned_allocator&, const aligned_allocator<U, Alignment>&)
+    {
+        return true;
+    }
+
+    template <class U>
+    friend bool operator!=(const aligned_allocator&, const aligned_allocator<U, Alignment>&)
+    {
+        return false;
+    }
+};
+
+}  // namespace core
+}  // namespace ferrugo
@@ -2,11 +2,17 @@
 
 #include <array>
 #include <cmath>
+#include <ferrugo/core/arrays/dyn_matrix.hpp>
+#include <ferrugo/core/arrays/matmul.hpp>
+#include <ferrugo/core/arrays/simd.hpp>
+#include <ferrugo/core/arrays/soa_vectors.hpp>
 #include <ferrugo/core/math.hpp>
 #include <ferrugo/core/optional.hpp>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <tuple>
 
 namespace ferrugo
 {
@@ -41,6 +47,24 @@ struct is_scalar : std::bool_constant<!is_matrix<T>{}>
 {
 };
 
+template <class Op, class... Args>
+struct matrix_expr;
+
+template <class T>
+struct is_matrix_expr : std::false_type
+{
+};
+
+template <class Op, class... Args>
+struct is_matrix_expr<matrix_expr<Op, Args...>> : std::true_type
+{
+};
+
+template <class Op, class... Args>
+struct is_matrix<matrix_expr<Op, Args...>> : std::true_type
+{
+};
+
 template <class T, class Size>
 struct matrix
 {
@@ -50,57 +74,80 @@ struct matrix
     using location_type = std::array<std::size_t, Size::dim_count>;
 
     static constexpr std::size_t row_count = Size::get(0);
-    static constexpr std::size_t col_count = Size::get(1);
+    static constexpr std::size_t col_count = Size::dim_count > 1 ? Size::get(1) : 1;
     static constexpr std::size_t volume = Size::volume;
 
-    matrix()
+    constexpr matrix()
     {
         std::fill(std::begin(m_data), std::end(m_data), value_type{});
     }
 
-    matrix(uninitialized_t)
+    constexpr matrix(uninitialized_t)
     {
     }
 
-    matrix(const matrix& other)
+    constexpr matrix(const matrix& other)
     {
         std::copy(std::begin(other.m_data), std::end(other.m_data), std::begin(m_data));
     }
 
-    matrix(std::initializer_list<T> init)
+    constexpr matrix(std::initializer_list<T> init)
     {
-        std::copy(std::begin(init), std::end(init), std::begin(m_data));
+        std::fill(std::copy(std::begin(init), std::end(init), std::begin(m_data)), std::end(m_data), value_type{});
     }
 
     template <class U>
-    matrix(const matrix<U, Size>& other)
+    constexpr matrix(const matrix<U, Size>& other)
     {
         std::copy(std::begin(other.m_data), std::end(other.m_data), std::begin(m_data));
     }
 
-    const_reference operator[](std::size_t n) const
+    template <class Op, class... Args, require<std::is_same_v<typename matrix_expr<Op, Args...>::size_type, Size>> = 0>
+    constexpr matrix(const matrix_expr<Op, Args...>& expr)
+    {
+        *this = expr;
+    }
+
+    constexpr matrix& operator=(const matrix&) = default;
+
+    template <class Op, class... Args, require<std::is_same_v<typename matrix_expr<Op, Args...>::size_type, Size>> = 0>
+    constexpr matrix& operator=(const matrix_expr<Op, Args...>& expr)
+    {
+        for (std::size_t n = 0; n < volume; ++n)
+        {
+            m_data[n] = expr[n];
+        }
+        return *this;
+    }
+
+    constexpr const_reference operator[](std::size_t n) const
     {
         return m_data[n];
     }
 
-    reference operator[](std::size_t n)
+    constexpr reference operator[](std::size_t n)
     {
         return m_data[n];
     }
 
-    const_reference operator[](const location_type& loc) const
+    constexpr const_reference operator[](const location_type& loc) const
     {
         return m_data[get_offset(loc)];
     }
 
-    reference operator[](const location_type& loc)
+    constexpr reference operator[](const location_type& loc)
     {
         return m_data[get_offset(loc)];
     }
 
     static constexpr std::ptrdiff_t get_offset(const location_type& loc)
     {
-        return loc[0] * col_count + loc[1];
+        std::ptrdiff_t result = 0;
+        for (std::size_t d = 0; d < Size::dim_count; ++d)
+        {
+            result = result * Size::get(d) + loc[d];
+        }
+        return result;
     }
 
     std::array<value_type, volume> m_data;
@@ -111,6 +158,155 @@ struct is_matrix<matrix<T, Size>> : std::true_type
 {
 };
 
+namespace detail
+{
+
+template <class T>
+struct matrix_size
+{
+};
+
+template <class T, class Size>
+struct matrix_size<matrix<T, Size>>
+{
+    using type = Size;
+};
+
+template <class Op, class... Args>
+struct matrix_size<matrix_expr<Op, Args...>>
+{
+    using type = typename matrix_expr<Op, Args...>::size_type;
+};
+
+template <class T>
+using matrix_size_t = typename matrix_size<std::decay_t<T>>::type;
+
+template <class T>
+constexpr decltype(auto) element(const T& item, std::size_t n)
+{
+    if constexpr (is_matrix<T>{})
+    {
+        return item[n];
+    }
+    else
+    {
+        return item;
+    }
+}
+
+template <class... Args>
+struct first_matrix_size;
+
+template <class Head, class... Tail>
+struct first_matrix_size<Head, Tail...>
+    : std::conditional_t<is_matrix<Head>{}, matrix_size<Head>, first_matrix_size<Tail...>>
+{
+};
+
+// Lvalue matrices are captured by reference; temporaries, nested expressions and scalars by value.
+template <class T>
+using expr_arg_t = std::conditional_t<
+    std::is_lvalue_reference_v<T> && !is_matrix_expr<std::decay_t<T>>{} && is_matrix<std::decay_t<T>>{},
+    const std::decay_t<T>&,
+    std::decay_t<T>>;
+
+template <class L, class R, class = void>
+struct same_matrix_size : std::false_type
+{
+};
+
+template <class L, class R>
+struct same_matrix_size<L, R, std::void_t<typename matrix_size<L>::type, typename matrix_size<R>::type>>
+    : std::is_same<typename matrix_size<L>::type, typename matrix_size<R>::type>
+{
+};
+
+}  // namespace detail
+
+// Lazily evaluated element-wise operation, built by applying element-wise operators to `lazy(m)` or to another
+// expression; element n is computed only when read, so chains such as `lazy(a) + lazy(b) * 2 - c` make a single pass
+// without intermediate matrices. Lvalue operands are held by reference and must outlive the expression. Operators on
+// plain matrices always return matrices: in `lazy(a) + b * 2`, `b * 2` is computed into a temporary first.
+template <class Op, class... Args>
+struct matrix_expr
+{
+    using size_type = typename detail::first_matrix_size<std::decay_t<Args>...>::type;
+    using value_type = std::decay_t<
+        std::invoke_result_t<const Op&, decltype(detail::element(std::declval<const std::decay_t<Args>&>(), 0))...>>;
+
+    static constexpr std::size_t volume = size_type::volume;
+
+    constexpr value_type operator[](std::size_t n) const
+    {
+        return std::apply([&](const auto&... args) { return m_op(detail::element(args, n)...); }, m_args);
+    }
+
+    Op m_op;
+    std::tuple<Args...> m_args;
+};
+
+namespace detail
+{
+
+template <class Op, class... Args>
+constexpr auto lazy_elementwise(Op op, Args&&... args) -> matrix_expr<Op, expr_arg_t<Args&&>...>
+{
+    return { op, std::tuple<expr_arg_t<Args&&>...>{ std::forward<Args>(args)... } };
+}
+
+// Lazy if any operand is an expression, eager otherwise.
+template <class Op, class... Args>
+constexpr auto elementwise(Op op, Args&&... args)
+{
+    if constexpr ((is_matrix_expr<std::decay_t<Args>>{} || ...))
+    {
+        return lazy_elementwise(op, std::forward<Args>(args)...);
+    }
+    else
+    {
+        using expr_type = matrix_expr<Op, expr_arg_t<Args&&>...>;
+        using size_type = typename expr_type::size_type;
+        matrix<typename expr_type::value_type, size_type> result{ uninitialized };
+        for (std::size_t n = 0; n < size_type::volume; ++n)
+        {
+            result[n] = op(element(args, n)...);
+        }
+        return result;
+    }
+}
+
+}  // namespace detail
+
+struct lazy_fn
+{
+    template <class M, require<is_matrix<std::decay_t<M>>{} && !is_matrix_expr<std::decay_t<M>>{}> = 0>
+    constexpr auto operator()(M&& item) const
+    {
+        return detail::lazy_elementwise(std::identity{}, std::forward<M>(item));
+    }
+};
+
+// Opts a matrix into lazy element-wise evaluation; see matrix_expr.
+static constexpr inline auto lazy = lazy_fn{};
+
+struct eval_fn
+{
+    template <class T, class Size>
+    constexpr auto operator()(const matrix<T, Size>& item) const -> matrix<T, Size>
+    {
+        return item;
+    }
+
+    template <class Op, class... Args>
+    constexpr auto operator()(const matrix_expr<Op, Args...>& item) const
+        -> matrix<typename matrix_expr<Op, Args...>::value_type, typename matrix_expr<Op, Args...>::size_type>
+    {
+        return item;
+    }
+};
+
+static constexpr inline auto eval = eval_fn{};
+
 template <class T, std::size_t D>
 using square_matrix = matrix<T, size<D, D>>;
 
@@ -176,52 +372,54 @@ std::ostream& operator<<(std::ostream& os, const vector<T, D>& item)
     return os;
 }
 
+template <class Op, class... Args>
+std::ostream& operator<<(std::ostream& os, const matrix_expr<Op, Args...>& item)
+{
+    return os << eval(item);
+}
+
 template <class T, class Size>
-auto operator+(const matrix<T, Size>& item) -> matrix<T, Size>
+constexpr auto operator+(const matrix<T, Size>& item) -> matrix<T, Size>
 {
     return item;
 }
 
-template <class T, class Size>
-auto operator-(const matrix<T, Size>& item) -> matrix<T, Size>
+template <class E, require<is_matrix<std::decay_t<E>>{}> = 0>
+constexpr auto operator-(E&& item)
 {
-    matrix<T, Size> result{ uninitialized };
-    std::transform(std::begin(item.m_data), std::end(item.m_data), std::begin(result.m_data), std::negate<>{});
-    return result;
+    return detail::elementwise(std::negate<>{}, std::forward<E>(item));
 }
 
-template <class T, class U, class Size, class Res = std::invoke_result_t<std::plus<>, T, U>>
-auto operator+=(matrix<T, Size>& lhs, const matrix<U, Size>& rhs) -> matrix<T, Size>&
+template <class T, class Size, class E, require<detail::same_matrix_size<matrix<T, Size>, std::decay_t<E>>{}> = 0>
+constexpr auto operator+=(matrix<T, Size>& lhs, const E& rhs) -> matrix<T, Size>&
 {
-    std::transform(
-        std::begin(lhs.m_data), std::end(lhs.m_data), std::begin(rhs.m_data), std::begin(lhs.m_data), std::plus<>{});
+    for (std::size_t n = 0; n < Size::volume; ++n)
+    {
+        lhs[n] += rhs[n];
+    }
     return lhs;
 }
 
-template <class T, class U, class Size, class Res = std::invoke_result_t<std::plus<>, T, U>>
-auto operator+(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs) -> matrix<Res, Size>
+template <class L, class R, require<detail::same_matrix_size<std::decay_t<L>, std::decay_t<R>>{}> = 0>
+constexpr auto operator+(L&& lhs, R&& rhs)
 {
-    matrix<Res, Size> result{ uninitialized };
-    std::transform(
-        std::begin(lhs.m_data), std::end(lhs.m_data), std::begin(rhs.m_data), std::begin(result.m_data), std::plus<>{});
-    return result;
+    return detail::elementwise(std::plus<>{}, std::forward<L>(lhs), std::forward<R>(rhs));
 }
 
-template <class T, class U, class Size, class Res = std::invoke_result_t<std::minus<>, T, U>>
-auto operator-=(matrix<T, Size>& lhs, const matrix<U, Size>& rhs) -> matrix<T, Size>&
+template <class T, class Size, class E, require<detail::same_matrix_size<matrix<T, Size>, std::decay_t<E>>{}> = 0>
+constexpr auto operator-=(matrix<T, Size>& lhs, const E& rhs) -> matrix<T, Size>&
 {
-    std::transform(
-        std::begin(lhs.m_data), std::end(lhs.m_data), std::begin(rhs.m_data), std::begin(lhs.m_data), std::minus<>{});
+    for (std::size_t n = 0; n < Size::volume; ++n)
+    {
+        lhs[n] -= rhs[n];
+    }
     return lhs;
 }
 
-template <class T, class U, class Size, class Res = std::invoke_result_t<std::minus<>, T, U>>
-auto operator-(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs) -> matrix<Res, Size>
+template <class L, class R, require<detail::same_matrix_size<std::decay_t<L>, std::decay_t<R>>{}> = 0>
+constexpr auto operator-(L&& lhs, R&& rhs)
 {
-    matrix<Res, Size> result{ uninitialized };
-    std::transform(
-        std::begin(lhs.m_data), std::end(lhs.m_data), std::begin(rhs.m_data), std::begin(result.m_data), std::minus<>{});
-    return result;
+    return detail::elementwise(std::minus<>{}, std::forward<L>(lhs), std::forward<R>(rhs));
 }
 
 template <
@@ -230,42 +428,33 @@ template <
     class Size,
     class Res = std::invoke_result_t<std::multiplies<>, T, U>,
     class = std::enable_if_t<is_scalar<U>{}>>
-auto operator*=(matrix<T, Size>& lhs, U rhs) -> matrix<T, Size>&
+constexpr auto operator*=(matrix<T, Size>& lhs, U rhs) -> matrix<T, Size>&
 {
-    std::transform(
-        std::begin(lhs.m_data),
-        std::end(lhs.m_data),
-        std::begin(lhs.m_data),
-        std::bind(std::multiplies<>{}, std::placeholders::_1, rhs));
+    for (auto& item : lhs.m_data)
+    {
+        item *= rhs;
+    }
     return lhs;
 }
 
 template <
-    class T,
+    class L,
     class U,
-    class Size,
-    class Res = std::invoke_result_t<std::multiplies<>, T, U>,
-    class = std::enable_if_t<is_scalar<U>{}>>
-auto operator*(const matrix<T, Size>& lhs, U rhs) -> matrix<Res, Size>
-{
-    matrix<Res, Size> result{ uninitialized };
-    std::transform(
-        std::begin(lhs.m_data),
-        std::end(lhs.m_data),
-        std::begin(result.m_data),
-        std::bind(std::multiplies<>{}, std::placeholders::_1, rhs));
-    return result;
+    require<is_matrix<std::decay_t<L>>{} && is_scalar<U>{}> = 0,
+    class = std::invoke_result_t<std::multiplies<>, typename std::decay_t<L>::value_type, U>>
+constexpr auto operator*(L&& lhs, U rhs)
+{
+    return detail::elementwise(std::multiplies<>{}, std::forward<L>(lhs), rhs);
 }
 
 template <
     class T,
-    class U,
-    class Size,
-    class Res = std::invoke_result_t<std::multiplies<>, T, U>,
-    class = std::enable_if_t<is_scalar<T>{}>>
-auto operator*(T lhs, const matrix<U, Size>& rhs) -> matrix<Res, Size>
+    class R,
+    require<is_scalar<T>{} && is_matrix<std::decay_t<R>>{}> = 0,
+    class = std::invoke_result_t<std::multiplies<>, T, typename std::decay_t<R>::value_type>>
+constexpr auto operator*(T lhs, R&& rhs)
 {
-    return rhs * lhs;
+    return detail::elementwise(std::multiplies<>{}, lhs, std::forward<R>(rhs));
 }
 
 template <
@@ -275,8 +464,18 @@ template <
     std::size_t C,
     std::size_t D,
     class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-auto operator*(const matrix<T, size<R, D>>& lhs, const matrix<U, size<D, C>>& rhs) -> matrix<Res, size<R, C>>
+constexpr auto operator*(const matrix<T, size<R, D>>& lhs, const matrix<U, size<D, C>>& rhs) -> matrix<Res, size<R, C>>
 {
+    if constexpr (std::is_same_v<T, U> && std::is_same_v<T, Res> && std::is_arithmetic_v<T>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            matrix<Res, size<R, C>> result{ uninitialized };
+            detail::matmul_kernel<T, R, D, C>::apply(lhs.m_data.data(), rhs.m_data.data(), result.m_data.data());
+            return result;
+        }
+    }
+
     matrix<Res, size<R, C>> result{};
     for (std::size_t r = 0; r < R; ++r)
     {
@@ -295,12 +494,21 @@ auto operator*(const matrix<T, size<R, D>>& lhs, const matrix<U, size<D, C>>& rh
     return result;
 }
 
+template <
+    class L,
+    class R,
+    require<is_matrix<L>{} && is_matrix<R>{} && (is_matrix_expr<L>{} || is_matrix_expr<R>{})> = 0>
+constexpr auto operator*(const L& lhs, const R& rhs)
+{
+    return eval(lhs) * eval(rhs);
+}
+
 template <class T, class U, std::size_t D, class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-auto operator*(const vector<T, D>& lhs, const square_matrix<U, D + 1>& rhs) -> vector<Res, D>
+constexpr auto operator*(const vector<T, D>& lhs, const square_matrix<U, D + 1>& rhs) -> vector<Res, D>
 {
     vector<Res, D> result{};
 
-    for (size_t d = 0; d < lhs.size(); ++d)
+    for (std::size_t d = 0; d < D; ++d)
     {
         Res sum = static_cast<Res>(rhs[{ D, d }]);
 
@@ -316,58 +524,112 @@ auto operator*(const vector<T, D>& lhs, const square_matrix<U, D + 1>& rhs) -> v
 }
 
 template <class T, class U, std::size_t D, class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-auto operator*(const square_matrix<U, D + 1>& lhs, const vector<T, D>& rhs) -> vector<Res, D>
+constexpr auto operator*(const square_matrix<U, D + 1>& lhs, const vector<T, D>& rhs) -> vector<Res, D>
 {
     return rhs * lhs;
 }
 
 template <class T, class U, std::size_t D, class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-auto& operator*=(vector<T, D>& lhs, const square_matrix<U, D + 1>& rhs)
+constexpr auto& operator*=(vector<T, D>& lhs, const square_matrix<U, D + 1>& rhs)
 {
     return lhs = lhs * rhs;
 }
 
+struct transform_points_fn
+{
+    template <class T, std::size_t D>
+    constexpr auto operator()(
+        const vector<T, D>* first, const vector<T, D>* last, vector<T, D>* out, const square_matrix<T, D + 1>& m) const
+        -> vector<T, D>*
+    {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (count == 0)
+        {
+            return out;
+        }
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            static_assert(sizeof(vector<T, D>) == D * sizeof(T), "transform_points: vectors must be tightly packed");
+            if (!std::is_constant_evaluated())
+            {
+                detail::affine_kernel<T, D>::apply(m.m_data.data(), first->m_data.data(), out->m_data.data(), count);
+                return out + count;
+            }
+        }
+        return std::transform(first, last, out, [&](const vector<T, D>& v) { return v * m; });
+    }
+
+    // Vectorized across points; `out` may be `in`.
+    template <class T, std::size_t D>
+    auto operator()(const soa_vectors<T, D>& in, soa_vectors<T, D>& out, const square_matrix<T, D + 1>& m) const
+        -> soa_vectors<T, D>&
+    {
+        out.resize(in.size());
+        detail::simd_for_each<T>(
+            in.size(),
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                typename S::type v[D];
+                for (std::size_t d = 0; d < D; ++d)
+                {
+                    v[d] = S::load(in.component(d) + i);
+                }
+                for (std::size_t d = 0; d < D; ++d)
+                {
+                    auto acc = S::broadcast(m[{ D, d }]);
+                    for (std::size_t k = 0; k < D; ++k)
+                    {
+                        acc = acc + v[k] * S::broadcast(m[{ k, d }]);
+                    }
+                    S::store(out.component(d) + i, acc);
+                }
+            });
+        return out;
+    }
+
+    template <class T, std::size_t D>
+    auto operator()(soa_vectors<T, D>& item, const square_matrix<T, D + 1>& m) const -> soa_vectors<T, D>&
+    {
+        return (*this)(item, item, m);
+    }
+};
+
+static constexpr inline auto transform_points = transform_points_fn{};
+
 template <
     class T,
     class U,
     class Size,
     class Res = std::invoke_result_t<std::divides<>, T, U>,
     class = std::enable_if_t<is_scalar<U>{}>>
-auto operator/=(matrix<T, Size>& lhs, U rhs) -> matrix<T, Size>&
+constexpr auto operator/=(matrix<T, Size>& lhs, U rhs) -> matrix<T, Size>&
 {
-    std::transform(
-        std::begin(lhs.m_data),
-        std::end(lhs.m_data),
-        std::begin(lhs.m_data),
-        std::bind(std::divides<>{}, std::placeholders::_1, rhs));
+    for (auto& item : lhs.m_data)
+    {
+        item /= rhs;
+    }
     return lhs;
 }
 
 template <
-    class T,
+    class L,
     class U,
-    class Size,
-    class Res = std::invoke_result_t<std::divides<>, T, U>,
-    class = std::enable_if_t<is_scalar<U>{}>>
-auto operator/(const matrix<T, Size>& lhs, U rhs) -> matrix<Res, Size>
-{
-    matrix<Res, Size> result{ uninitialized };
-    std::transform(
-        std::begin(lhs.m_data),
-        std::end(lhs.m_data),
-        std::begin(result.m_data),
-        std::bind(std::divides<>{}, std::placeholders::_1, rhs));
-    return result;
+    require<is_matrix<std::decay_t<L>>{} && is_scalar<U>{}> = 0,
+    class = std::invoke_result_t<std::divides<>, typename std::decay_t<L>::value_type, U>>
+constexpr auto operator/(L&& lhs, U rhs)
+{
+    return detail::elementwise(std::divides<>{}, std::forward<L>(lhs), rhs);
 }
 
 template <class T, class U, class Size>
-bool operator==(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs)
+constexpr bool operator==(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs)
 {
     return std::equal(std::begin(lhs.m_data), std::end(lhs.m_data), std::begin(rhs.m_data));
 }
 
 template <class T, class U, class Size>
-bool operator!=(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs)
+constexpr bool operator!=(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs)
 {
     return !(lhs == rhs);
 }
@@ -375,7 +637,7 @@ bool operator!=(const matrix<T, Size>& lhs, const matrix<U, Size>& rhs)
 struct minor_fn
 {
     template <class T, std::size_t R, std::size_t C>
-    auto operator()(const matrix<T, size<R, C>>& item, std::size_t row, std::size_t col) const
+    constexpr auto operator()(const matrix<T, size<R, C>>& item, std::size_t row, std::size_t col) const
         -> matrix<T, size<R - 1, C - 1>>
     {
         static_assert(R > 1, "minor: invalid row");
@@ -397,22 +659,183 @@ struct minor_fn
 
 static constexpr inline auto minor = minor_fn{};
 
+template <class T, std::size_t D>
+struct lu
+{
+    using value_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+    // L (unit diagonal, stored below the diagonal) and U (on and above the diagonal) packed into one matrix.
+    square_matrix<value_type, D> m_data;
+    std::array<std::size_t, D> m_permutation;
+    int m_sign;
+    bool m_singular;
+
+    constexpr explicit lu(const square_matrix<T, D>& item)
+        : m_data{ item }
+        , m_permutation{}
+        , m_sign{ 1 }
+        , m_singular{ false }
+    {
+        value_type* a = m_data.m_data.data();
+        std::iota(std::begin(m_permutation), std::end(m_permutation), std::size_t{ 0 });
+
+        // Rows are weighed by their largest element (scaled partial pivoting), so that a matrix with rows of very
+        // different magnitudes is treated as the equivalent one with rows of similar magnitudes. Elimination leaves
+        // rounding errors in place of exact zeros; a pivot no larger than those, relative to its row, counts as zero.
+        std::array<value_type, D> scale{};
+        for (std::size_t r = 0; r < D; ++r)
+        {
+            for (std::size_t c = 0; c < D; ++c)
+            {
+                scale[r] = std::max(scale[r], magnitude(a[r * D + c]));
+            }
+        }
+        const auto weight = [&](std::size_t r, std::size_t c)
+        { return scale[r] > value_type{} ? magnitude(a[r * D + c]) / scale[r] : value_type{}; };
+        const value_type epsilon = static_cast<value_type>(D) * std::numeric_limits<value_type>::epsilon();
+
+        for (std::size_t k = 0; k < D; ++k)
+        {
+            std::size_t pivot = k;
+            for (std::size_t r = k + 1; r < D; ++r)
+            {
+                if (weight(r, k) > weight(pivot, k))
+                {
+                    pivot = r;
+                }
+            }
+
+            if (pivot != k)
+            {
+                std::swap_ranges(a + k * D, a + (k + 1) * D, a + pivot * D);
+                std::swap(m_permutation[k], m_permutation[pivot]);
+                std::swap(scale[k], scale[pivot]);
+                m_sign = -m_sign;
+            }
+
+            const value_type pivot_value = a[k * D + k];
+            const bool finite = pivot_value - pivot_value == value_type{};
+            if (!finite || !(magnitude(pivot_value) > epsilon * scale[k]))
+            {
+                m_singular = true;
+            }
+            if (!finite || pivot_value == value_type{})
+            {
+                continue;
+            }
+
+            const value_type inv_pivot = value_type{ 1 } / a[k * D + k];
+            for (std::size_t r = k + 1; r < D; ++r)
+            {
+                const value_type factor = a[r * D + k] *= inv_pivot;
+                if (factor == value_type{})
+                {
+                    continue;
+                }
+                for (std::size_t c = k + 1; c < D; ++c)
+                {
+                    a[r * D + c] -= factor * a[k * D + c];
+                }
+            }
+        }
+    }
+
+    constexpr bool singular() const
+    {
+        return m_singular;
+    }
+
+    // The product of the pivots, also when they are too small for solve and invert.
+    constexpr value_type det() const
+    {
+        value_type result = static_cast<value_type>(m_sign);
+        for (std::size_t i = 0; i < D; ++i)
+        {
+            result *= m_data.m_data[i * D + i];
+        }
+        return result;
+    }
+
+    // Solves A * x = b for x, with x and b treated as column vectors.
+    constexpr auto solve(const vector<value_type, D>& b) const -> core::optional<vector<value_type, D>>
+    {
+        if (m_singular)
+        {
+            return {};
+        }
+        vector<value_type, D> result{ uninitialized };
+        solve(b.m_data.data(), 1, result.m_data.data(), 1);
+        return result;
+    }
+
+    constexpr auto invert() const -> core::optional<square_matrix<value_type, D>>
+    {
+        if (m_singular)
+        {
+            return {};
+        }
+        square_matrix<value_type, D> result{ uninitialized };
+        std::array<value_type, D> unit{};
+        for (std::size_t c = 0; c < D; ++c)
+        {
+            unit[c] = value_type{ 1 };
+            solve(unit.data(), 1, result.m_data.data() + c, D);
+            unit[c] = value_type{};
+        }
+        return result;
+    }
+
+private:
+    static constexpr value_type magnitude(value_type v)
+    {
+        return v < value_type{} ? -v : v;
+    }
+
+    constexpr void solve(const value_type* b, std::size_t b_stride, value_type* x, std::size_t x_stride) const
+    {
+        const value_type* a = m_data.m_data.data();
+        std::array<value_type, D> y;
+        for (std::size_t r = 0; r < D; ++r)
+        {
+            value_type sum = b[m_permutation[r] * b_stride];
+            for (std::size_t c = 0; c < r; ++c)
+            {
+                sum -= a[r * D + c] * y[c];
+            }
+            y[r] = sum;
+        }
+        for (std::size_t r = D; r-- > 0;)
+        {
+            value_type sum = y[r];
+            for (std::size_t c = r + 1; c < D; ++c)
+            {
+                sum -= a[r * D + c] * y[c];
+            }
+            y[r] = sum / a[r * D + r];
+            x[r * x_stride] = y[r];
+        }
+    }
+};
+
+template <class T, std::size_t D>
+lu(const square_matrix<T, D>&) -> lu<T, D>;
+
 struct det_fn
 {
     template <class T>
-    auto operator()(const square_matrix<T, 1>& item) const -> T
+    constexpr auto operator()(const square_matrix<T, 1>& item) const -> T
     {
         return item[{ 0, 0 }];
     }
 
     template <class T>
-    auto operator()(const square_matrix<T, 2>& item) const
+    constexpr auto operator()(const square_matrix<T, 2>& item) const
     {
         return +item[{ 0, 0 }] * item[{ 1, 1 }] - item[{ 0, 1 }] * item[{ 1, 0 }];
     }
 
     template <class T>
-    auto operator()(const square_matrix<T, 3>& item) const
+    constexpr auto operator()(const square_matrix<T, 3>& item) const
     {
         return +item[{ 0, 0 }] * item[{ 1, 1 }] * item[{ 2, 2 }] + item[{ 0, 1 }] * item[{ 1, 2 }] * item[{ 2, 0 }]
                + item[{ 0, 2 }] * item[{ 1, 0 }] * item[{ 2, 1 }] - item[{ 0, 2 }] * item[{ 1, 1 }] * item[{ 2, 0 }]
@@ -420,17 +843,22 @@ struct det_fn
     }
 
     template <class T, std::size_t D>
-    auto operator()(const square_matrix<T, D>& item) const
+    constexpr auto operator()(const square_matrix<T, D>& item) const -> T
     {
-        using Res = decltype(item[{ 0, 0 }] * (*this)(minor(item, 0, 0)));
-        auto sum = Res{};
-
-        for (std::size_t i = 0; i < D; ++i)
+        const auto result = lu{ item }.det();
+        if constexpr (std::is_integral_v<T>)
         {
-            sum += (i % 2 == 0 ? 1 : -1) * item[{ 0, i }] * (*this)(minor(item, 0, i));
+            return static_cast<T>(result < 0 ? result - 0.5 : result + 0.5);
+        }
+        else
+        {
+            return result;
         }
-
-        return sum;
+    }
+    template <class Op, class... Args>
+    constexpr auto operator()(const matrix_expr<Op, Args...>& item) const
+    {
+        return (*this)(eval(item));
     }
 };
 
@@ -439,38 +867,216 @@ static constexpr inline auto det = det_fn{};
 struct invert_fn
 {
     template <class T, std::size_t D>
-    auto operator()(const square_matrix<T, D>& value) const -> core::optional<square_matrix<T, D>>
+    constexpr auto operator()(const square_matrix<T, D>& value) const -> core::optional<square_matrix<T, D>>
     {
-        auto d = det(value);
-
-        if (!d)
+        if constexpr (D == 1)
         {
-            return {};
+            if (!value[0])
+            {
+                return {};
+            }
+            return square_matrix<T, D>{ T{ 1 } / value[0] };
         }
+        else if constexpr (D <= 3)
+        {
+            const auto d = det(value);
 
-        square_matrix<T, D> result;
+            if (!d)
+            {
+                return {};
+            }
 
-        for (std::size_t r = 0; r < D; ++r)
+            square_matrix<T, D> result;
+
+            for (std::size_t r = 0; r < D; ++r)
+            {
+                for (std::size_t c = 0; c < D; ++c)
+                {
+                    result[{ c, r }] = T((r + c) % 2 == 0 ? 1 : -1) * det(minor(value, r, c)) / d;
+                }
+            }
+
+            return result;
+        }
+        else
         {
-            for (std::size_t c = 0; c < D; ++c)
+            static_assert(
+                !std::is_integral_v<T>,
+                "invert: the inverse of an integral matrix above 3x3 is not integral; use lu{ m }.invert(), which computes "
+                "in double");
+            auto result = lu{ value }.invert();
+            if (!result)
             {
-                result[{ c, r }] = T((r + c) % 2 == 0 ? 1 : -1) * det(minor(value, r, c)) / d;
+                return {};
             }
+            return square_matrix<T, D>{ *result };
         }
-
-        return result;
+    }
+    template <class Op, class... Args>
+    constexpr auto operator()(const matrix_expr<Op, Args...>& item) const
+    {
+        return (*this)(eval(item));
     }
 };
 
 static constexpr inline auto invert = invert_fn{};
 
+struct solve_fn
+{
+    template <class T, std::size_t D>
+    constexpr auto operator()(const square_matrix<T, D>& a, const vector<T, D>& b) const
+        -> core::optional<vector<typename lu<T, D>::value_type, D>>
+    {
+        return lu{ a }.solve(b);
+    }
+};
+
+static constexpr inline auto solve = solve_fn{};
+
+namespace detail
+{
+
+template <class T, std::size_t D>
+struct batch_source
+{
+    std::array<const T*, D> m_data;
+
+    template <class S>
+    auto load(std::size_t d, std::size_t i) const
+    {
+        return S::load(m_data[d] + i);
+    }
+};
+
+template <class T, std::size_t D>
+struct broadcast_source
+{
+    vector<T, D> m_value;
+
+    template <class S>
+    auto load(std::size_t d, std::size_t) const
+    {
+        return S::broadcast(m_value[d]);
+    }
+};
+
+template <class T, std::size_t D>
+auto make_batch_source(const soa_vectors<T, D>& item) -> batch_source<T, D>
+{
+    batch_source<T, D> result;
+    for (std::size_t d = 0; d < D; ++d)
+    {
+        result.m_data[d] = item.component(d);
+    }
+    return result;
+}
+
+template <class T, std::size_t D>
+auto make_batch_source(const vector<T, D>& item) -> broadcast_source<T, D>
+{
+    return { item };
+}
+
+// The right hand side of a batch operation is either another soa_vectors or a single vector applied to every element.
+template <class R, class T, std::size_t D>
+struct is_batch_operand : std::bool_constant<std::is_same_v<R, soa_vectors<T, D>> || std::is_same_v<R, vector<T, D>>>
+{
+};
+
+template <class T, std::size_t D>
+std::size_t batch_size(const soa_vectors<T, D>& lhs, const vector<T, D>&)
+{
+    return lhs.size();
+}
+
+template <class T, std::size_t D>
+std::size_t batch_size(const soa_vectors<T, D>& lhs, const soa_vectors<T, D>& rhs)
+{
+    if (lhs.size() != rhs.size())
+    {
+        throw std::invalid_argument{ "soa_vectors: size mismatch" };
+    }
+    return lhs.size();
+}
+
+template <class S, std::size_t D, class L, class R>
+auto batch_dot(const L& lhs, const R& rhs, std::size_t i)
+{
+    auto result = lhs.template load<S>(0, i) * rhs.template load<S>(0, i);
+    for (std::size_t d = 1; d < D; ++d)
+    {
+        result = result + lhs.template load<S>(d, i) * rhs.template load<S>(d, i);
+    }
+    return result;
+}
+
+}  // namespace detail
+
 struct dot_fn
 {
     template <class T, class U, std::size_t D, class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-    auto operator()(const vector<T, D>& lhs, const vector<U, D>& rhs) const -> Res
+    constexpr auto operator()(const vector<T, D>& lhs, const vector<U, D>& rhs) const -> Res
     {
         return std::inner_product(std::begin(lhs.m_data), std::end(lhs.m_data), std::begin(rhs.m_data), Res{});
     }
+
+    template <
+        class L,
+        class R,
+        require<is_dyn_matrix<L>{} && is_dyn_matrix<R>{}> = 0,
+        class Res = std::invoke_result_t<std::multiplies<>, typename L::value_type, typename R::value_type>>
+    auto operator()(const L& lhs, const R& rhs) const -> Res
+    {
+        const auto l = detail::as_ref(lhs);
+        const auto r = detail::as_ref(rhs);
+        detail::check_same_shape(l, r);
+        if (l.is_contiguous() && r.is_contiguous())
+        {
+            return std::inner_product(l.m_data, l.m_data + l.m_rows * l.m_cols, r.m_data, Res{});
+        }
+        Res sum = {};
+        for (std::size_t row = 0; row < l.row_count(); ++row)
+        {
+            for (std::size_t col = 0; col < l.col_count(); ++col)
+            {
+                sum += l[{ row, col }] * r[{ row, col }];
+            }
+        }
+        return sum;
+    }
+
+    template <
+        class L,
+        class R,
+        require<is_matrix<L>{} && is_matrix<R>{} && (is_matrix_expr<L>{} || is_matrix_expr<R>{})> = 0>
+    constexpr auto operator()(const L& lhs, const R& rhs) const
+    {
+        return (*this)(eval(lhs), eval(rhs));
+    }
+
+    template <class T, std::size_t D, class R, require<detail::is_batch_operand<R, T, D>{}> = 0>
+    auto operator()(const soa_vectors<T, D>& lhs, const R& rhs, T* out) const -> T*
+    {
+        const auto count = detail::batch_size(lhs, rhs);
+        const auto l = detail::make_batch_source(lhs);
+        const auto r = detail::make_batch_source(rhs);
+        detail::simd_for_each<T>(
+            count,
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                S::store(out + i, detail::batch_dot<S, D>(l, r, i));
+            });
+        return out + count;
+    }
+
+    template <class T, std::size_t D, class R, require<detail::is_batch_operand<R, T, D>{}> = 0>
+    auto operator()(const soa_vectors<T, D>& lhs, const R& rhs) const -> typename soa_vectors<T, D>::component_type
+    {
+        typename soa_vectors<T, D>::component_type result(detail::batch_size(lhs, rhs));
+        (*this)(lhs, rhs, result.data());
+        return result;
+    }
 };
 
 static constexpr inline auto dot = dot_fn{};
@@ -478,7 +1084,30 @@ static constexpr inline auto dot = dot_fn{};
 struct norm_fn
 {
     template <class T, std::size_t D, class Res = std::invoke_result_t<std::multiplies<>, T, T>>
-    auto operator()(const vector<T, D>& item) const -> Res
+    constexpr auto operator()(const vector<T, D>& item) const -> Res
+    {
+        return dot(item, item);
+    }
+
+    template <class M, require<is_dyn_matrix<M>{}> = 0>
+    auto operator()(const M& item) const
+    {
+        return dot(item, item);
+    }
+    template <class Op, class... Args>
+    constexpr auto operator()(const matrix_expr<Op, Args...>& item) const
+    {
+        return (*this)(eval(item));
+    }
+
+    template <class T, std::size_t D>
+    auto operator()(const soa_vectors<T, D>& item, T* out) const -> T*
+    {
+        return dot(item, item, out);
+    }
+
+    template <class T, std::size_t D>
+    auto operator()(const soa_vectors<T, D>& item) const -> typename soa_vectors<T, D>::component_type
     {
         return dot(item, item);
     }
@@ -489,10 +1118,43 @@ static constexpr inline auto norm = norm_fn{};
 struct length_fn
 {
     template <class T, std::size_t D>
-    auto operator()(const vector<T, D>& item) const
+    constexpr auto operator()(const vector<T, D>& item) const
+    {
+        return math::sqrt(norm(item));
+    }
+
+    template <class M, require<is_dyn_matrix<M>{}> = 0>
+    auto operator()(const M& item) const
     {
         return math::sqrt(norm(item));
     }
+    template <class Op, class... Args>
+    constexpr auto operator()(const matrix_expr<Op, Args...>& item) const
+    {
+        return (*this)(eval(item));
+    }
+
+    template <class T, std::size_t D>
+    auto operator()(const soa_vectors<T, D>& item, T* out) const -> T*
+    {
+        const auto v = detail::make_batch_source(item);
+        detail::simd_for_each<T>(
+            item.size(),
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                S::store(out + i, S::sqrt(detail::batch_dot<S, D>(v, v, i)));
+            });
+        return out + item.size();
+    }
+
+    template <class T, std::size_t D>
+    auto operator()(const soa_vectors<T, D>& item) const -> typename soa_vectors<T, D>::component_type
+    {
+        typename soa_vectors<T, D>::component_type result(item.size());
+        (*this)(item, result.data());
+        return result;
+    }
 };
 
 static constexpr inline auto length = length_fn{};
@@ -500,7 +1162,7 @@ static constexpr inline auto length = length_fn{};
 struct normalize_fn
 {
     template <class T, std::size_t D>
-    auto operator()(vector<T, D>& item, T expected = T{ 1 }) const -> vector<T, D>&
+    constexpr auto operator()(vector<T, D>& item, T expected = T{ 1 }) const -> vector<T, D>&
     {
         auto len = length(item);
 
@@ -511,6 +1173,26 @@ struct normalize_fn
 
         return item;
     }
+
+    // Vectors shorter than the smallest normal value are scaled as if they had that length, so zero vectors stay zero.
+    template <class T, std::size_t D>
+    auto operator()(soa_vectors<T, D>& item, T expected = T{ 1 }) const -> soa_vectors<T, D>&
+    {
+        const auto v = detail::make_batch_source(item);
+        detail::simd_for_each<T>(
+            item.size(),
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                const auto len = S::sqrt(detail::batch_dot<S, D>(v, v, i));
+                const auto inverse = S::broadcast(T{ 1 }) / S::max(len, S::broadcast(std::numeric_limits<T>::min()));
+                for (std::size_t d = 0; d < D; ++d)
+                {
+                    S::store(item.component(d) + i, v.template load<S>(d, i) * inverse * S::broadcast(expected));
+                }
+            });
+        return item;
+    }
 };
 
 static constexpr inline auto normalize = normalize_fn{};
@@ -518,7 +1200,7 @@ static constexpr inline auto normalize = normalize_fn{};
 struct unit_fn
 {
     template <class T, std::size_t D>
-    auto operator()(vector<T, D> item, T expected = T{ 1 }) const -> vector<T, D>
+    constexpr auto operator()(vector<T, D> item, T expected = T{ 1 }) const -> vector<T, D>
     {
         normalize(item, expected);
         return item;
@@ -530,10 +1212,40 @@ static constexpr inline auto unit = unit_fn{};
 struct distance_fn
 {
     template <class T, class U, size_t D>
-    auto operator()(const vector<T, D>& lhs, const vector<U, D>& rhs) const
+    constexpr auto operator()(const vector<T, D>& lhs, const vector<U, D>& rhs) const
     {
         return length(rhs - lhs);
     }
+
+    template <class T, std::size_t D, class R, require<detail::is_batch_operand<R, T, D>{}> = 0>
+    auto operator()(const soa_vectors<T, D>& lhs, const R& rhs, T* out) const -> T*
+    {
+        const auto count = detail::batch_size(lhs, rhs);
+        const auto l = detail::make_batch_source(lhs);
+        const auto r = detail::make_batch_source(rhs);
+        detail::simd_for_each<T>(
+            count,
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                auto sum = S::broadcast(T{});
+                for (std::size_t d = 0; d < D; ++d)
+                {
+                    const auto diff = r.template load<S>(d, i) - l.template load<S>(d, i);
+                    sum = sum + diff * diff;
+                }
+                S::store(out + i, S::sqrt(sum));
+            });
+        return out + count;
+    }
+
+    template <class T, std::size_t D, class R, require<detail::is_batch_operand<R, T, D>{}> = 0>
+    auto operator()(const soa_vectors<T, D>& lhs, const R& rhs) const -> typename soa_vectors<T, D>::component_type
+    {
+        typename soa_vectors<T, D>::component_type result(detail::batch_size(lhs, rhs));
+        (*this)(lhs, rhs, result.data());
+        return result;
+    }
 };
 
 static constexpr inline auto distance = distance_fn{};
@@ -541,18 +1253,76 @@ static constexpr inline auto distance = distance_fn{};
 struct cross_fn
 {
     template <class T, class U, class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-    auto operator()(const vector_2d<T>& lhs, const vector_2d<U>& rhs) const -> Res
+    constexpr auto operator()(const vector_2d<T>& lhs, const vector_2d<U>& rhs) const -> Res
     {
         return lhs[0] * rhs[1] - lhs[1] * rhs[0];
     }
 
     template <class T, class U, class Res = std::invoke_result_t<std::multiplies<>, T, U>>
-    auto operator()(const vector_3d<T>& lhs, const vector_3d<U>& rhs) const -> vector<Res, 3>
+    constexpr auto operator()(const vector_3d<T>& lhs, const vector_3d<U>& rhs) const -> vector<Res, 3>
     {
         return vector<Res, 3>{ lhs[1] * rhs[2] - lhs[2] * rhs[1],
                                lhs[2] * rhs[0] - lhs[0] * rhs[2],
                                lhs[0] * rhs[1] - lhs[1] * rhs[0] };
     }
+
+    template <class T, class R, require<detail::is_batch_operand<R, T, 2>{}> = 0>
+    auto operator()(const soa_vectors<T, 2>& lhs, const R& rhs, T* out) const -> T*
+    {
+        const auto count = detail::batch_size(lhs, rhs);
+        const auto l = detail::make_batch_source(lhs);
+        const auto r = detail::make_batch_source(rhs);
+        detail::simd_for_each<T>(
+            count,
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                const auto lhs_part = l.template load<S>(0, i) * r.template load<S>(1, i);
+                const auto rhs_part = l.template load<S>(1, i) * r.template load<S>(0, i);
+                S::store(out + i, lhs_part - rhs_part);
+            });
+        return out + count;
+    }
+
+    template <class T, class R, require<detail::is_batch_operand<R, T, 2>{}> = 0>
+    auto operator()(const soa_vectors<T, 2>& lhs, const R& rhs) const -> typename soa_vectors<T, 2>::component_type
+    {
+        typename soa_vectors<T, 2>::component_type result(detail::batch_size(lhs, rhs));
+        (*this)(lhs, rhs, result.data());
+        return result;
+    }
+
+    template <class T, class R, require<detail::is_batch_operand<R, T, 3>{}> = 0>
+    auto operator()(const soa_vectors<T, 3>& lhs, const R& rhs, soa_vectors<T, 3>& out) const -> soa_vectors<T, 3>&
+    {
+        out.resize(detail::batch_size(lhs, rhs));
+        const auto l = detail::make_batch_source(lhs);
+        const auto r = detail::make_batch_source(rhs);
+        detail::simd_for_each<T>(
+            out.size(),
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                const auto l0 = l.template load<S>(0, i);
+                const auto l1 = l.template load<S>(1, i);
+                const auto l2 = l.template load<S>(2, i);
+                const auto r0 = r.template load<S>(0, i);
+                const auto r1 = r.template load<S>(1, i);
+                const auto r2 = r.template load<S>(2, i);
+                S::store(out.component(0) + i, l1 * r2 - l2 * r1);
+                S::store(out.component(1) + i, l2 * r0 - l0 * r2);
+                S::store(out.component(2) + i, l0 * r1 - l1 * r0);
+            });
+        return out;
+    }
+
+    template <class T, class R, require<detail::is_batch_operand<R, T, 3>{}> = 0>
+    auto operator()(const soa_vectors<T, 3>& lhs, const R& rhs) const -> soa_vectors<T, 3>
+    {
+        soa_vectors<T, 3> result;
+        (*this)(lhs, rhs, result);
+        return result;
+    }
 };
 
 static constexpr inline auto cross = cross_fn{};
@@ -560,10 +1330,38 @@ static constexpr inline auto cross = cross_fn{};
 struct projection_fn
 {
     template <class T, size_t D>
-    auto operator()(const vector<T, D>& lhs, const vector<T, D>& rhs) const
+    constexpr auto operator()(const vector<T, D>& lhs, const vector<T, D>& rhs) const
     {
         return rhs * (dot(rhs, lhs) / norm(rhs));
     }
+
+    template <class T, std::size_t D, class R, require<detail::is_batch_operand<R, T, D>{}> = 0>
+    auto operator()(const soa_vectors<T, D>& lhs, const R& rhs, soa_vectors<T, D>& out) const -> soa_vectors<T, D>&
+    {
+        out.resize(detail::batch_size(lhs, rhs));
+        const auto l = detail::make_batch_source(lhs);
+        const auto r = detail::make_batch_source(rhs);
+        detail::simd_for_each<T>(
+            out.size(),
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                const auto scale = detail::batch_dot<S, D>(r, l, i) / detail::batch_dot<S, D>(r, r, i);
+                for (std::size_t d = 0; d < D; ++d)
+                {
+                    S::store(out.component(d) + i, r.template load<S>(d, i) * scale);
+                }
+            });
+        return out;
+    }
+
+    template <class T, std::size_t D, class R, require<detail::is_batch_operand<R, T, D>{}> = 0>
+    auto operator()(const soa_vectors<T, D>& lhs, const R& rhs) const -> soa_vectors<T, D>
+    {
+        soa_vectors<T, D> result;
+        (*this)(lhs, rhs, result);
+        return result;
+    }
 };
 
 static constexpr inline auto projection = projection_fn{};
@@ -571,7 +1369,7 @@ static constexpr inline auto projection = projection_fn{};
 struct rejection_fn
 {
     template <class T, size_t D>
-    auto operator()(const vector<T, D>& lhs, const vector<T, D>& rhs) const
+    constexpr auto operator()(const vector<T, D>& lhs, const vector<T, D>& rhs) const
     {
         return lhs - projection(lhs, rhs);
     }
@@ -0,0 +1,588 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ferrugo/core/arrays/aligned_allocator.hpp>
+#include <ferrugo/core/thread_pool.hpp>
+#include <ferrugo/core/type_traits.hpp>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ferrugo
+{
+namespace core
+{
+
+template <class T>
+struct dyn_matrix_ref
+{
+    using value_type = std::remove_const_t<T>;
+    using reference = T&;
+    using location_type = std::array<std::size_t, 2>;
+
+    dyn_matrix_ref(T* data, std::size_t rows, std::size_t cols, std::ptrdiff_t row_stride, std::ptrdiff_t col_stride)
+        : m_data{ data }
+        , m_rows{ rows }
+        , m_cols{ cols }
+        , m_row_stride{ row_stride }
+        , m_col_stride{ col_stride }
+    {
+    }
+
+    template <class U, require<std::is_convertible_v<U*, T*> && !std::is_same_v<U, T>> = 0>
+    dyn_matrix_ref(const dyn_matrix_ref<U>& other)
+        : dyn_matrix_ref(other.m_data, other.m_rows, other.m_cols, other.m_row_stride, other.m_col_stride)
+    {
+    }
+
+    std::size_t row_count() const
+    {
+        return m_rows;
+    }
+
+    std::size_t col_count() const
+    {
+        return m_cols;
+    }
+
+    reference operator[](const location_type& loc) const
+    {
+        return m_data[static_cast<std::ptrdiff_t>(loc[0]) * m_row_stride + static_cast<std::ptrdiff_t>(loc[1]) * m_col_stride];
+    }
+
+    bool is_contiguous() const
+    {
+        return m_col_stride == 1 && (m_rows <= 1 || m_row_stride == static_cast<std::ptrdiff_t>(m_cols));
+    }
+
+    dyn_matrix_ref submatrix(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const
+    {
+        if (row + rows > m_rows || col + cols > m_cols)
+        {
+            throw std::out_of_range{ "dyn_matrix: submatrix out of bounds" };
+        }
+        return dyn_matrix_ref{ &(*this)[{ row, col }], rows, cols, m_row_stride, m_col_stride };
+    }
+
+    dyn_matrix_ref transpose() const
+    {
+        return dyn_matrix_ref{ m_data, m_cols, m_rows, m_col_stride, m_row_stride };
+    }
+
+    // Copies `other` element by element; shapes must match. `other` may share storage with *this.
+    template <class U>
+    const dyn_matrix_ref& assign(const dyn_matrix_ref<U>& other) const;
+
+    T* m_data;
+    std::size_t m_rows;
+    std::size_t m_cols;
+    std::ptrdiff_t m_row_stride;
+    std::ptrdiff_t m_col_stride;
+};
+
+template <class T>
+struct dyn_matrix
+{
+    using value_type = T;
+    using const_reference = const T&;
+    using reference = T&;
+    using location_type = std::array<std::size_t, 2>;
+    using storage_type = std::vector<T, aligned_allocator<T>>;
+    using ref_type = dyn_matrix_ref<const T>;
+    using mut_ref_type = dyn_matrix_ref<T>;
+
+    dyn_matrix() : dyn_matrix(0, 0)
+    {
+    }
+
+    dyn_matrix(std::size_t rows, std::size_t cols) : m_rows{ rows }, m_cols{ cols }, m_data(rows * cols)
+    {
+    }
+
+    dyn_matrix(std::size_t rows, std::size_t cols, std::initializer_list<T> init) : dyn_matrix(rows, cols)
+    {
+        if (init.size() != m_data.size())
+        {
+            throw std::invalid_argument{ "dyn_matrix: initializer size mismatch" };
+        }
+        std::copy(std::begin(init), std::end(init), std::begin(m_data));
+    }
+
+    template <class U>
+    explicit dyn_matrix(const dyn_matrix_ref<U>& other) : dyn_matrix(other.row_count(), other.col_count())
+    {
+        mut_ref().assign(other);
+    }
+
+    template <class U>
+    explicit dyn_matrix(const dyn_matrix<U>& other) : dyn_matrix(other.ref())
+    {
+    }
+
+    std::size_t row_count() const
+    {
+        return m_rows;
+    }
+
+    std::size_t col_count() const
+    {
+        return m_cols;
+    }
+
+    const_reference operator[](std::size_t n) const
+    {
+        return m_data[n];
+    }
+
+    reference operator[](std::size_t n)
+    {
+        return m_data[n];
+    }
+
+    const_reference operator[](const location_type& loc) const
+    {
+        return m_data[loc[0] * m_cols + loc[1]];
+    }
+
+    reference operator[](const location_type& loc)
+    {
+        return m_data[loc[0] * m_cols + loc[1]];
+    }
+
+    ref_type ref() const
+    {
+        return ref_type{ m_data.data(), m_rows, m_cols, static_cast<std::ptrdiff_t>(m_cols), 1 };
+    }
+
+    mut_ref_type mut_ref()
+    {
+        return mut_ref_type{ m_data.data(), m_rows, m_cols, static_cast<std::ptrdiff_t>(m_cols), 1 };
+    }
+
+    ref_type submatrix(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const
+    {
+        return ref().submatrix(row, col, rows, cols);
+    }
+
+    mut_ref_type submatrix(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols)
+    {
+        return mut_ref().submatrix(row, col, rows, cols);
+    }
+
+    ref_type transpose() const
+    {
+        return ref().transpose();
+    }
+
+    mut_ref_type transpose()
+    {
+        return mut_ref().transpose();
+    }
+
+    std::size_t m_rows;
+    std::size_t m_cols;
+    storage_type m_data;
+};
+
+template <class T>
+struct is_dyn_matrix : std::false_type
+{
+};
+
+template <class T>
+struct is_dyn_matrix<dyn_matrix<T>> : std::true_type
+{
+};
+
+template <class T>
+struct is_dyn_matrix<dyn_matrix_ref<T>> : std::true_type
+{
+};
+
+namespace detail
+{
+
+template <class T>
+auto as_ref(const dyn_matrix<T>& item) -> dyn_matrix_ref<const T>
+{
+    return item.ref();
+}
+
+template <class T>
+auto as_ref(const dyn_matrix_ref<T>& item) -> dyn_matrix_ref<const T>
+{
+    return item;
+}
+
+template <class L, class R>
+void check_same_shape(const dyn_matrix_ref<L>& lhs, const dyn_matrix_ref<R>& rhs)
+{
+    if (lhs.row_count() != rhs.row_count() || lhs.col_count() != rhs.col_count())
+    {
+        throw std::invalid_argument{ "dyn_matrix: shape mismatch" };
+    }
+}
+
+template <class Out, class In, class Op>
+void dyn_transform(const dyn_matrix_ref<Out>& out, const dyn_matrix_ref<In>& in, Op op)
+{
+    check_same_shape(out, in);
+    if (out.is_contiguous() && in.is_contiguous())
+    {
+        std::transform(in.m_data, in.m_data + in.m_rows * in.m_cols, out.m_data, op);
+        return;
+    }
+    for (std::size_t r = 0; r < out.m_rows; ++r)
+    {
+        for (std::size_t c = 0; c < out.m_cols; ++c)
+        {
+            out[{ r, c }] = op(in[{ r, c }]);
+        }
+    }
+}
+
+template <class Out, class L, class R, class Op>
+void dyn_transform(const dyn_matrix_ref<Out>& out, const dyn_matrix_ref<L>& lhs, const dyn_matrix_ref<R>& rhs, Op op)
+{
+    check_same_shape(out, lhs);
+    check_same_shape(lhs, rhs);
+    if (out.is_contiguous() && lhs.is_contiguous() && rhs.is_contiguous())
+    {
+        std::transform(lhs.m_data, lhs.m_data + lhs.m_rows * lhs.m_cols, rhs.m_data, out.m_data, op);
+        return;
+    }
+    for (std::size_t r = 0; r < out.m_rows; ++r)
+    {
+        for (std::size_t c = 0; c < out.m_cols; ++c)
+        {
+            out[{ r, c }] = op(lhs[{ r, c }], rhs[{ r, c }]);
+        }
+    }
+}
+
+// Whether the address ranges spanned by the two views intersect.
+template <class A, class B>
+bool overlaps(const dyn_matrix_ref<A>& a, const dyn_matrix_ref<B>& b)
+{
+    const auto bytes = [](const auto& m)
+    {
+        const auto* first = reinterpret_cast<const char*>(&m[{ 0, 0 }]);
+        const auto* last = reinterpret_cast<const char*>(&m[{ m.m_rows - 1, m.m_cols - 1 }]) + sizeof(*m.m_data);
+        return std::pair{ first, last };
+    };
+    if (a.m_rows == 0 || a.m_cols == 0 || b.m_rows == 0 || b.m_cols == 0)
+    {
+        return false;
+    }
+    const auto [a_first, a_last] = bytes(a);
+    const auto [b_first, b_last] = bytes(b);
+    return std::less<>{}(a_first, b_last) && std::less<>{}(b_first, a_last);
+}
+
+// Whether writing `out` element by element may change elements of `in` before they are read: the views share storage
+// but are not the same view (e.g. a transpose or a shifted submatrix).
+template <class Out, class In>
+bool must_copy_before_write(const dyn_matrix_ref<Out>& out, const dyn_matrix_ref<In>& in)
+{
+    const bool same_layout = static_cast<const void*>(out.m_data) == static_cast<const void*>(in.m_data)
+                             && out.m_row_stride == in.m_row_stride && out.m_col_stride == in.m_col_stride;
+    return !same_layout && overlaps(out, in);
+}
+
+// lhs = op(lhs, rhs) element-wise. An rhs sharing storage with lhs in a different layout (e.g. its transpose) is
+// copied first, as the loop would otherwise read elements it has already written.
+template <class T, class R, class Op>
+void dyn_compound_assign(const dyn_matrix_ref<T>& lhs, const dyn_matrix_ref<const R>& rhs, Op op)
+{
+    if (must_copy_before_write(lhs, rhs))
+    {
+        const dyn_matrix<R> copy{ rhs };
+        dyn_transform(lhs, dyn_matrix_ref<const T>{ lhs }, copy.ref(), op);
+        return;
+    }
+    dyn_transform(lhs, dyn_matrix_ref<const T>{ lhs }, rhs, op);
+}
+
+struct dyn_multiply_config
+{
+    static constexpr std::size_t block = 64;
+    static constexpr std::size_t parallel_threshold = 128 * 128 * 128;
+};
+
+// Adds lhs[row_begin, row_end) * rhs into out; rhs has to be row-contiguous (ldr elements between rows).
+template <class T, class L, class R>
+void dyn_multiply_rows(
+    const dyn_matrix_ref<T>& out,
+    const dyn_matrix_ref<const L>& lhs,
+    const R* rhs,
+    std::ptrdiff_t ldr,
+    std::size_t row_begin,
+    std::size_t row_end)
+{
+    constexpr std::size_t block = dyn_multiply_config::block;
+    const std::size_t depth = lhs.col_count();
+    const std::size_t cols = out.col_count();
+    for (std::size_t i0 = row_begin; i0 < row_end; i0 += block)
+    {
+        const std::size_t i1 = std::min(i0 + block, row_end);
+        for (std::size_t k0 = 0; k0 < depth; k0 += block)
+        {
+            const std::size_t k1 = std::min(k0 + block, depth);
+            for (std::size_t j0 = 0; j0 < cols; j0 += block)
+            {
+                const std::size_t j1 = std::min(j0 + block, cols);
+                for (std::size_t i = i0; i < i1; ++i)
+                {
+                    T* out_row = &out[{ i, 0 }];
+                    for (std::size_t k = k0; k < k1; ++k)
+                    {
+                        const T a = lhs[{ i, k }];
+                        const R* rhs_row = rhs + static_cast<std::ptrdiff_t>(k) * ldr;
+                        for (std::size_t j = j0; j < j1; ++j)
+                        {
+                            out_row[j] += a * rhs_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Multiplies on `pool` when the product is large enough to be worth it; sequentially if pool is null.
+template <class T, class L, class R>
+auto dyn_multiply(const dyn_matrix_ref<const L>& lhs, const dyn_matrix_ref<const R>& rhs, thread_pool_t* pool)
+    -> dyn_matrix<T>
+{
+    if (lhs.col_count() != rhs.row_count())
+    {
+        throw std::invalid_argument{ "dyn_matrix: shape mismatch" };
+    }
+
+    dyn_matrix<T> result(lhs.row_count(), rhs.col_count());
+
+    // Transposed views and other column-strided operands are packed once so that the inner loop stays contiguous.
+    dyn_matrix<R> packed;
+    const R* rhs_data = rhs.m_data;
+    std::ptrdiff_t ldr = rhs.m_row_stride;
+    if (rhs.m_col_stride != 1)
+    {
+        packed = dyn_matrix<R>(rhs);
+        rhs_data = packed.m_data.data();
+        ldr = static_cast<std::ptrdiff_t>(packed.col_count());
+    }
+
+    constexpr std::size_t block = dyn_multiply_config::block;
+    const std::size_t rows = lhs.row_count();
+    const std::size_t volume = rows * lhs.col_count() * rhs.col_count();
+    const auto out = result.mut_ref();
+    if (!pool || pool->size() <= 1 || volume < dyn_multiply_config::parallel_threshold)
+    {
+        dyn_multiply_rows(out, lhs, rhs_data, ldr, 0, rows);
+        return result;
+    }
+
+    // Each task owns a disjoint band of output rows.
+    pool->parallel_for(
+        (rows + block - 1) / block,
+        [&](std::size_t i)
+        { dyn_multiply_rows(out, lhs, rhs_data, ldr, i * block, std::min((i + 1) * block, rows)); });
+    return result;
+}
+
+// Shared by the operators; started on first use.
+inline thread_pool_t& default_thread_pool()
+{
+    static thread_pool_t pool{};
+    return pool;
+}
+
+}  // namespace detail
+
+template <class T>
+template <class U>
+const dyn_matrix_ref<T>& dyn_matrix_ref<T>::assign(const dyn_matrix_ref<U>& other) const
+{
+    const auto copy = [](const auto& v) -> value_type { return v; };
+    if (detail::must_copy_before_write(*this, other))
+    {
+        const dyn_matrix<std::remove_const_t<U>> source{ other };
+        detail::dyn_transform(*this, source.ref(), copy);
+        return *this;
+    }
+    detail::dyn_transform(*this, other, copy);
+    return *this;
+}
+
+template <class M, require<is_dyn_matrix<M>{}> = 0>
+std::ostream& operator<<(std::ostream& os, const M& item)
+{
+    const auto ref = detail::as_ref(item);
+    os << "[";
+    for (std::size_t r = 0; r < ref.row_count(); ++r)
+    {
+        os << "[";
+        for (std::size_t c = 0; c < ref.col_count(); ++c)
+        {
+            if (c != 0)
+            {
+                os << " ";
+            }
+            os << ref[{ r, c }];
+        }
+        os << "]";
+    }
+    os << "]";
+    return os;
+}
+
+template <class M, require<is_dyn_matrix<M>{}> = 0>
+auto operator+(const M& item) -> dyn_matrix<typename M::value_type>
+{
+    return dyn_matrix<typename M::value_type>{ detail::as_ref(item) };
+}
+
+template <class M, require<is_dyn_matrix<M>{}> = 0>
+auto operator-(const M& item) -> dyn_matrix<typename M::value_type>
+{
+    const auto ref = detail::as_ref(item);
+    dyn_matrix<typename M::value_type> result(ref.row_count(), ref.col_count());
+    detail::dyn_transform(result.mut_ref(), ref, std::negate<>{});
+    return result;
+}
+
+template <
+    class L,
+    class R,
+    require<is_dyn_matrix<L>{} && is_dyn_matrix<R>{}> = 0,
+    class Res = std::invoke_result_t<std::plus<>, typename L::value_type, typename R::value_type>>
+auto operator+(const L& lhs, const R& rhs) -> dyn_matrix<Res>
+{
+    const auto l = detail::as_ref(lhs);
+    dyn_matrix<Res> result(l.row_count(), l.col_count());
+    detail::dyn_transform(result.mut_ref(), l, detail::as_ref(rhs), std::plus<>{});
+    return result;
+}
+
+template <
+    class L,
+    class R,
+    require<is_dyn_matrix<L>{} && is_dyn_matrix<R>{}> = 0,
+    class Res = std::invoke_result_t<std::minus<>, typename L::value_type, typename R::value_type>>
+auto operator-(const L& lhs, const R& rhs) -> dyn_matrix<Res>
+{
+    const auto l = detail::as_ref(lhs);
+    dyn_matrix<Res> result(l.row_count(), l.col_count());
+    detail::dyn_transform(result.mut_ref(), l, detail::as_ref(rhs), std::minus<>{});
+    return result;
+}
+
+template <class T, class R, require<is_dyn_matrix<R>{}> = 0>
+auto operator+=(dyn_matrix<T>& lhs, const R& rhs) -> dyn_matrix<T>&
+{
+    detail::dyn_compound_assign(lhs.mut_ref(), detail::as_ref(rhs), std::plus<>{});
+    return lhs;
+}
+
+template <class T, class R, require<is_dyn_matrix<R>{}> = 0>
+auto operator-=(dyn_matrix<T>& lhs, const R& rhs) -> dyn_matrix<T>&
+{
+    detail::dyn_compound_assign(lhs.mut_ref(), detail::as_ref(rhs), std::minus<>{});
+    return lhs;
+}
+
+template <
+    class M,
+    class U,
+    require<is_dyn_matrix<M>{} && std::is_arithmetic_v<U>> = 0,
+    class Res = std::invoke_result_t<std::multiplies<>, typename M::value_type, U>>
+auto operator*(const M& lhs, U rhs) -> dyn_matrix<Res>
+{
+    const auto l = detail::as_ref(lhs);
+    dyn_matrix<Res> result(l.row_count(), l.col_count());
+    detail::dyn_transform(result.mut_ref(), l, [=](const auto& v) { return v * rhs; });
+    return result;
+}
+
+template <
+    class U,
+    class M,
+    require<is_dyn_matrix<M>{} && std::is_arithmetic_v<U>> = 0,
+    class Res = std::invoke_result_t<std::multiplies<>, U, typename M::value_type>>
+auto operator*(U lhs, const M& rhs) -> dyn_matrix<Res>
+{
+    return rhs * lhs;
+}
+
+template <class T, class U, require<std::is_arithmetic_v<U>> = 0>
+auto operator*=(dyn_matrix<T>& lhs, U rhs) -> dyn_matrix<T>&
+{
+    detail::dyn_transform(lhs.mut_ref(), lhs.ref(), [=](const T& v) { return v * rhs; });
+    return lhs;
+}
+
+template <
+    class M,
+    class U,
+    require<is_dyn_matrix<M>{} && std::is_arithmetic_v<U>> = 0,
+    class Res = std::invoke_result_t<std::divides<>, typename M::value_type, U>>
+auto operator/(const M& lhs, U rhs) -> dyn_matrix<Res>
+{
+    const auto l = detail::as_ref(lhs);
+    dyn_matrix<Res> result(l.row_count(), l.col_count());
+    detail::dyn_transform(result.mut_ref(), l, [=](const auto& v) { return v / rhs; });
+    return result;
+}
+
+template <class T, class U, require<std::is_arithmetic_v<U>> = 0>
+auto operator/=(dyn_matrix<T>& lhs, U rhs) -> dyn_matrix<T>&
+{
+    detail::dyn_transform(lhs.mut_ref(), lhs.ref(), [=](const T& v) { return v / rhs; });
+    return lhs;
+}
+
+template <
+    class L,
+    class R,
+    require<is_dyn_matrix<L>{} && is_dyn_matrix<R>{}> = 0,
+    class Res = std::invoke_result_t<std::multiplies<>, typename L::value_type, typename R::value_type>>
+auto operator*(const L& lhs, const R& rhs) -> dyn_matrix<Res>
+{
+    return detail::dyn_multiply<Res>(detail::as_ref(lhs), detail::as_ref(rhs), &detail::default_thread_pool());
+}
+
+template <class L, class R, require<is_dyn_matrix<L>{} && is_dyn_matrix<R>{}> = 0>
+bool operator==(const L& lhs, const R& rhs)
+{
+    const auto l = detail::as_ref(lhs);
+    const auto r = detail::as_ref(rhs);
+    if (l.row_count() != r.row_count() || l.col_count() != r.col_count())
+    {
+        return false;
+    }
+    for (std::size_t row = 0; row < l.row_count(); ++row)
+    {
+        for (std::size_t col = 0; col < l.col_count(); ++col)
+        {
+            if (!(l[{ row, col }] == r[{ row, col }]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class L, class R, require<is_dyn_matrix<L>{} && is_dyn_matrix<R>{}> = 0>
+bool operator!=(const L& lhs, const R& rhs)
+{
+    return !(lhs == rhs);
+}
+
+}  // namespace core
+}  // namespace ferrugo
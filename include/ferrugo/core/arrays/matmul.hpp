@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ferrugo
+{
+namespace core
+{
+
+namespace detail
+{
+
+// Row-major kernels working on contiguous storage.
+// The generic version is register-blocked: each output row is produced in strips of `block` columns whose accumulators
+// stay in registers while the shared dimension is walked; leftover columns fall back to plain dot products.
+template <class T, std::size_t R, std::size_t D, std::size_t C>
+struct matmul_kernel
+{
+    static constexpr std::size_t block = 4;
+
+    static void apply(const T* __restrict lhs, const T* __restrict rhs, T* __restrict out)
+    {
+        for (std::size_t r = 0; r < R; ++r)
+        {
+            const T* row = lhs + r * D;
+            std::size_t c0 = 0;
+            for (; c0 + block <= C; c0 += block)
+            {
+                T acc[block] = {};
+                for (std::size_t i = 0; i < D; ++i)
+                {
+                    const T a = row[i];
+                    for (std::size_t b = 0; b < block; ++b)
+                    {
+                        acc[b] += a * rhs[i * C + c0 + b];
+                    }
+                }
+                for (std::size_t b = 0; b < block; ++b)
+                {
+                    out[r * C + c0 + b] = acc[b];
+                }
+            }
+            for (; c0 < C; ++c0)
+            {
+                T sum = {};
+                for (std::size_t i = 0; i < D; ++i)
+                {
+                    sum += row[i] * rhs[i * C + c0];
+                }
+                out[r * C + c0] = sum;
+            }
+        }
+    }
+};
+
+#if defined(__SSE2__)
+
+template <>
+struct matmul_kernel<float, 2, 2, 2>
+{
+    static void apply(const float* lhs, const float* rhs, float* out)
+    {
+        // [a0 a1 a2 a3] x [b0 b1 b2 b3] = [a0*b0 + a1*b2, a0*b1 + a1*b3, a2*b0 + a3*b2, a2*b1 + a3*b3]
+        const __m128 a = _mm_loadu_ps(lhs);
+        const __m128 b = _mm_loadu_ps(rhs);
+        const __m128 a_even = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0));
+        const __m128 a_odd = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1));
+        const __m128 b_top = _mm_movelh_ps(b, b);
+        const __m128 b_bottom = _mm_movehl_ps(b, b);
+        _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(a_even, b_top), _mm_mul_ps(a_odd, b_bottom)));
+    }
+};
+
+template <>
+struct matmul_kernel<float, 4, 4, 4>
+{
+    static void apply(const float* lhs, const float* rhs, float* out)
+    {
+        const __m128 b0 = _mm_loadu_ps(rhs + 0);
+        const __m128 b1 = _mm_loadu_ps(rhs + 4);
+        const __m128 b2 = _mm_loadu_ps(rhs + 8);
+        const __m128 b3 = _mm_loadu_ps(rhs + 12);
+        for (std::size_t r = 0; r < 4; ++r)
+        {
+            const float* a = lhs + 4 * r;
+            __m128 acc = _mm_mul_ps(_mm_set1_ps(a[0]), b0);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(a[1]), b1));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(a[2]), b2));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(a[3]), b3));
+            _mm_storeu_ps(out + 4 * r, acc);
+        }
+    }
+};
+
+template <>
+struct matmul_kernel<double, 2, 2, 2>
+{
+    static void apply(const double* lhs, const double* rhs, double* out)
+    {
+        const __m128d b0 = _mm_loadu_pd(rhs + 0);
+        const __m128d b1 = _mm_loadu_pd(rhs + 2);
+        for (std::size_t r = 0; r < 2; ++r)
+        {
+            const double* a = lhs + 2 * r;
+            _mm_storeu_pd(out + 2 * r, _mm_add_pd(_mm_mul_pd(_mm_set1_pd(a[0]), b0), _mm_mul_pd(_mm_set1_pd(a[1]), b1)));
+        }
+    }
+};
+
+template <>
+struct matmul_kernel<double, 4, 4, 4>
+{
+    static void apply(const double* lhs, const double* rhs, double* out)
+    {
+#if defined(__AVX__)
+        const __m256d b0 = _mm256_loadu_pd(rhs + 0);
+        const __m256d b1 = _mm256_loadu_pd(rhs + 4);
+        const __m256d b2 = _mm256_loadu_pd(rhs + 8);
+        const __m256d b3 = _mm256_loadu_pd(rhs + 12);
+        for (std::size_t r = 0; r < 4; ++r)
+        {
+            const double* a = lhs + 4 * r;
+            __m256d acc = _mm256_mul_pd(_mm256_set1_pd(a[0]), b0);
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(a[1]), b1));
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(a[2]), b2));
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(a[3]), b3));
+            _mm256_storeu_pd(out + 4 * r, acc);
+        }
+#else
+        for (std::size_t r = 0; r < 4; ++r)
+        {
+            const double* a = lhs + 4 * r;
+            for (std::size_t half = 0; half < 4; half += 2)
+            {
+                __m128d acc = _mm_mul_pd(_mm_set1_pd(a[0]), _mm_loadu_pd(rhs + 0 + half));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(a[1]), _mm_loadu_pd(rhs + 4 + half)));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(a[2]), _mm_loadu_pd(rhs + 8 + half)));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(a[3]), _mm_loadu_pd(rhs + 12 + half)));
+                _mm_storeu_pd(out + 4 * r + half, acc);
+            }
+        }
+#endif
+    }
+};
+
+#endif  // __SSE2__
+
+// Applies an affine transform stored as a (D + 1) x (D + 1) row-major matrix to `count` row vectors of size D.
+// The translation lives in the last row, matching `vector * square_matrix<D + 1>`.
+template <class T, std::size_t D>
+struct affine_kernel
+{
+    static void apply(const T* m, const T* in, T* out, std::size_t count)
+    {
+        constexpr std::size_t N = D + 1;
+        for (std::size_t p = 0; p < count; ++p, in += D, out += D)
+        {
+            T acc[D];
+            for (std::size_t d = 0; d < D; ++d)
+            {
+                acc[d] = m[D * N + d];
+            }
+            for (std::size_t i = 0; i < D; ++i)
+            {
+                const T v = in[i];
+                for (std::size_t d = 0; d < D; ++d)
+                {
+                    acc[d] += v * m[i * N + d];
+                }
+            }
+            for (std::size_t d = 0; d < D; ++d)
+            {
+                out[d] = acc[d];
+            }
+        }
+    }
+};
+
+#if defined(__SSE2__)
+
+template <>
+struct affine_kernel<float, 3>
+{
+    static void apply(const float* m, const float* in, float* out, std::size_t count)
+    {
+        const __m128 r0 = _mm_loadu_ps(m + 0);
+        const __m128 r1 = _mm_loadu_ps(m + 4);
+        const __m128 r2 = _mm_loadu_ps(m + 8);
+        const __m128 r3 = _mm_loadu_ps(m + 12);
+        for (std::size_t p = 0; p < count; ++p, in += 3, out += 3)
+        {
+            __m128 acc = _mm_add_ps(r3, _mm_mul_ps(_mm_set1_ps(in[0]), r0));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(in[1]), r1));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(in[2]), r2));
+            alignas(16) float res[4];
+            _mm_store_ps(res, acc);
+            out[0] = res[0];
+            out[1] = res[1];
+            out[2] = res[2];
+        }
+    }
+};
+
+#endif  // __SSE2__
+
+#if defined(__AVX__)
+
+template <>
+struct affine_kernel<double, 3>
+{
+    static void apply(const double* m, const double* in, double* out, std::size_t count)
+    {
+        const __m256d r0 = _mm256_loadu_pd(m + 0);
+        const __m256d r1 = _mm256_loadu_pd(m + 4);
+        const __m256d r2 = _mm256_loadu_pd(m + 8);
+        const __m256d r3 = _mm256_loadu_pd(m + 12);
+        for (std::size_t p = 0; p < count; ++p, in += 3, out += 3)
+        {
+            __m256d acc = _mm256_add_pd(r3, _mm256_mul_pd(_mm256_set1_pd(in[0]), r0));
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(in[1]), r1));
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(in[2]), r2));
+            alignas(32) double res[4];
+            _mm256_store_pd(res, acc);
+            out[0] = res[0];
+            out[1] = res[1];
+            out[2] = res[2];
+        }
+    }
+};
+
+#endif  // __AVX__
+
+}  // namespace detail
+}  // namespace core
+}  // namespace ferrugo
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <ferrugo/core/arrays/array.hpp>
+
+namespace ferrugo
+{
+namespace core
+{
+
+namespace detail
+{
+
+// Hamilton product p q on (x, y, z, w) storage.
+template <class T>
+constexpr void quaternion_product(const T* p, const T* q, T* out)
+{
+    const T x = p[3] * q[0] + p[0] * q[3] + p[1] * q[2] - p[2] * q[1];
+    const T y = p[3] * q[1] - p[0] * q[2] + p[1] * q[3] + p[2] * q[0];
+    const T z = p[3] * q[2] + p[0] * q[1] - p[1] * q[0] + p[2] * q[3];
+    const T w = p[3] * q[3] - p[0] * q[0] - p[1] * q[1] - p[2] * q[2];
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = w;
+}
+
+// v + w t + u x t, where t = 2 u x v and q = (u, w)
+template <class T>
+constexpr void quaternion_rotate(const T* q, const T* v, T* out)
+{
+    const T tx = 2 * (q[1] * v[2] - q[2] * v[1]);
+    const T ty = 2 * (q[2] * v[0] - q[0] * v[2]);
+    const T tz = 2 * (q[0] * v[1] - q[1] * v[0]);
+    const T x = v[0] + q[3] * tx + (q[1] * tz - q[2] * ty);
+    const T y = v[1] + q[3] * ty + (q[2] * tx - q[0] * tz);
+    const T z = v[2] + q[3] * tz + (q[0] * ty - q[1] * tx);
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+}
+
+template <class T>
+struct quaternion_kernel
+{
+    static void apply(const T* p, const T* q, T* out)
+    {
+        quaternion_product(p, q, out);
+    }
+};
+
+// Both specializations compute (pw * q + px * [qw -qz qy -qx]) + (py * [qz qw -qx -qy] + pz * [-qy qx qw -qz]).
+
+#if defined(__SSE2__)
+
+template <>
+struct quaternion_kernel<float>
+{
+    static void apply(const float* p, const float* q, float* out)
+    {
+        const __m128 a = _mm_loadu_ps(p);
+        const __m128 b = _mm_loadu_ps(q);
+        const __m128 b_x = _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3));
+        const __m128 b_y = _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128 b_z = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+        const __m128 a_x = _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0));
+        const __m128 a_y = _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1));
+        const __m128 a_z = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2));
+        const __m128 a_w = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128 w = _mm_mul_ps(a_w, b);
+        const __m128 x = _mm_mul_ps(_mm_mul_ps(a_x, _mm_setr_ps(1.F, -1.F, 1.F, -1.F)), b_x);
+        const __m128 y = _mm_mul_ps(_mm_mul_ps(a_y, _mm_setr_ps(1.F, 1.F, -1.F, -1.F)), b_y);
+        const __m128 z = _mm_mul_ps(_mm_mul_ps(a_z, _mm_setr_ps(-1.F, 1.F, 1.F, -1.F)), b_z);
+        _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(w, x), _mm_add_ps(y, z)));
+    }
+};
+
+#endif  // __SSE2__
+
+#if defined(__AVX__)
+
+template <>
+struct quaternion_kernel<double>
+{
+    static void apply(const double* p, const double* q, double* out)
+    {
+        const __m256d a = _mm256_loadu_pd(p);
+        const __m256d a_low = _mm256_permute2f128_pd(a, a, 0x00);
+        const __m256d a_high = _mm256_permute2f128_pd(a, a, 0x11);
+        const __m256d b = _mm256_loadu_pd(q);
+        const __m256d b_y = _mm256_permute2f128_pd(b, b, 0x01);
+        const __m256d b_x = _mm256_permute_pd(b_y, 0b0101);
+        const __m256d b_z = _mm256_permute_pd(b, 0b0101);
+        const __m256d w = _mm256_mul_pd(_mm256_permute_pd(a_high, 0b1111), b);
+        const __m256d x = _mm256_mul_pd(_mm256_mul_pd(_mm256_permute_pd(a_low, 0b0000), _mm256_setr_pd(1, -1, 1, -1)), b_x);
+        const __m256d y = _mm256_mul_pd(_mm256_mul_pd(_mm256_permute_pd(a_low, 0b1111), _mm256_setr_pd(1, 1, -1, -1)), b_y);
+        const __m256d z = _mm256_mul_pd(_mm256_mul_pd(_mm256_permute_pd(a_high, 0b0000), _mm256_setr_pd(-1, 1, 1, -1)), b_z);
+        _mm256_storeu_pd(out, _mm256_add_pd(_mm256_add_pd(w, x), _mm256_add_pd(y, z)));
+    }
+};
+
+#endif  // __AVX__
+
+template <class T>
+constexpr void multiply_quaternions(const T* p, const T* q, T* out)
+{
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            return quaternion_kernel<T>::apply(p, q, out);
+        }
+    }
+    quaternion_product(p, q, out);
+}
+
+}  // namespace detail
+
+// Rotation stored as (x, y, z, w). Follows the row-vector convention of matrix: `v * q` rotates v, and `a * b` rotates
+// by a, then by b (the Hamilton product b a), so that to_matrix(a * b) == to_matrix(a) * to_matrix(b).
+template <class T>
+struct quaternion
+{
+    using value_type = T;
+
+    constexpr quaternion() : m_data{ T{}, T{}, T{}, T{ 1 } }
+    {
+    }
+
+    constexpr explicit quaternion(uninitialized_t)
+    {
+    }
+
+    constexpr quaternion(T x, T y, T z, T w) : m_data{ x, y, z, w }
+    {
+    }
+
+    // `axis` must be a unit vector; `angle` is in radians.
+    static quaternion from_axis_angle(const vector_3d<T>& axis, T angle)
+    {
+        const T s = std::sin(angle / 2);
+        return quaternion{ axis[0] * s, axis[1] * s, axis[2] * s, std::cos(angle / 2) };
+    }
+
+    constexpr T x() const
+    {
+        return m_data[0];
+    }
+
+    constexpr T y() const
+    {
+        return m_data[1];
+    }
+
+    constexpr T z() const
+    {
+        return m_data[2];
+    }
+
+    constexpr T w() const
+    {
+        return m_data[3];
+    }
+
+    constexpr T operator[](std::size_t n) const
+    {
+        return m_data[n];
+    }
+
+    constexpr T& operator[](std::size_t n)
+    {
+        return m_data[n];
+    }
+
+    std::array<value_type, 4> m_data;
+};
+
+// Rotation followed by translation: `v * t` == `v * t.rotation + t.translation`. Seven values instead of the 16 of the
+// equivalent square_matrix_3d, and `a * b` (a, then b) costs one quaternion product and one vector rotation.
+// Batches of points are cheaper through `transform_points(..., to_matrix(t))` than rotated one by one.
+template <class T>
+struct rigid_transform
+{
+    using value_type = T;
+
+    constexpr rigid_transform() = default;
+
+    constexpr explicit rigid_transform(uninitialized_t) : rotation{ uninitialized }, translation{ uninitialized }
+    {
+    }
+
+    constexpr explicit rigid_transform(const quaternion<T>& r, const vector_3d<T>& t = {}) : rotation{ r }, translation{ t }
+    {
+    }
+
+    constexpr explicit rigid_transform(const vector_3d<T>& t) : rotation{}, translation{ t }
+    {
+    }
+
+    quaternion<T> rotation;
+    vector_3d<T> translation;
+};
+
+template <class T>
+constexpr auto operator*(const quaternion<T>& lhs, const quaternion<T>& rhs) -> quaternion<T>
+{
+    quaternion<T> result{ uninitialized };
+    detail::multiply_quaternions(rhs.m_data.data(), lhs.m_data.data(), result.m_data.data());
+    return result;
+}
+
+template <class T>
+constexpr auto operator*=(quaternion<T>& lhs, const quaternion<T>& rhs) -> quaternion<T>&
+{
+    return lhs = lhs * rhs;
+}
+
+template <class T>
+constexpr auto operator*(const vector_3d<T>& lhs, const quaternion<T>& rhs) -> vector_3d<T>
+{
+    vector_3d<T> result{ uninitialized };
+    detail::quaternion_rotate(rhs.m_data.data(), lhs.m_data.data(), result.m_data.data());
+    return result;
+}
+
+template <class T>
+constexpr auto operator*=(vector_3d<T>& lhs, const quaternion<T>& rhs) -> vector_3d<T>&
+{
+    return lhs = lhs * rhs;
+}
+
+template <class T>
+constexpr auto operator*(const rigid_transform<T>& lhs, const rigid_transform<T>& rhs) -> rigid_transform<T>
+{
+    rigid_transform<T> result{ uninitialized };
+    detail::multiply_quaternions(rhs.rotation.m_data.data(), lhs.rotation.m_data.data(), result.rotation.m_data.data());
+    detail::quaternion_rotate(rhs.rotation.m_data.data(), lhs.translation.m_data.data(), result.translation.m_data.data());
+    for (std::size_t d = 0; d < 3; ++d)
+    {
+        result.translation[d] += rhs.translation[d];
+    }
+    return result;
+}
+
+template <class T>
+constexpr auto operator*=(rigid_transform<T>& lhs, const rigid_transform<T>& rhs) -> rigid_transform<T>&
+{
+    return lhs = lhs * rhs;
+}
+
+template <class T>
+constexpr auto operator*(const vector_3d<T>& lhs, const rigid_transform<T>& rhs) -> vector_3d<T>
+{
+    return lhs * rhs.rotation + rhs.translation;
+}
+
+template <class T>
+constexpr auto operator*=(vector_3d<T>& lhs, const rigid_transform<T>& rhs) -> vector_3d<T>&
+{
+    return lhs = lhs * rhs;
+}
+
+template <class T>
+constexpr bool operator==(const quaternion<T>& lhs, const quaternion<T>& rhs)
+{
+    return lhs.m_data == rhs.m_data;
+}
+
+template <class T>
+constexpr bool operator!=(const quaternion<T>& lhs, const quaternion<T>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <class T>
+constexpr bool operator==(const rigid_transform<T>& lhs, const rigid_transform<T>& rhs)
+{
+    return lhs.rotation == rhs.rotation && lhs.translation == rhs.translation;
+}
+
+template <class T>
+constexpr bool operator!=(const rigid_transform<T>& lhs, const rigid_transform<T>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream& os, const quaternion<T>& item)
+{
+    return os << "[" << item.x() << " " << item.y() << " " << item.z() << " " << item.w() << "]";
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream& os, const rigid_transform<T>& item)
+{
+    return os << "[" << item.rotation << " " << item.translation << "]";
+}
+
+struct conjugate_fn
+{
+    template <class T>
+    constexpr auto operator()(const quaternion<T>& item) const -> quaternion<T>
+    {
+        return quaternion<T>{ -item.x(), -item.y(), -item.z(), item.w() };
+    }
+};
+
+static constexpr inline auto conjugate = conjugate_fn{};
+
+// Expects unit rotations, so the inverse of a quaternion is its conjugate.
+struct inverse_fn
+{
+    template <class T>
+    constexpr auto operator()(const quaternion<T>& item) const -> quaternion<T>
+    {
+        return conjugate(item);
+    }
+
+    template <class T>
+    constexpr auto operator()(const rigid_transform<T>& item) const -> rigid_transform<T>
+    {
+        const auto rotation = conjugate(item.rotation);
+        return rigid_transform<T>{ rotation, -(item.translation * rotation) };
+    }
+};
+
+static constexpr inline auto inverse = inverse_fn{};
+
+// Long chains of compositions drift away from unit length; this pulls the rotation back.
+struct renormalize_fn
+{
+    template <class T>
+    constexpr auto operator()(quaternion<T>& item) const -> quaternion<T>&
+    {
+        const T len = math::sqrt(
+            item.x() * item.x() + item.y() * item.y() + item.z() * item.z() + item.w() * item.w());
+        if (len)
+        {
+            for (auto& v : item.m_data)
+            {
+                v /= len;
+            }
+        }
+        return item;
+    }
+
+    template <class T>
+    constexpr auto operator()(rigid_transform<T>& item) const -> rigid_transform<T>&
+    {
+        (*this)(item.rotation);
+        return item;
+    }
+};
+
+static constexpr inline auto renormalize = renormalize_fn{};
+
+struct to_matrix_fn
+{
+    template <class T>
+    constexpr auto operator()(const quaternion<T>& item) const -> square_matrix_3d<T>
+    {
+        return (*this)(rigid_transform<T>{ item });
+    }
+
+    template <class T>
+    constexpr auto operator()(const rigid_transform<T>& item) const -> square_matrix_3d<T>
+    {
+        const auto& q = item.rotation;
+        const auto& t = item.translation;
+        const T xx = q.x() * q.x();
+        const T yy = q.y() * q.y();
+        const T zz = q.z() * q.z();
+        const T xy = q.x() * q.y();
+        const T xz = q.x() * q.z();
+        const T yz = q.y() * q.z();
+        const T wx = q.w() * q.x();
+        const T wy = q.w() * q.y();
+        const T wz = q.w() * q.z();
+        return square_matrix_3d<T>{ T{ 1 } - 2 * (yy + zz),
+                                    2 * (xy + wz),
+                                    2 * (xz - wy),
+                                    T{},
+                                    2 * (xy - wz),
+                                    T{ 1 } - 2 * (xx + zz),
+                                    2 * (yz + wx),
+                                    T{},
+                                    2 * (xz + wy),
+                                    2 * (yz - wx),
+                                    T{ 1 } - 2 * (xx + yy),
+                                    T{},
+                                    t[0],
+                                    t[1],
+                                    t[2],
+                                    T{ 1 } };
+    }
+};
+
+static constexpr inline auto to_matrix = to_matrix_fn{};
+
+// The upper-left 3x3 block must be a rotation (orthonormal, no scale or shear).
+struct to_quaternion_fn
+{
+    template <class T>
+    constexpr auto operator()(const square_matrix_3d<T>& item) const -> quaternion<T>
+    {
+        // r(i, j) is the column-vector rotation, i.e. the transpose of item's block.
+        const auto r = [&](std::size_t i, std::size_t j) { return item[{ j, i }]; };
+        const T trace = r(0, 0) + r(1, 1) + r(2, 2);
+        if (trace > T{})
+        {
+            const T s = math::sqrt(trace + T{ 1 }) * 2;
+            return quaternion<T>{ (r(2, 1) - r(1, 2)) / s, (r(0, 2) - r(2, 0)) / s, (r(1, 0) - r(0, 1)) / s, s / 4 };
+        }
+        if (r(0, 0) > r(1, 1) && r(0, 0) > r(2, 2))
+        {
+            const T s = math::sqrt(T{ 1 } + r(0, 0) - r(1, 1) - r(2, 2)) * 2;
+            return quaternion<T>{ s / 4, (r(0, 1) + r(1, 0)) / s, (r(0, 2) + r(2, 0)) / s, (r(2, 1) - r(1, 2)) / s };
+        }
+        if (r(1, 1) > r(2, 2))
+        {
+            const T s = math::sqrt(T{ 1 } + r(1, 1) - r(0, 0) - r(2, 2)) * 2;
+            return quaternion<T>{ (r(0, 1) + r(1, 0)) / s, s / 4, (r(1, 2) + r(2, 1)) / s, (r(0, 2) - r(2, 0)) / s };
+        }
+        const T s = math::sqrt(T{ 1 } + r(2, 2) - r(0, 0) - r(1, 1)) * 2;
+        return quaternion<T>{ (r(0, 2) + r(2, 0)) / s, (r(1, 2) + r(2, 1)) / s, s / 4, (r(1, 0) - r(0, 1)) / s };
+    }
+};
+
+static constexpr inline auto to_quaternion = to_quaternion_fn{};
+
+struct to_rigid_transform_fn
+{
+    template <class T>
+    constexpr auto operator()(const square_matrix_3d<T>& item) const -> rigid_transform<T>
+    {
+        return rigid_transform<T>{ to_quaternion(item), vector_3d<T>{ item[{ 3, 0 }], item[{ 3, 1 }], item[{ 3, 2 }] } };
+    }
+};
+
+static constexpr inline auto to_rigid_transform = to_rigid_transform_fn{};
+
+}  // namespace core
+}  // namespace ferrugo
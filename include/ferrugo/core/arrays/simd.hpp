@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ferrugo
+{
+namespace core
+{
+
+namespace detail
+{
+
+// Load / store / broadcast and the few operations the compiler's vector operators (+ - * /) do not cover, for the
+// widest register available for T. The primary template is the one-lane fallback used for tails and other types.
+// The width follows the target flags (see FERRUGO_SIMD in the top-level CMakeLists.txt); the default build is SSE2.
+template <class T>
+struct simd_scalar
+{
+    using type = T;
+    static constexpr std::size_t width = 1;
+
+    static type load(const T* ptr)
+    {
+        return *ptr;
+    }
+
+    static void store(T* ptr, type v)
+    {
+        *ptr = v;
+    }
+
+    static type broadcast(T v)
+    {
+        return v;
+    }
+
+    static type sqrt(type v)
+    {
+        return std::sqrt(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return std::max(lhs, rhs);
+    }
+};
+
+template <class T>
+struct simd : simd_scalar<T>
+{
+};
+
+#if defined(__AVX512F__)
+
+template <>
+struct simd<float>
+{
+    using type = __m512;
+    static constexpr std::size_t width = 16;
+
+    static type load(const float* ptr)
+    {
+        return _mm512_loadu_ps(ptr);
+    }
+
+    static void store(float* ptr, type v)
+    {
+        _mm512_storeu_ps(ptr, v);
+    }
+
+    static type broadcast(float v)
+    {
+        return _mm512_set1_ps(v);
+    }
+
+    static type sqrt(type v)
+    {
+        return _mm512_sqrt_ps(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return _mm512_max_ps(lhs, rhs);
+    }
+};
+
+template <>
+struct simd<double>
+{
+    using type = __m512d;
+    static constexpr std::size_t width = 8;
+
+    static type load(const double* ptr)
+    {
+        return _mm512_loadu_pd(ptr);
+    }
+
+    static void store(double* ptr, type v)
+    {
+        _mm512_storeu_pd(ptr, v);
+    }
+
+    static type broadcast(double v)
+    {
+        return _mm512_set1_pd(v);
+    }
+
+    static type sqrt(type v)
+    {
+        return _mm512_sqrt_pd(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return _mm512_max_pd(lhs, rhs);
+    }
+};
+
+#elif defined(__AVX__)
+
+template <>
+struct simd<float>
+{
+    using type = __m256;
+    static constexpr std::size_t width = 8;
+
+    static type load(const float* ptr)
+    {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(float* ptr, type v)
+    {
+        _mm256_storeu_ps(ptr, v);
+    }
+
+    static type broadcast(float v)
+    {
+        return _mm256_set1_ps(v);
+    }
+
+    static type sqrt(type v)
+    {
+        return _mm256_sqrt_ps(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return _mm256_max_ps(lhs, rhs);
+    }
+};
+
+template <>
+struct simd<double>
+{
+    using type = __m256d;
+    static constexpr std::size_t width = 4;
+
+    static type load(const double* ptr)
+    {
+        return _mm256_loadu_pd(ptr);
+    }
+
+    static void store(double* ptr, type v)
+    {
+        _mm256_storeu_pd(ptr, v);
+    }
+
+    static type broadcast(double v)
+    {
+        return _mm256_set1_pd(v);
+    }
+
+    static type sqrt(type v)
+    {
+        return _mm256_sqrt_pd(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return _mm256_max_pd(lhs, rhs);
+    }
+};
+
+#elif defined(__SSE2__)
+
+template <>
+struct simd<float>
+{
+    using type = __m128;
+    static constexpr std::size_t width = 4;
+
+    static type load(const float* ptr)
+    {
+        return _mm_loadu_ps(ptr);
+    }
+
+    static void store(float* ptr, type v)
+    {
+        _mm_storeu_ps(ptr, v);
+    }
+
+    static type broadcast(float v)
+    {
+        return _mm_set1_ps(v);
+    }
+
+    static type sqrt(type v)
+    {
+        return _mm_sqrt_ps(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return _mm_max_ps(lhs, rhs);
+    }
+};
+
+template <>
+struct simd<double>
+{
+    using type = __m128d;
+    static constexpr std::size_t width = 2;
+
+    static type load(const double* ptr)
+    {
+        return _mm_loadu_pd(ptr);
+    }
+
+    static void store(double* ptr, type v)
+    {
+        _mm_storeu_pd(ptr, v);
+    }
+
+    static type broadcast(double v)
+    {
+        return _mm_set1_pd(v);
+    }
+
+    static type sqrt(type v)
+    {
+        return _mm_sqrt_pd(v);
+    }
+
+    static type max(type lhs, type rhs)
+    {
+        return _mm_max_pd(lhs, rhs);
+    }
+};
+
+#endif
+
+// Calls kernel(simd<T>{}, i) for every full register of lanes, then kernel(simd_scalar<T>{}, i) for the tail.
+template <class T, class Kernel>
+void simd_for_each(std::size_t count, Kernel&& kernel)
+{
+    std::size_t i = 0;
+    for (; i + simd<T>::width <= count; i += simd<T>::width)
+    {
+        kernel(simd<T>{}, i);
+    }
+    for (; i < count; ++i)
+    {
+        kernel(simd_scalar<T>{}, i);
+    }
+}
+
+}  // namespace detail
+}  // namespace core
+}  // namespace ferrugo
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <ferrugo/core/arrays/aligned_allocator.hpp>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace ferrugo
+{
+namespace core
+{
+
+template <std::size_t... V>
+struct size;
+
+template <class T, class Size>
+struct matrix;
+
+// D-dimensional vectors stored component-wise: m_data[d][i] is component d of vector i. Every component array is
+// 64-byte aligned, so batch kernels can process a full register of vectors per instruction.
+template <class T, std::size_t D>
+struct soa_vectors
+{
+    static_assert(std::is_floating_point_v<T>, "soa_vectors: floating point components expected");
+
+    using value_type = matrix<T, core::size<1, D>>;
+    using component_type = std::vector<T, aligned_allocator<T>>;
+
+    static constexpr std::size_t dim_count = D;
+
+    soa_vectors() = default;
+
+    explicit soa_vectors(std::size_t count)
+    {
+        resize(count);
+    }
+
+    template <class Iter>
+    soa_vectors(Iter first, Iter last)
+    {
+        assign(first, last);
+    }
+
+    soa_vectors(std::initializer_list<value_type> init) : soa_vectors(std::begin(init), std::end(init))
+    {
+    }
+
+    std::size_t size() const
+    {
+        return m_data[0].size();
+    }
+
+    bool empty() const
+    {
+        return m_data[0].empty();
+    }
+
+    void resize(std::size_t count)
+    {
+        for (auto& component : m_data)
+        {
+            component.resize(count);
+        }
+    }
+
+    void reserve(std::size_t count)
+    {
+        for (auto& component : m_data)
+        {
+            component.reserve(count);
+        }
+    }
+
+    void clear()
+    {
+        for (auto& component : m_data)
+        {
+            component.clear();
+        }
+    }
+
+    const T* component(std::size_t d) const
+    {
+        return m_data[d].data();
+    }
+
+    T* component(std::size_t d)
+    {
+        return m_data[d].data();
+    }
+
+    value_type operator[](std::size_t n) const
+    {
+        value_type result{};
+        for (std::size_t d = 0; d < D; ++d)
+        {
+            result[d] = m_data[d][n];
+        }
+        return result;
+    }
+
+    value_type at(std::size_t n) const
+    {
+        if (n >= size())
+        {
+            throw std::out_of_range{ "soa_vectors: index out of range" };
+        }
+        return (*this)[n];
+    }
+
+    void set(std::size_t n, const value_type& item)
+    {
+        for (std::size_t d = 0; d < D; ++d)
+        {
+            m_data[d][n] = item[d];
+        }
+    }
+
+    void push_back(const value_type& item)
+    {
+        for (std::size_t d = 0; d < D; ++d)
+        {
+            m_data[d].push_back(item[d]);
+        }
+    }
+
+    // AoS -> SoA
+    template <class Iter>
+    void assign(Iter first, Iter last)
+    {
+        resize(static_cast<std::size_t>(std::distance(first, last)));
+        for (std::size_t n = 0; first != last; ++first, ++n)
+        {
+            set(n, *first);
+        }
+    }
+
+    // SoA -> AoS
+    template <class Out>
+    Out copy_to(Out out) const
+    {
+        for (std::size_t n = 0; n < size(); ++n, ++out)
+        {
+            *out = (*this)[n];
+        }
+        return out;
+    }
+
+    std::array<component_type, D> m_data;
+};
+
+}  // namespace core
+}  // namespace ferrugo
@@ -3,13 +3,18 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <ferrugo/core/format/scan.hpp>
 #include <ferrugo/core/overloaded.hpp>
 #include <ferrugo/core/type_traits.hpp>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -268,30 +273,29 @@ private:
 
     static auto parse(std::string_view fmt) -> std::vector<print_action>
     {
-        static const auto is_opening_bracket = [](char c) { return c == '{'; };
-        static const auto is_closing_bracket = [](char c) { return c == '}'; };
-        static const auto is_bracket = [](char c) { return is_opening_bracket(c) || is_closing_bracket(c); };
-        static const auto is_colon = [](char c) { return c == ':'; };
+        using brackets = char_set<'{', '}'>;
+        using closing_bracket_set = char_set<'}'>;
+        using colon_set = char_set<':'>;
         std::vector<print_action> result;
         int arg_index = 0;
         while (!fmt.empty())
         {
-            const auto begin = std::begin(fmt);
-            const auto end = std::end(fmt);
-            const auto bracket = std::find_if(begin, end, is_bracket);
+            const char* begin = fmt.data();
+            const char* end = begin + fmt.size();
+            const char* bracket = find_first_of<brackets>(begin, end);
             if (bracket == end)
             {
                 result.push_back(print_text{ fmt });
                 fmt = make_string_view(bracket, end);
             }
-            else if (bracket[0] == bracket[1])
+            else if (bracket + 1 != end && bracket[0] == bracket[1])
             {
                 result.push_back(print_text{ make_string_view(begin, bracket + 1) });
                 fmt = make_string_view(bracket + 2, end);
             }
-            else if (is_opening_bracket(bracket[0]))
+            else if (bracket[0] == '{')
             {
-                const auto closing_bracket = std::find_if(bracket + 1, end, is_closing_bracket);
+                const char* closing_bracket = find_first_of<closing_bracket_set>(bracket + 1, end);
                 if (closing_bracket == end)
                 {
                     throw format_error{ "unclosed bracket" };
@@ -301,9 +305,10 @@ private:
                 const auto [actual_index, fmt_specifer] = std::invoke(
                     [](std::string_view arg, int current_index) -> std::tuple<int, std::string_view>
                     {
-                        const auto colon = std::find_if(std::begin(arg), std::end(arg), is_colon);
-                        const auto index_part = make_string_view(std::begin(arg), colon);
-                        const auto fmt_part = make_string_view(colon != std::end(arg) ? colon + 1 : colon, std::end(arg));
+                        const char* arg_end = arg.data() + arg.size();
+                        const char* colon = find_first_of<colon_set>(arg.data(), arg_end);
+                        const auto index_part = make_string_view(arg.data(), colon);
+                        const auto fmt_part = make_string_view(colon != arg_end ? colon + 1 : colon, arg_end);
                         const auto index = !index_part.empty() ? parse_int(index_part) : current_index;
                         return { index, fmt_part };
                     },
@@ -313,14 +318,18 @@ private:
                 fmt = make_string_view(closing_bracket + 1, end);
                 ++arg_index;
             }
+            else
+            {
+                throw format_error{ "unmatched closing bracket" };
+            }
         }
         return result;
     }
 
-    static auto make_string_view(std::string_view::iterator b, std::string_view::iterator e) -> std::string_view
+    static auto make_string_view(const char* b, const char* e) -> std::string_view
     {
         if (b < e)
-            return { std::addressof(*b), std::string_view::size_type(e - b) };
+            return { b, std::string_view::size_type(e - b) };
         else
             return {};
     }
@@ -337,20 +346,116 @@ private:
     }
 };
 
+// Parsed format strings of const char arrays, one table per thread, keyed by the array's address and size. A hit also
+// compares the text, since another array may later occupy the same address; a mismatch is not cached. Entries are
+// never evicted, so borrowed parses stay valid for the thread's lifetime, and the table stops growing at max_size.
+class format_string_cache
+{
+private:
+    struct entry
+    {
+        std::string text;
+        format_string parsed;
+
+        explicit entry(std::string_view fmt) : text{ fmt }, parsed{ text }
+        {
+        }
+
+        entry(const entry&) = delete;
+        entry& operator=(const entry&) = delete;
+    };
+
+    using key_type = std::pair<const char*, std::size_t>;
+
+    struct key_hash
+    {
+        std::size_t operator()(const key_type& key) const
+        {
+            return std::hash<const char*>{}(key.first) ^ (key.second * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    // Node-based, so entries do not move as the table grows.
+    using map_type = std::unordered_map<key_type, entry, key_hash>;
+
+    static auto entries() -> map_type&
+    {
+        static thread_local map_type result;
+        return result;
+    }
+
+public:
+    static constexpr std::size_t max_size = 256;
+
+    // Returns nullptr when fmt cannot be served from the table.
+    static auto get(std::string_view fmt) -> const format_string*
+    {
+        auto& table = entries();
+        const auto key = key_type{ fmt.data(), fmt.size() };
+        if (const auto it = table.find(key); it != table.end())
+        {
+            return it->second.text == fmt ? &it->second.parsed : nullptr;
+        }
+        if (table.size() >= max_size)
+        {
+            return nullptr;
+        }
+        return &table.try_emplace(key, fmt).first->second.parsed;
+    }
+
+    static auto size() -> std::size_t
+    {
+        return entries().size();
+    }
+};
+
+// A format string parsed for a single call, or borrowed from the calling thread's format_string_cache.
+class format_string_handle
+{
+public:
+    explicit format_string_handle(std::string_view fmt) : m_owned{ std::in_place, fmt }, m_cached{ nullptr }
+    {
+    }
+
+    explicit format_string_handle(const format_string& cached) : m_owned{}, m_cached{ &cached }
+    {
+    }
+
+    static auto cached(std::string_view fmt) -> format_string_handle
+    {
+        const format_string* entry = format_string_cache::get(fmt);
+        return entry ? format_string_handle{ *entry } : format_string_handle{ fmt };
+    }
+
+    const format_string& operator*() const
+    {
+        return m_cached ? *m_cached : *m_owned;
+    }
+
+    const format_string* operator->() const
+    {
+        return &**this;
+    }
+
+private:
+    std::optional<format_string> m_owned;
+    const format_string* m_cached;
+};
+
 template <bool NewLine = false>
 struct print_to_fn
 {
     struct impl
     {
         std::ostream& m_os;
-        format_string m_formatter;
+        format_string_handle m_formatter;
 
         template <class... Args>
         void operator()(Args&&... args) const
         {
             buffer buf{};
             format_context format_ctx{ buf };
-            m_formatter.format(format_ctx, wrap_args(std::forward<Args>(args)...));
+            m_formatter->format(format_ctx, wrap_args(std::forward<Args>(args)...));
             if constexpr (NewLine)
             {
                 write_to(format_ctx, '\n');
@@ -361,18 +466,43 @@ struct print_to_fn
 
         friend std::ostream& operator<<(std::ostream& os, const impl& item)
         {
-            return os << item.m_formatter;
+            return os << *item.m_formatter;
         }
     };
 
     auto operator()(std::ostream& os, std::string_view fmt) const -> impl
     {
-        return impl{ os, format_string{ fmt } };
+        return impl{ os, format_string_handle{ fmt } };
     }
 
     auto operator()(std::string_view fmt) const -> impl
     {
-        return impl{ std::cout, format_string{ fmt } };
+        return impl{ std::cout, format_string_handle{ fmt } };
+    }
+
+    template <std::size_t N>
+    auto operator()(std::ostream& os, const char (&fmt)[N]) const -> impl
+    {
+        return impl{ os, format_string_handle::cached(fmt) };
+    }
+
+    template <std::size_t N>
+    auto operator()(const char (&fmt)[N]) const -> impl
+    {
+        return impl{ std::cout, format_string_handle::cached(fmt) };
+    }
+
+    // Mutable buffers may change between calls and are parsed every time.
+    template <std::size_t N>
+    auto operator()(std::ostream& os, char (&fmt)[N]) const -> impl
+    {
+        return (*this)(os, std::string_view{ fmt });
+    }
+
+    template <std::size_t N>
+    auto operator()(char (&fmt)[N]) const -> impl
+    {
+        return (*this)(std::string_view{ fmt });
     }
 };
 
@@ -380,23 +510,36 @@ struct format_fn
 {
     struct impl
     {
-        format_string m_formatter;
+        format_string_handle m_formatter;
 
         template <class... Args>
         auto operator()(Args&&... args) const -> std::string
         {
-            return m_formatter.format(wrap_args(std::forward<Args>(args)...));
+            return m_formatter->format(wrap_args(std::forward<Args>(args)...));
         }
 
         friend std::ostream& operator<<(std::ostream& os, const impl& item)
         {
-            return os << item.m_formatter;
+            return os << *item.m_formatter;
         }
     };
 
     auto operator()(std::string_view fmt) const -> impl
     {
-        return impl{ format_string{ fmt } };
+        return impl{ format_string_handle{ fmt } };
+    }
+
+    template <std::size_t N>
+    auto operator()(const char (&fmt)[N]) const -> impl
+    {
+        return impl{ format_string_handle::cached(fmt) };
+    }
+
+    // Mutable buffers may change between calls and are parsed every time.
+    template <std::size_t N>
+    auto operator()(char (&fmt)[N]) const -> impl
+    {
+        return (*this)(std::string_view{ fmt });
     }
 };
 
@@ -511,42 +654,120 @@ struct formatter<long double> : sprintf_formatter<'L','f'>
 {
 };
 
-template <>
-struct formatter<std::string>
+struct string_formatter
 {
-    void parse(const parse_context&)
+    enum class escape_mode
     {
+        none,
+        json,
+        csv
+    };
+
+    escape_mode m_escape = escape_mode::none;
+
+    void parse(const parse_context& ctx)
+    {
+        const auto specifier = ctx.specifier();
+        if (specifier == "json")
+        {
+            m_escape = escape_mode::json;
+        }
+        else if (specifier == "csv")
+        {
+            m_escape = escape_mode::csv;
+        }
     }
 
-    void format(format_context& ctx, const std::string& item) const
+    void format(format_context& ctx, std::string_view item) const
     {
-        ctx.output().append(item.data(), item.size());
+        switch (m_escape)
+        {
+            case escape_mode::none: ctx.output().append(item.data(), item.size()); break;
+            case escape_mode::json: write_json(ctx.output(), item); break;
+            case escape_mode::csv: write_csv(ctx.output(), item); break;
+        }
     }
-};
 
-template <>
-struct formatter<std::string_view>
-{
-    void parse(const parse_context&)
+    // Escapes the contents of a JSON string; the surrounding quotes are left to the format string.
+    static void write_json(buffer& out, std::string_view item)
     {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+        const char* b = item.data();
+        const char* e = b + item.size();
+        out.ensure_capacity(out.size() + item.size());
+        while (b != e)
+        {
+            const char* special = detail::find_first_of<detail::control_char_set<'"', '\\'>>(b, e);
+            out.append(b, special);
+            if (special == e)
+            {
+                break;
+            }
+            switch (*special)
+            {
+                case '"': out.append("\\\"", 2); break;
+                case '\\': out.append("\\\\", 2); break;
+                case '\b': out.append("\\b", 2); break;
+                case '\f': out.append("\\f", 2); break;
+                case '\n': out.append("\\n", 2); break;
+                case '\r': out.append("\\r", 2); break;
+                case '\t': out.append("\\t", 2); break;
+                default:
+                {
+                    const auto c = static_cast<unsigned char>(*special);
+                    const char escaped[] = { '\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xF] };
+                    out.append(escaped, sizeof(escaped));
+                }
+            }
+            b = special + 1;
+        }
     }
 
-    void format(format_context& ctx, std::string_view item) const
+    // Writes a CSV field, quoting it (and doubling embedded quotes) only when it contains a delimiter, quote or line break.
+    static void write_csv(buffer& out, std::string_view item)
     {
-        ctx.output().append(item.data(), item.size());
+        using special_chars = detail::char_set<',', '"', '\r', '\n'>;
+        using quote = detail::char_set<'"'>;
+        const char* b = item.data();
+        const char* e = b + item.size();
+        if (detail::find_first_of<special_chars>(b, e) == e)
+        {
+            out.append(b, e);
+            return;
+        }
+        out.ensure_capacity(out.size() + item.size() + 2);
+        out.append("\"", 1);
+        while (b != e)
+        {
+            const char* q = detail::find_first_of<quote>(b, e);
+            out.append(b, q);
+            if (q == e)
+            {
+                break;
+            }
+            out.append("\"\"", 2);
+            b = q + 1;
+        }
+        out.append("\"", 1);
     }
 };
 
 template <>
-struct formatter<const char*>
+struct formatter<std::string> : string_formatter
 {
-    void parse(const parse_context&)
-    {
-    }
+};
 
+template <>
+struct formatter<std::string_view> : string_formatter
+{
+};
+
+template <>
+struct formatter<const char*> : string_formatter
+{
     void format(format_context& ctx, const char* item) const
     {
-        ctx.output().append(item, std::strlen(item));
+        string_formatter::format(ctx, std::string_view{ item });
     }
 };
 
@@ -564,15 +785,11 @@ struct formatter<char>
 };
 
 template <std::size_t N>
-struct formatter<char[N]>
+struct formatter<char[N]> : string_formatter
 {
-    void parse(const parse_context&)
-    {
-    }
-
     void format(format_context& ctx, const char (&item)[N]) const
     {
-        ctx.output().append(item, N - 1);
+        string_formatter::format(ctx, std::string_view{ item, N - 1 });
     }
 };
 
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ferrugo
+{
+namespace core
+{
+
+namespace detail
+{
+
+template <char... Chars>
+struct char_set
+{
+    static constexpr bool match(char c)
+    {
+        return ((c == Chars) || ...);
+    }
+
+#if defined(__SSE2__)
+    static __m128i match(__m128i v)
+    {
+        return (_mm_cmpeq_epi8(v, _mm_set1_epi8(Chars)) | ...);
+    }
+#endif
+
+#if defined(__AVX2__)
+    static __m256i match(__m256i v)
+    {
+        return (_mm256_cmpeq_epi8(v, _mm256_set1_epi8(Chars)) | ...);
+    }
+#endif
+};
+
+// Control characters (below 0x20) and the characters listed explicitly.
+template <char... Chars>
+struct control_char_set
+{
+    static constexpr bool match(char c)
+    {
+        return static_cast<unsigned char>(c) < 0x20 || char_set<Chars...>::match(c);
+    }
+
+#if defined(__SSE2__)
+    static __m128i match(__m128i v)
+    {
+        const auto limit = _mm_set1_epi8(0x1F);
+        return _mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit) | char_set<Chars...>::match(v);
+    }
+#endif
+
+#if defined(__AVX2__)
+    static __m256i match(__m256i v)
+    {
+        const auto limit = _mm256_set1_epi8(0x1F);
+        return _mm256_cmpeq_epi8(_mm256_max_epu8(v, limit), limit) | char_set<Chars...>::match(v);
+    }
+#endif
+};
+
+template <class Set>
+const char* find_first_of(const char* b, const char* e)
+{
+#if defined(__AVX2__)
+    for (; e - b >= 32; b += 32)
+    {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(Set::match(v)));
+        if (mask != 0)
+        {
+            return b + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; e - b >= 16; b += 16)
+    {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(Set::match(v)));
+        if (mask != 0)
+        {
+            return b + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; b != e; ++b)
+    {
+        if (Set::match(*b))
+        {
+            return b;
+        }
+    }
+    return e;
+}
+
+}  // namespace detail
+}  // namespace core
+}  // namespace ferrugo
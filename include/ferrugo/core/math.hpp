@@ -1,29 +1,147 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <ferrugo/core/math/batch.hpp>
 #include <ferrugo/core/quantities.hpp>
+#include <ferrugo/core/type_traits.hpp>
+#include <limits>
+#include <span>
+#include <type_traits>
 
 namespace ferrugo
 {
 namespace math
 {
 
+namespace detail
+{
+
+// Newton's iteration started above the root decreases monotonically, so it stops as soon as a step fails to shrink.
+template <class T>
+constexpr T constexpr_sqrt(T v)
+{
+    if (!(v >= T{}) || v == T{} || v == std::numeric_limits<T>::infinity())
+    {
+        return v >= T{} ? v : std::numeric_limits<T>::quiet_NaN();
+    }
+    T x = v > T{ 1 } ? v : T{ 1 };
+    while (true)
+    {
+        const T next = (x + v / x) / 2;
+        if (!(next < x))
+        {
+            return x;
+        }
+        x = next;
+    }
+}
+
+// Batch overloads take spans of floating point values, optionally wrapped in quants::value_t.
+template <class T>
+struct batch_element
+{
+    using value_type = T;
+    using quantity_type = quants::quantities::scalar;
+};
+
+template <class T, class Q>
+struct batch_element<quants::value_t<T, Q>>
+{
+    using value_type = T;
+    using quantity_type = Q;
+};
+
+template <class T>
+using batch_value_t = typename batch_element<std::remove_const_t<T>>::value_type;
+
+template <class T>
+using batch_quantity_t = typename batch_element<std::remove_const_t<T>>::quantity_type;
+
+template <class In, class Out>
+static constexpr bool is_batch_pair = std::is_floating_point_v<batch_value_t<In>>
+                                      && std::is_same_v<batch_value_t<In>, batch_value_t<Out>> && !std::is_const_v<Out>;
+
+template <class T, class... Q>
+static constexpr bool has_quantity = (std::is_same_v<batch_quantity_t<T>, Q> || ...);
+
+template <class T, std::size_t E>
+auto batch_input(std::span<T, E> in) -> std::span<const batch_value_t<T>>
+{
+    static_assert(sizeof(T) == sizeof(batch_value_t<T>), "math: wrapped value expected to have no overhead");
+    return { reinterpret_cast<const batch_value_t<T>*>(in.data()), in.size() };
+}
+
+template <class T, std::size_t E>
+auto batch_output(std::span<T, E> out, std::size_t count) -> batch_value_t<T>*
+{
+    static_assert(sizeof(T) == sizeof(batch_value_t<T>), "math: wrapped value expected to have no overhead");
+    if (out.size() < count)
+    {
+        throw std::invalid_argument{ "math: output span is shorter than the input" };
+    }
+    return reinterpret_cast<batch_value_t<T>*>(out.data());
+}
+
+template <class In, class Out>
+static constexpr bool is_trig_batch
+    = is_batch_pair<In, Out> && has_quantity<In, quants::quantities::angle, quants::quantities::scalar>
+      && has_quantity<Out, quants::quantities::scalar>;
+
+template <class In, class Out>
+static constexpr bool is_arcsin_batch
+    = is_batch_pair<In, Out> && has_quantity<In, quants::quantities::scalar>
+      && has_quantity<Out, quants::quantities::angle, quants::quantities::scalar>;
+
+template <class In, class Out>
+static constexpr bool is_same_quantity_batch = is_batch_pair<In, Out> && has_quantity<Out, batch_quantity_t<In>>;
+
+template <class In, class Out, class Func>
+auto batch_transform(std::span<In> in, std::span<Out> out, Func func) -> std::span<Out>
+{
+    const auto input = batch_input(in);
+    auto* output = batch_output(out, in.size());
+    std::transform(input.begin(), input.end(), output, func);
+    return out.first(in.size());
+}
+
+}  // namespace detail
+
 struct sqrt_fn
 {
     template <class T>
     using result_type = decltype(::sqrt(std::declval<T>()));
 
     template <class T>
-    auto operator()(T v) const -> result_type<T>
+    constexpr auto operator()(T v) const -> result_type<T>
     {
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            if (std::is_constant_evaluated())
+            {
+                return detail::constexpr_sqrt(static_cast<result_type<T>>(v));
+            }
+        }
         return sqrt(v);
     }
 
     template <class T, class Q>
-    auto operator()(quants::value_t<T, Q> v) const -> quants::value_t<result_type<T>, quants::sqr_root_result_t<Q>>
+    constexpr auto operator()(quants::value_t<T, Q> v) const -> quants::value_t<result_type<T>, quants::sqr_root_result_t<Q>>
     {
         return quants::value_t<result_type<T>, quants::sqr_root_result_t<Q>>{ (*this)(v.get()) };
     }
+
+    template <
+        class In,
+        class Out,
+        core::require<
+            detail::is_batch_pair<In, Out>
+            && detail::has_quantity<Out, quants::sqr_root_result_t<detail::batch_quantity_t<In>>>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out) const -> std::span<Out>
+    {
+        detail::sqrt_batch(detail::batch_input(in), detail::batch_output(out, in.size()));
+        return out.first(in.size());
+    }
 };
 
 static constexpr inline auto sqrt = sqrt_fn{};
@@ -41,6 +159,12 @@ struct abs_fn
     {
         return quants::value_t<T, Q>{ (*this)(v.get()) };
     }
+
+    template <class In, class Out, core::require<detail::is_same_quantity_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out) const -> std::span<Out>
+    {
+        return detail::batch_transform(in, out, [](auto v) { return std::abs(v); });
+    }
 };
 
 static constexpr inline auto abs = abs_fn{};
@@ -52,6 +176,19 @@ struct sin_fn
     {
         return sin(v);
     }
+
+    template <class T>
+    auto operator()(quants::value_t<T, quants::quantities::angle> v) const -> T
+    {
+        return (*this)(v.get());
+    }
+
+    template <class In, class Out, core::require<detail::is_trig_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out, accuracy acc = accuracy::ulp4) const -> std::span<Out>
+    {
+        detail::trig_batch<detail::trig_function::sin>(detail::batch_input(in), detail::batch_output(out, in.size()), acc);
+        return out.first(in.size());
+    }
 };
 
 static constexpr inline auto sin = sin_fn{};
@@ -63,6 +200,19 @@ struct cos_fn
     {
         return cos(v);
     }
+
+    template <class T>
+    auto operator()(quants::value_t<T, quants::quantities::angle> v) const -> T
+    {
+        return (*this)(v.get());
+    }
+
+    template <class In, class Out, core::require<detail::is_trig_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out, accuracy acc = accuracy::ulp4) const -> std::span<Out>
+    {
+        detail::trig_batch<detail::trig_function::cos>(detail::batch_input(in), detail::batch_output(out, in.size()), acc);
+        return out.first(in.size());
+    }
 };
 
 static constexpr inline auto cos = cos_fn{};
@@ -74,6 +224,19 @@ struct tan_fn
     {
         return tan(v);
     }
+
+    template <class T>
+    auto operator()(quants::value_t<T, quants::quantities::angle> v) const -> T
+    {
+        return (*this)(v.get());
+    }
+
+    template <class In, class Out, core::require<detail::is_trig_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out, accuracy acc = accuracy::ulp4) const -> std::span<Out>
+    {
+        detail::trig_batch<detail::trig_function::tan>(detail::batch_input(in), detail::batch_output(out, in.size()), acc);
+        return out.first(in.size());
+    }
 };
 
 static constexpr inline auto tan = tan_fn{};
@@ -83,7 +246,20 @@ struct cot_fn
     template <class T>
     auto operator()(T v) const -> T
     {
-        return cot(v);
+        return T{ 1 } / tan(v);
+    }
+
+    template <class T>
+    auto operator()(quants::value_t<T, quants::quantities::angle> v) const -> T
+    {
+        return (*this)(v.get());
+    }
+
+    template <class In, class Out, core::require<detail::is_trig_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out, accuracy acc = accuracy::ulp4) const -> std::span<Out>
+    {
+        detail::trig_batch<detail::trig_function::cot>(detail::batch_input(in), detail::batch_output(out, in.size()), acc);
+        return out.first(in.size());
     }
 };
 
@@ -96,6 +272,13 @@ struct asin_fn
     {
         return asin(v);
     }
+
+    template <class In, class Out, core::require<detail::is_arcsin_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out, accuracy acc = accuracy::ulp4) const -> std::span<Out>
+    {
+        detail::arcsin_batch<false>(detail::batch_input(in), detail::batch_output(out, in.size()), acc);
+        return out.first(in.size());
+    }
 };
 
 static constexpr inline auto asin = asin_fn{};
@@ -107,6 +290,13 @@ struct acos_fn
     {
         return acos(v);
     }
+
+    template <class In, class Out, core::require<detail::is_arcsin_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out, accuracy acc = accuracy::ulp4) const -> std::span<Out>
+    {
+        detail::arcsin_batch<true>(detail::batch_input(in), detail::batch_output(out, in.size()), acc);
+        return out.first(in.size());
+    }
 };
 
 static constexpr inline auto acos = acos_fn{};
@@ -124,6 +314,12 @@ struct floor_fn
     {
         return quants::value_t<T, Q>{ (*this)(v.get()) };
     }
+
+    template <class In, class Out, core::require<detail::is_same_quantity_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out) const -> std::span<Out>
+    {
+        return detail::batch_transform(in, out, [](auto v) { return std::floor(v); });
+    }
 };
 
 static constexpr inline auto floor = floor_fn{};
@@ -141,6 +337,12 @@ struct ceil_fn
     {
         return quants::value_t<T, Q>{ (*this)(v.get()) };
     }
+
+    template <class In, class Out, core::require<detail::is_same_quantity_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out) const -> std::span<Out>
+    {
+        return detail::batch_transform(in, out, [](auto v) { return std::ceil(v); });
+    }
 };
 
 static constexpr inline auto ceil = ceil_fn{};
@@ -158,6 +360,12 @@ struct round_fn
     {
         return quants::value_t<T, Q>{ (*this)(v.get()) };
     }
+
+    template <class In, class Out, core::require<detail::is_same_quantity_batch<In, Out>> = 0>
+    auto operator()(std::span<In> in, std::span<Out> out) const -> std::span<Out>
+    {
+        return detail::batch_transform(in, out, [](auto v) { return std::round(v); });
+    }
 };
 
 static constexpr inline auto round = round_fn{};
@@ -0,0 +1,419 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ferrugo/core/arrays/simd.hpp>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace ferrugo
+{
+namespace math
+{
+
+// Accuracy of the batch (span) overloads of the math function objects against the correctly rounded result. fast trades
+// it for shorter polynomials (absolute error below 1e-5). For double input ulp1 calls libm per element and fast behaves
+// like ulp4.
+enum class accuracy
+{
+    ulp1,
+    ulp4,
+    fast
+};
+
+namespace detail
+{
+
+// Kernels work on the compiler's generic vector types, sized to the widest register core::detail::simd uses.
+static constexpr std::size_t batch_bytes
+    = core::detail::simd<float>::width > 1 ? core::detail::simd<float>::width * sizeof(float) : 16;
+
+template <class T, std::size_t N>
+struct vector_of
+{
+    typedef T type __attribute__((vector_size(N * sizeof(T))));
+};
+
+template <class T, std::size_t N = batch_bytes / sizeof(T)>
+using vec = typename vector_of<T, N>::type;
+
+template <class V>
+using lane_t = std::decay_t<decltype(std::declval<V>()[0])>;
+
+template <class V>
+static constexpr std::size_t lane_count = sizeof(V) / sizeof(lane_t<V>);
+
+template <class V>
+using int_vec = vec<std::conditional_t<sizeof(lane_t<V>) == 4, std::int32_t, std::int64_t>, lane_count<V>>;
+
+template <class V>
+V broadcast(lane_t<V> v)
+{
+    return V{} + v;
+}
+
+template <class V, class T>
+V load(const T* ptr)
+{
+    if constexpr (std::is_same_v<lane_t<V>, T>)
+    {
+        V result;
+        std::memcpy(&result, ptr, sizeof(V));
+        return result;
+    }
+    else
+    {
+        vec<T, lane_count<V>> narrow;
+        std::memcpy(&narrow, ptr, sizeof(narrow));
+        return __builtin_convertvector(narrow, V);
+    }
+}
+
+template <class V, class T>
+void store(T* ptr, V v)
+{
+    if constexpr (std::is_same_v<lane_t<V>, T>)
+    {
+        std::memcpy(ptr, &v, sizeof(V));
+    }
+    else
+    {
+        const auto narrow = __builtin_convertvector(v, vec<T, lane_count<V>>);
+        std::memcpy(ptr, &narrow, sizeof(narrow));
+    }
+}
+
+template <class V>
+V vsqrt(V v)
+{
+    using simd = core::detail::simd<lane_t<V>>;
+    if constexpr (simd::width == lane_count<V>)
+    {
+        return reinterpret_cast<V>(simd::sqrt(reinterpret_cast<typename simd::type>(v)));
+    }
+    else
+    {
+        for (std::size_t i = 0; i < lane_count<V>; ++i)
+        {
+            v[i] = std::sqrt(v[i]);
+        }
+        return v;
+    }
+}
+
+template <class V>
+V vabs(V v)
+{
+    return v < V{} ? -v : v;
+}
+
+// Horner evaluation of c[0] + c[1] * z + ... + c[N - 1] * z^(N - 1).
+template <class V, class T, std::size_t N>
+V polynomial(V z, const T (&c)[N])
+{
+    V result = broadcast<V>(c[N - 1]);
+    for (std::size_t i = N - 1; i-- > 0;)
+    {
+        result = result * z + c[i];
+    }
+    return result;
+}
+
+template <class T, accuracy A>
+struct trig_constants;
+
+// Coefficients of sin(r) = r + r^3 * S(r^2) and cos(r) = 1 - r^2 / 2 + r^4 * C(r^2) on [-pi/4, pi/4]. pi/2 is split so
+// that k * pi_2[i] is exact for all but the last part while |k| < `limit * 2 / pi`; larger arguments go to libm. With
+// `compensated` the reduced argument is carried as a sum of two values, which double precision needs near multiples of
+// pi/2.
+template <>
+struct trig_constants<float, accuracy::ulp4>
+{
+    static constexpr float sin[] = { -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f };
+    static constexpr float cos[] = { 4.166664568298827e-2f, -1.388731625493765e-3f, 2.443315711809948e-5f };
+    static constexpr float pi_2[]
+        = { 1.5703125f, 4.837512969970703125e-4f, 7.549533620476722717e-8f, 2.563344068257089603e-12f };
+    static constexpr float limit = 4096.0f;
+    static constexpr bool compensated = false;
+};
+
+template <>
+struct trig_constants<float, accuracy::fast>
+{
+    static constexpr float sin[] = { -1.66657310012783847e-1f, 8.21185550730821849e-3f };
+    static constexpr float cos[] = { 4.16654950801103321e-2f, -1.37368140617344086e-3f };
+    static constexpr float pi_2[]
+        = { 1.5703125f, 4.837512969970703125e-4f, 7.549533620476722717e-8f, 2.563344068257089603e-12f };
+    static constexpr float limit = 4096.0f;
+    static constexpr bool compensated = false;
+};
+
+// The double coefficients are those of fdlibm's __kernel_sin and __kernel_cos, the parts of pi/2 have at most 32 bits.
+template <>
+struct trig_constants<double, accuracy::ulp4>
+{
+    static constexpr double sin[] = { -1.66666666666666324348e-1, 8.33333333332248946124e-3, -1.98412698298579493134e-4,
+                                      2.75573137070700676789e-6,  -2.50507602534068634195e-8, 1.58969099521155010221e-10 };
+    static constexpr double cos[] = { 4.16666666666666019037e-2,  -1.38888888888741095749e-3, 2.48015872894767294178e-5,
+                                      -2.75573143513906633035e-7, 2.08757232129817482790e-9,  -1.13596475577881948265e-11 };
+    static constexpr double pi_2[] = { 1.57079632673412561417e+0, 6.07710050630396597660e-11, 2.02226624871116645580e-21,
+                                       8.47842766036889956997e-32 };
+    static constexpr double limit = 1048576.0;
+    static constexpr bool compensated = true;
+};
+
+// Coefficients of asin(x) = x + x^3 * P(x^2) on [0, 0.5].
+template <class T, accuracy A>
+struct asin_constants;
+
+template <>
+struct asin_constants<float, accuracy::ulp4>
+{
+    static constexpr float coefficients[]
+        = { 1.6666752422e-1f, 7.4953002686e-2f, 4.5470025998e-2f, 2.4181311049e-2f, 4.2163199048e-2f };
+};
+
+template <>
+struct asin_constants<float, accuracy::fast>
+{
+    static constexpr float coefficients[]
+        = { 1.66686721095483133e-1f, 7.35710923253227981e-2f, 5.89756389023805335e-2f };
+};
+
+// A polynomial short enough for double precision does not reach 4 ulp, so P is fdlibm's rational approximation
+// coefficients / denominator.
+template <>
+struct asin_constants<double, accuracy::ulp4>
+{
+    static constexpr double coefficients[] = { 1.66666666666666657415e-1,  -3.25565818622400915405e-1,
+                                               2.01212532134862925881e-1,  -4.00555345006794114027e-2,
+                                               7.91534994289814532176e-4,  3.47933107596021167570e-5 };
+    static constexpr double denominator[] = { 1.0, -2.40339491173441421878e+0, 2.02094576023350569471e+0,
+                                              -6.88283971605453293030e-1, 7.70381505559019352791e-2 };
+};
+
+enum class trig_function
+{
+    sin,
+    cos,
+    tan,
+    cot
+};
+
+template <trig_function F, accuracy A, class V>
+V trig(V x)
+{
+    using T = lane_t<V>;
+    using I = int_vec<V>;
+    using constants = trig_constants<T, A>;
+    constexpr T two_over_pi = T(0.636619772367581343076);
+    constexpr T round_magic = sizeof(T) == 4 ? T(12582912.0) : T(6755399441055744.0);
+
+    const V k = (x * two_over_pi + round_magic) - round_magic;
+
+    // r = x - k * pi/2, the parts subtracted one at a time. Near a multiple of pi/2 most of the bits of x cancel; the
+    // compensated kernels keep the rounding errors of the subtractions in `tail`.
+    constexpr std::size_t parts = std::size(constants::pi_2);
+    V r = x - k * constants::pi_2[0];
+    V tail = {};
+    for (std::size_t i = 1; i + 1 < parts; ++i)
+    {
+        const V product = k * constants::pi_2[i];
+        const V difference = r - product;
+        if constexpr (constants::compensated)
+        {
+            const V rounded = difference - r;
+            tail = tail + ((r - (difference - rounded)) - (product + rounded));
+        }
+        r = difference;
+    }
+    V s;
+    V c;
+    if constexpr (!constants::compensated)
+    {
+        r = r - k * constants::pi_2[parts - 1];
+        const V z = r * r;
+        s = r + r * z * polynomial(z, constants::sin);
+        c = T(1) - z * T(0.5) + z * z * polynomial(z, constants::cos);
+    }
+    else
+    {
+        tail = tail - k * constants::pi_2[parts - 1];
+        const V sum = r + tail;
+        tail = tail - (sum - r);
+        r = sum;
+
+        // sin(r + tail) ~ sin(r) + tail * cos(r) and cos(r + tail) ~ cos(r) - tail * r; the rounding error of
+        // 1 - r^2 / 2 is added back as in fdlibm's __kernel_cos.
+        const V z = r * r;
+        const V half_z = z * T(0.5);
+        const V w = T(1) - half_z;
+        s = r + (r * z * polynomial(z, constants::sin) + tail * (T(1) - half_z));
+        c = w + (((T(1) - w) - half_z) + (z * z * polynomial(z, constants::cos) - r * tail));
+    }
+
+    I quadrant = __builtin_convertvector(k, I);
+    if constexpr (F == trig_function::cos)
+    {
+        quadrant = quadrant + 1;
+    }
+    const I odd = (quadrant & 1) != 0;
+    V result;
+    if constexpr (F == trig_function::sin || F == trig_function::cos)
+    {
+        result = odd ? c : s;
+        result = (quadrant & 2) != 0 ? -result : result;
+    }
+    else if constexpr (F == trig_function::tan)
+    {
+        result = odd ? -c / s : s / c;
+    }
+    else
+    {
+        result = odd ? -s / c : c / s;
+    }
+
+    const auto outside = !(vabs(x) <= constants::limit);
+    for (std::size_t i = 0; i < lane_count<V>; ++i)
+    {
+        if (outside[i])
+        {
+            const T v = x[i];
+            result[i] = F == trig_function::sin   ? std::sin(v)
+                        : F == trig_function::cos ? std::cos(v)
+                        : F == trig_function::tan ? std::tan(v)
+                                                  : T(1) / std::tan(v);
+        }
+    }
+    return result;
+}
+
+template <bool Acos, accuracy A, class V>
+V arcsin(V x)
+{
+    using T = lane_t<V>;
+    constexpr T pi_2 = T(1.57079632679489661923);
+    constexpr T pi = T(3.14159265358979323846);
+
+    const V a = vabs(x);
+    const auto big = a > T(0.5);
+    const V z = big ? (T(1) - a) * T(0.5) : a * a;
+    const V s = big ? vsqrt(z) : a;
+    using constants = asin_constants<T, A>;
+    V q = polynomial(z, constants::coefficients);
+    if constexpr (requires { constants::denominator; })
+    {
+        q = q / polynomial(z, constants::denominator);
+    }
+    const V p = s + s * z * q;
+    const auto negative = x < T(0);
+
+    V result;
+    if constexpr (Acos)
+    {
+        const V small_result = pi_2 - (negative ? -p : p);
+        const V big_result = negative ? pi - (p + p) : p + p;
+        result = big ? big_result : small_result;
+    }
+    else
+    {
+        const V magnitude = big ? pi_2 - (p + p) : p;
+        result = negative ? -magnitude : magnitude;
+    }
+    return a > T(1) ? broadcast<V>(std::numeric_limits<T>::quiet_NaN()) : result;
+}
+
+// Runs `kernel` over full vectors of `in`, padding the tail, and writes the results to `out`.
+template <class V, class In, class Out, class Kernel>
+void batch_apply(const In* in, Out* out, std::size_t count, Kernel kernel)
+{
+    constexpr std::size_t width = lane_count<V>;
+    std::size_t i = 0;
+    for (; i + width <= count; i += width)
+    {
+        store(out + i, kernel(load<V>(in + i)));
+    }
+    if (i < count)
+    {
+        In in_tail[width] = {};
+        Out out_tail[width];
+        std::copy(in + i, in + count, in_tail);
+        store(out_tail, kernel(load<V>(in_tail)));
+        std::copy(out_tail, out_tail + (count - i), out + i);
+    }
+}
+
+template <trig_function F, class T>
+void trig_batch(std::span<const T> in, T* out, accuracy acc)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        switch (acc)
+        {
+            case accuracy::ulp1:
+                return batch_apply<vec<double>>(
+                    in.data(), out, in.size(), [](auto v) { return trig<F, accuracy::ulp4>(v); });
+            case accuracy::ulp4:
+                return batch_apply<vec<float>>(
+                    in.data(), out, in.size(), [](auto v) { return trig<F, accuracy::ulp4>(v); });
+            case accuracy::fast:
+                return batch_apply<vec<float>>(
+                    in.data(), out, in.size(), [](auto v) { return trig<F, accuracy::fast>(v); });
+        }
+    }
+    else if (acc != accuracy::ulp1)
+    {
+        return batch_apply<vec<T>>(in.data(), out, in.size(), [](auto v) { return trig<F, accuracy::ulp4>(v); });
+    }
+    for (std::size_t i = 0; i < in.size(); ++i)
+    {
+        const T v = in[i];
+        out[i] = F == trig_function::sin   ? std::sin(v)
+                 : F == trig_function::cos ? std::cos(v)
+                 : F == trig_function::tan ? std::tan(v)
+                                           : T(1) / std::tan(v);
+    }
+}
+
+template <bool Acos, class T>
+void arcsin_batch(std::span<const T> in, T* out, accuracy acc)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        switch (acc)
+        {
+            case accuracy::ulp1:
+                return batch_apply<vec<double>>(
+                    in.data(), out, in.size(), [](auto v) { return arcsin<Acos, accuracy::ulp4>(v); });
+            case accuracy::ulp4:
+                return batch_apply<vec<float>>(
+                    in.data(), out, in.size(), [](auto v) { return arcsin<Acos, accuracy::ulp4>(v); });
+            case accuracy::fast:
+                return batch_apply<vec<float>>(
+                    in.data(), out, in.size(), [](auto v) { return arcsin<Acos, accuracy::fast>(v); });
+        }
+    }
+    else if (acc != accuracy::ulp1)
+    {
+        return batch_apply<vec<T>>(in.data(), out, in.size(), [](auto v) { return arcsin<Acos, accuracy::ulp4>(v); });
+    }
+    for (std::size_t i = 0; i < in.size(); ++i)
+    {
+        out[i] = Acos ? std::acos(in[i]) : std::asin(in[i]);
+    }
+}
+
+template <class T>
+void sqrt_batch(std::span<const T> in, T* out)
+{
+    batch_apply<vec<T>>(in.data(), out, in.size(), [](auto v) { return vsqrt(v); });
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace ferrugo
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <fcntl.h>
+#include <ferrugo/core/ansi.hpp>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+namespace ferrugo
+{
+namespace core
+{
+
+struct duration_stats_t
+{
+    using duration_type = std::chrono::nanoseconds;
+
+    std::size_t count = 0;
+    duration_type total = {};
+    duration_type max = {};
+
+    void add(duration_type value)
+    {
+        ++count;
+        total += value;
+        max = std::max(max, value);
+    }
+
+    duration_type mean() const
+    {
+        return count != 0 ? total / static_cast<duration_type::rep>(count) : duration_type{};
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const duration_stats_t& item)
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        return os << "mean " << ms{ item.mean() }.count() << " ms, max " << ms{ item.max }.count() << " ms";
+    }
+};
+
+struct frame_stats_t
+{
+    std::size_t updates = 0;
+    std::size_t rendered = 0;
+    std::size_t presented = 0;
+    // Rendered frames replaced by a newer one before the terminal could take them
+    std::size_t dropped = 0;
+    // Update steps given up on because the updates fell behind the clock
+    std::size_t skipped_updates = 0;
+    duration_stats_t update_time = {};
+    duration_stats_t render_time = {};
+    // From taking a frame to the terminal having accepted all of its bytes
+    duration_stats_t write_time = {};
+    // Between consecutive presented frames
+    duration_stats_t frame_interval = {};
+
+    friend std::ostream& operator<<(std::ostream& os, const frame_stats_t& item)
+    {
+        return os << "updates: " << item.updates << " (" << item.skipped_updates << " skipped), " << item.update_time
+                  << "\nrendered: " << item.rendered << ", " << item.render_time << "\npresented: " << item.presented
+                  << " (" << item.dropped << " dropped), write " << item.write_time << ", interval "
+                  << item.frame_interval << "\n";
+    }
+};
+
+struct presenter_config_t
+{
+    std::chrono::nanoseconds frame_period = std::chrono::nanoseconds{ 1'000'000'000 / 60 };
+    std::chrono::nanoseconds update_step = std::chrono::nanoseconds{ 1'000'000'000 / 60 };
+    // At most this many update steps run per frame; the clock drops the rest instead of spiralling.
+    std::size_t max_updates_per_frame = 5;
+    int output_fd = STDOUT_FILENO;
+    color_depth_t color_depth = color_depth_t::true_color;
+    // Read by the presenter thread and handed out by take_input(); -1 for none.
+    int input_fd = -1;
+    // On stop, how long to wait for the terminal to take the rest of a partly written frame.
+    std::chrono::nanoseconds flush_timeout = std::chrono::seconds{ 1 };
+};
+
+// Drives an area on two threads. The render thread advances the model with fixed update steps and renders a frame
+// each period; the presenter thread owns the terminal, diffs each frame against the previous one and writes it
+// without blocking. When the terminal lags, a newer frame replaces the one waiting to be written, so updates and
+// rendering keep their pace and the terminal receives only the latest state. The threads hand frames over by swapping
+// buffers, so nothing is copied.
+class presenter_t
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using update_function = std::function<void(std::chrono::nanoseconds)>;
+    // Draws a frame on an area which has been cleared to blanks.
+    using render_function = std::function<void(const area_t::mut_ref_type&)>;
+
+    presenter_t(extent_t extent, update_function update, render_function render, presenter_config_t config = {})
+        : m_config{ config }
+        , m_update{ std::move(update) }
+        , m_render{ std::move(render) }
+        , m_back{ extent }
+        , m_pending{ extent }
+        , m_presenting{ extent }
+    {
+        if (m_config.frame_period.count() <= 0 || m_config.update_step.count() <= 0)
+        {
+            throw std::invalid_argument{ "presenter_t: periods must be positive" };
+        }
+        int fds[2];
+        if (::pipe(fds) != 0)
+        {
+            throw std::system_error{ errno, std::generic_category(), "pipe" };
+        }
+        m_wake_read = fds[0];
+        m_wake_write = fds[1];
+        try
+        {
+            set_nonblocking(m_wake_read);
+            set_nonblocking(m_wake_write);
+            m_output_flags = set_nonblocking(m_config.output_fd);
+
+            m_presenter_thread = std::thread{ [this]() { guarded([this]() { present_loop(); }); } };
+            m_render_thread = std::thread{ [this]() { guarded([this]() { render_loop(); }); } };
+        }
+        catch (...)
+        {
+            shutdown();
+            close_wake_pipe();
+            throw;
+        }
+    }
+
+    presenter_t(const presenter_t&) = delete;
+    presenter_t& operator=(const presenter_t&) = delete;
+
+    ~presenter_t()
+    {
+        try
+        {
+            stop();
+        }
+        catch (...)
+        {
+        }
+        close_wake_pipe();
+    }
+
+    // Joins both threads and restores the output descriptor. Rethrows the first exception thrown on either thread.
+    void stop()
+    {
+        shutdown();
+        std::exception_ptr error = {};
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            std::swap(error, m_error);
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Blocks until stop() is called or either thread fails.
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_stop_cv.wait(lock, [this]() { return m_stop; });
+    }
+
+    bool running() const
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return !m_stop;
+    }
+
+    frame_stats_t stats() const
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_stats;
+    }
+
+    // The bytes read from the input descriptor since the last call.
+    std::string take_input()
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return std::exchange(m_input, std::string{});
+    }
+
+private:
+    static int set_nonblocking(int fd)
+    {
+        const int flags = ::fcntl(fd, F_GETFL);
+        if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        {
+            throw std::system_error{ errno, std::generic_category(), "fcntl" };
+        }
+        return flags;
+    }
+
+    // Stops and joins whichever threads are running and restores the output descriptor.
+    void shutdown()
+    {
+        request_stop();
+        if (m_render_thread.joinable())
+        {
+            m_render_thread.join();
+        }
+        if (m_presenter_thread.joinable())
+        {
+            m_presenter_thread.join();
+        }
+        if (m_output_flags >= 0)
+        {
+            ::fcntl(m_config.output_fd, F_SETFL, m_output_flags);
+            m_output_flags = -1;
+        }
+    }
+
+    void close_wake_pipe()
+    {
+        ::close(m_wake_read);
+        ::close(m_wake_write);
+        m_wake_read = -1;
+        m_wake_write = -1;
+    }
+
+    template <class Fn>
+    void guarded(Fn fn)
+    {
+        try
+        {
+            fn();
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                if (!m_error)
+                {
+                    m_error = std::current_exception();
+                }
+            }
+            request_stop();
+        }
+    }
+
+    void request_stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_stop_cv.notify_all();
+        wake();
+    }
+
+    void wake()
+    {
+        const char byte = 0;
+        // A full pipe already holds a wake-up.
+        [[maybe_unused]] const auto result = ::write(m_wake_write, &byte, 1);
+    }
+
+    void render_loop()
+    {
+        auto previous = clock_type::now();
+        auto next_frame = previous;
+        std::chrono::nanoseconds lag{};
+        while (true)
+        {
+            const auto now = clock_type::now();
+            lag += std::chrono::duration_cast<std::chrono::nanoseconds>(now - previous);
+            previous = now;
+            std::size_t steps = 0;
+            for (; lag >= m_config.update_step && steps < m_config.max_updates_per_frame; ++steps)
+            {
+                const auto start = clock_type::now();
+                m_update(m_config.update_step);
+                lag -= m_config.update_step;
+                const auto elapsed = clock_type::now() - start;
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                ++m_stats.updates;
+                m_stats.update_time.add(elapsed);
+            }
+            const auto skipped = lag / m_config.update_step;
+            lag -= skipped * m_config.update_step;
+
+            const auto start = clock_type::now();
+            const auto ref = m_back.mut_ref();
+            ref.fill(glyph_t{});
+            m_render(ref);
+            const auto elapsed = clock_type::now() - start;
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                std::swap(m_back, m_pending);
+                m_stats.dropped += m_has_pending ? 1 : 0;
+                m_has_pending = true;
+                ++m_stats.rendered;
+                m_stats.render_time.add(elapsed);
+                m_stats.skipped_updates += static_cast<std::size_t>(skipped);
+            }
+            wake();
+
+            // A late frame moves the schedule instead of being followed by a burst of catch-up frames.
+            next_frame = std::max(next_frame + m_config.frame_period, clock_type::now());
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            if (m_stop_cv.wait_until(lock, next_frame, [this]() { return m_stop; }))
+            {
+                return;
+            }
+        }
+    }
+
+    void present_loop()
+    {
+        diff_renderer_t renderer{ m_config.color_depth };
+        const std::string* bytes = nullptr;
+        std::size_t written = 0;
+        clock_type::time_point taken = {};
+        clock_type::time_point last_presented = {};
+        char input[4096];
+        while (true)
+        {
+            if (!bytes && take_pending())
+            {
+                taken = clock_type::now();
+                bytes = &renderer.render(m_presenting.ref());
+                written = 0;
+            }
+
+            pollfd fds[3] = { { m_wake_read, POLLIN, 0 },
+                              { m_config.output_fd, static_cast<short>(bytes ? POLLOUT : 0), 0 },
+                              { m_config.input_fd, POLLIN, 0 } };
+            const nfds_t count = m_config.input_fd >= 0 ? 3 : 2;
+            if (::poll(fds, count, -1) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::system_error{ errno, std::generic_category(), "poll" };
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                char drain[64];
+                while (::read(m_wake_read, drain, sizeof(drain)) > 0)
+                {
+                }
+                bool stop = false;
+                {
+                    std::lock_guard<std::mutex> lock{ m_mutex };
+                    stop = m_stop;
+                }
+                if (stop)
+                {
+                    if (bytes)
+                    {
+                        finish_frame(*bytes, written);
+                    }
+                    return;
+                }
+            }
+
+            constexpr short input_events = POLLIN | POLLHUP | POLLERR | POLLNVAL;
+            if (count == 3 && (fds[2].revents & input_events))
+            {
+                const auto size = (fds[2].revents & POLLNVAL) ? -1 : ::read(m_config.input_fd, input, sizeof(input));
+                if (size > 0)
+                {
+                    std::lock_guard<std::mutex> lock{ m_mutex };
+                    m_input.append(input, static_cast<std::size_t>(size));
+                }
+                else if (size == 0 || (fds[2].revents & POLLNVAL) || (errno != EAGAIN && errno != EINTR))
+                {
+                    // End of input, or a descriptor which can no longer be read; polling it would spin.
+                    m_config.input_fd = -1;
+                }
+            }
+
+            if (bytes && (fds[1].revents & (POLLOUT | POLLERR | POLLHUP)))
+            {
+                if (write_some(*bytes, written))
+                {
+                    const auto now = clock_type::now();
+                    std::lock_guard<std::mutex> lock{ m_mutex };
+                    ++m_stats.presented;
+                    m_stats.write_time.add(now - taken);
+                    if (last_presented != clock_type::time_point{})
+                    {
+                        m_stats.frame_interval.add(now - last_presented);
+                    }
+                    last_presented = now;
+                    bytes = nullptr;
+                }
+            }
+        }
+    }
+
+    // Writes as much of the rest of `bytes` as the output takes without blocking; true once all of it is written.
+    bool write_some(const std::string& bytes, std::size_t& written)
+    {
+        const auto size = ::write(m_config.output_fd, bytes.data() + written, bytes.size() - written);
+        if (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            throw std::system_error{ errno, std::generic_category(), "write" };
+        }
+        written += size > 0 ? static_cast<std::size_t>(size) : 0;
+        return written == bytes.size();
+    }
+
+    // Waits for the terminal to take the rest of a partly written frame, so that it is not left inside an escape
+    // sequence; gives up after the flush timeout.
+    void finish_frame(const std::string& bytes, std::size_t written)
+    {
+        const auto deadline = clock_type::now() + m_config.flush_timeout;
+        while (written < bytes.size())
+        {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock_type::now()).count();
+            if (left <= 0)
+            {
+                return;
+            }
+            pollfd fd = { m_config.output_fd, POLLOUT, 0 };
+            const int ready = ::poll(&fd, 1, static_cast<int>(std::min<decltype(left)>(left, 1000)));
+            if (ready < 0 && errno != EINTR)
+            {
+                throw std::system_error{ errno, std::generic_category(), "poll" };
+            }
+            if (ready > 0)
+            {
+                write_some(bytes, written);
+            }
+        }
+    }
+
+    bool take_pending()
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_has_pending)
+        {
+            return false;
+        }
+        std::swap(m_pending, m_presenting);
+        m_has_pending = false;
+        return true;
+    }
+
+    presenter_config_t m_config;
+    update_function m_update;
+    render_function m_render;
+
+    // Written by the render thread only
+    area_t m_back;
+    // Guarded by m_mutex
+    area_t m_pending;
+    // Read by the presenter thread only
+    area_t m_presenting;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_stop_cv;
+    bool m_has_pending = false;
+    bool m_stop = false;
+    frame_stats_t m_stats = {};
+    std::string m_input;
+    std::exception_ptr m_error = {};
+
+    int m_wake_read = -1;
+    int m_wake_write = -1;
+    // The flags to restore on the output descriptor; -1 once restored.
+    int m_output_flags = -1;
+    std::thread m_render_thread;
+    std::thread m_presenter_thread;
+};
+
+}  // namespace core
+}  // namespace ferrugo
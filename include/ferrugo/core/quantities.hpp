@@ -1,8 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <ferrugo/core/arrays/simd.hpp>
+#include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <ratio>
+#include <span>
+#include <stdexcept>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
 namespace ferrugo
 {
@@ -16,7 +27,7 @@ struct quantity_t
     static constexpr std::size_t size = sizeof...(Dims);
     static constexpr std::array<short, size> values = { Dims... };
 
-    quantity_t() = default;
+    constexpr quantity_t() noexcept = default;
 };
 
 template <class T>
@@ -77,19 +88,19 @@ struct pow_result<quantity_t<Dims...>, N, D>
 };
 
 template <short... L, short... R>
-constexpr auto operator*(quantity_t<L...>, quantity_t<R...>) -> mul_result_t<quantity_t<L...>, quantity_t<R...>>
+constexpr auto operator*(quantity_t<L...>, quantity_t<R...>) noexcept -> mul_result_t<quantity_t<L...>, quantity_t<R...>>
 {
     return {};
 }
 
 template <short... L, short... R>
-constexpr auto operator/(quantity_t<L...>, quantity_t<R...>) -> div_result_t<quantity_t<L...>, quantity_t<R...>>
+constexpr auto operator/(quantity_t<L...>, quantity_t<R...>) noexcept -> div_result_t<quantity_t<L...>, quantity_t<R...>>
 {
     return {};
 }
 
 template <short... D>
-constexpr auto operator/(short, quantity_t<D...>) -> inv_result_t<quantity_t<D...>>
+constexpr auto operator/(short, quantity_t<D...>) noexcept -> inv_result_t<quantity_t<D...>>
 {
     return {};
 }
@@ -97,13 +108,13 @@ constexpr auto operator/(short, quantity_t<D...>) -> inv_result_t<quantity_t<D..
 template <short... D>
 std::ostream& operator<<(std::ostream& os, quantity_t<D...>)
 {
-    static const std::vector<std::string_view> names = {
+    static constexpr std::array<std::string_view, 12> names = {
         "length",
         "mass",
         "time",
         "coords",
         "temperature",
-        "angle"
+        "angle",
         "electric_current",
         "luminous_intensity",
         "solid_angle",
@@ -135,35 +146,102 @@ std::ostream& operator<<(std::ostream& os, quantity_t<D...>)
     return os;
 }
 
-template <class T, class Q, class = void>
-struct value_t;
+namespace detail
+{
 
-template <class T, class Q>
-struct value_t<T, Q, std::enable_if_t<is_quality<Q>{}>>
+template <class T>
+struct is_ratio : std::false_type
+{
+};
+
+template <std::intmax_t N, std::intmax_t D>
+struct is_ratio<std::ratio<N, D>> : std::true_type
+{
+};
+
+// Scale in which values of scales L and R can both be expressed as integer multiples, e.g. milli for (kilo, milli).
+template <class L, class R>
+using common_scale_t = typename std::ratio<std::gcd(L::num, R::num), std::lcm(L::den, R::den)>::type;
+
+// Converts a count of From units into a count of To units. The factor is folded at compile time; nothing is emitted
+// when the scales agree.
+template <class From, class To, class T>
+constexpr T rescale(T value) noexcept
+{
+    using factor = std::ratio_divide<From, To>;
+    if constexpr (factor::num == 1 && factor::den == 1)
+    {
+        return value;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        return value * (static_cast<T>(factor::num) / static_cast<T>(factor::den));
+    }
+    else if constexpr (factor::den == 1)
+    {
+        return value * static_cast<T>(factor::num);
+    }
+    else if constexpr (factor::num == 1)
+    {
+        return value / static_cast<T>(factor::den);
+    }
+    else
+    {
+        return value * static_cast<T>(factor::num) / static_cast<T>(factor::den);
+    }
+}
+
+// Conversions which cannot lose precision are implicit: into a floating point representation, or from an integer one
+// into a scale dividing the original.
+template <class T, class S, class U, class From>
+static constexpr bool is_exact_conversion
+    = std::is_floating_point_v<T> || (!std::is_floating_point_v<U> && std::ratio_divide<From, S>::den == 1);
+
+}  // namespace detail
+
+// A value of quantity Q counted in units of Scale times the SI base unit, e.g. value_t<double, length, std::kilo>.
+template <class T, class Q, class Scale = std::ratio<1>>
+struct value_t
 {
+    static_assert(is_quality<Q>{}, "quants::value_t: quantity expected");
+    static_assert(detail::is_ratio<Scale>{}, "quants::value_t: std::ratio scale expected");
+
+    using value_type = T;
+    using quantity_type = Q;
+    using scale_type = Scale;
+
     T m_value;
 
-    explicit value_t(T value = {}) : m_value{ value }
+    constexpr explicit value_t(T value = {}) noexcept : m_value{ value }
     {
     }
 
-    constexpr explicit operator bool() const
+    template <
+        class U,
+        class S,
+        class = std::enable_if_t<!(std::is_same_v<U, T> && std::is_same_v<S, Scale>) && std::is_convertible_v<U, T>>>
+    constexpr explicit(!detail::is_exact_conversion<T, Scale, U, S>) value_t(value_t<U, Q, S> other) noexcept
+        : m_value{ static_cast<T>(detail::rescale<S, Scale>(static_cast<std::common_type_t<T, U>>(other.get()))) }
+    {
+    }
+
+    constexpr explicit operator bool() const noexcept
     {
         return static_cast<bool>(m_value);
     }
 
-    constexpr T get() const
+    constexpr T get() const noexcept
     {
         return m_value;
     }
 
     template <class U>
-    constexpr value_t<U, Q> as() const
+    constexpr value_t<U, Q, Scale> as() const noexcept
     {
-        return value_t<U, Q>{ static_cast<U>(m_value) };
+        return value_t<U, Q, Scale>{ static_cast<U>(m_value) };
     }
 
-    constexpr value_t& reset(value_t value)
+    constexpr value_t& reset(value_t value) noexcept
     {
         m_value = value.get();
         return *this;
@@ -171,137 +249,929 @@ struct value_t<T, Q, std::enable_if_t<is_quality<Q>{}>>
 
     friend std::ostream& operator<<(std::ostream& os, const value_t& item)
     {
-        return os << item.m_value << " " << Q{};
+        os << item.m_value << " ";
+        if constexpr (!std::is_same_v<Scale, std::ratio<1>>)
+        {
+            os << "[" << Scale::num;
+            if constexpr (Scale::den != 1)
+            {
+                os << "/" << Scale::den;
+            }
+            os << "] ";
+        }
+        return os << Q{};
     }
 };
 
 template <class T, class Q>
 value_t(T) -> value_t<T, Q>;
 
+// Expresses item in units of S; the conversion may truncate integer values.
+template <class S, class T, class Q, class From>
+constexpr auto unit_cast(value_t<T, Q, From> item) noexcept -> value_t<T, Q, S>
+{
+    return value_t<T, Q, S>{ item };
+}
+
+template <class T, class Q>
+struct array;
+
+template <class T, class Q>
+struct span;
+
+template <class Q, class Op, class L, class R>
+struct array_expr;
+
+namespace detail
+{
+
+template <class Res, class Expr>
+void array_kernel(Res* out, std::size_t count, const Expr& expr);
+
+}  // namespace detail
+
+template <class T>
+struct is_value_array : std::false_type
+{
+};
+
 template <class T, class Q>
-constexpr auto operator+(value_t<T, Q> item) -> value_t<T, Q>
+struct is_value_array<array<T, Q>> : std::true_type
+{
+};
+
+template <class T, class Q>
+struct is_value_array<span<T, Q>> : std::true_type
+{
+};
+
+template <class T, class Q, class S>
+constexpr auto operator+(value_t<T, Q, S> item) noexcept -> value_t<T, Q, S>
 {
     return item;
 }
 
-template <class T, class Q>
-constexpr auto operator-(value_t<T, Q> item) -> value_t<T, Q>
+template <class T, class Q, class S>
+constexpr auto operator-(value_t<T, Q, S> item) noexcept -> value_t<T, Q, S>
 {
-    return value_t<T, Q>{ -item.get() };
+    return value_t<T, Q, S>{ -item.get() };
 }
 
-template <class L, class R, class Q, class Res = std::invoke_result_t<std::plus<>, L, R>>
-constexpr auto operator+(value_t<L, Q> lhs, value_t<R, Q> rhs) -> value_t<Res, Q>
+template <
+    class L,
+    class R,
+    class Q,
+    class SL,
+    class SR,
+    class Res = std::invoke_result_t<std::plus<>, L, R>,
+    class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator+(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> value_t<Res, Q, S>
 {
-    return value_t<Res, Q>{ lhs.get() + rhs.get() };
+    return value_t<Res, Q, S>{ detail::rescale<SL, S>(lhs.get()) + detail::rescale<SR, S>(rhs.get()) };
 }
 
-template <class L, class R, class Q, class Res = std::invoke_result_t<std::plus<>, L, R>>
-constexpr auto operator+=(value_t<L, Q>& lhs, value_t<R, Q> rhs) -> value_t<L, Q>&
+template <class L, class R, class Q, class SL, class SR, class Res = std::invoke_result_t<std::plus<>, L, R>>
+constexpr auto operator+=(value_t<L, Q, SL>& lhs, value_t<R, Q, SR> rhs) noexcept -> value_t<L, Q, SL>&
 {
-    return lhs.reset((lhs + rhs).template as<L>());
+    lhs.m_value = value_t<L, Q, SL>{ lhs + rhs }.get();
+    return lhs;
 }
 
-template <class L, class R, class Q, class Res = std::invoke_result_t<std::minus<>, L, R>>
-constexpr auto operator-(value_t<L, Q> lhs, value_t<R, Q> rhs) -> value_t<Res, Q>
+template <
+    class L,
+    class R,
+    class Q,
+    class SL,
+    class SR,
+    class Res = std::invoke_result_t<std::minus<>, L, R>,
+    class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator-(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> value_t<Res, Q, S>
 {
-    return value_t<Res, Q>{ lhs.get() - rhs.get() };
+    return value_t<Res, Q, S>{ detail::rescale<SL, S>(lhs.get()) - detail::rescale<SR, S>(rhs.get()) };
 }
 
-template <class L, class R, class Q, class Res = std::invoke_result_t<std::minus<>, L, R>>
-constexpr auto operator-=(value_t<L, Q>& lhs, value_t<R, Q> rhs) -> value_t<L, Q>&
+template <class L, class R, class Q, class SL, class SR, class Res = std::invoke_result_t<std::minus<>, L, R>>
+constexpr auto operator-=(value_t<L, Q, SL>& lhs, value_t<R, Q, SR> rhs) noexcept -> value_t<L, Q, SL>&
 {
-    return lhs.reset((lhs - rhs).template as<L>());
+    lhs.m_value = value_t<L, Q, SL>{ lhs - rhs }.get();
+    return lhs;
 }
 
-template <class L, class R, class QL, class QR, class Res = std::invoke_result_t<std::multiplies<>, L, R>>
-constexpr auto operator*(value_t<L, QL> lhs, value_t<R, QR> rhs) -> value_t<Res, mul_result_t<QL, QR>>
+template <
+    class L,
+    class R,
+    class QL,
+    class QR,
+    class SL,
+    class SR,
+    class Res = std::invoke_result_t<std::multiplies<>, L, R>,
+    class S = std::ratio_multiply<SL, SR>>
+constexpr auto operator*(value_t<L, QL, SL> lhs, value_t<R, QR, SR> rhs) noexcept -> value_t<Res, mul_result_t<QL, QR>, S>
 {
-    return value_t<Res, mul_result_t<QL, QR>>{ lhs.get() * rhs.get() };
+    return value_t<Res, mul_result_t<QL, QR>, S>{ lhs.get() * rhs.get() };
 }
 
-template <class L, class R, class QR, class Res = std::invoke_result_t<std::minus<>, L, R>>
-constexpr auto operator*(L lhs, value_t<R, QR> rhs) -> value_t<Res, QR>
+template <
+    class L,
+    class R,
+    class QR,
+    class SR,
+    class = std::enable_if_t<!is_value_array<L>{}>,
+    class Res = std::invoke_result_t<std::multiplies<>, L, R>>
+constexpr auto operator*(L lhs, value_t<R, QR, SR> rhs) noexcept -> value_t<Res, QR, SR>
 {
-    return value_t<Res, QR>{ lhs * rhs.get() };
+    return value_t<Res, QR, SR>{ lhs * rhs.get() };
 }
 
-template <class L, class R, class QL, class Res = std::invoke_result_t<std::multiplies<>, L, R>>
-constexpr auto operator*(value_t<L, QL> lhs, R rhs) -> value_t<Res, QL>
+template <
+    class L,
+    class R,
+    class QL,
+    class SL,
+    class = std::enable_if_t<!is_value_array<R>{}>,
+    class Res = std::invoke_result_t<std::multiplies<>, L, R>>
+constexpr auto operator*(value_t<L, QL, SL> lhs, R rhs) noexcept -> value_t<Res, QL, SL>
 {
     return rhs * lhs;
 }
 
-template <class L, class R, class QL, class Res = std::invoke_result_t<std::multiplies<>, L, R>>
-constexpr auto operator*=(value_t<L, QL>& lhs, R rhs) -> value_t<L, QL>&
+template <class L, class R, class QL, class SL, class Res = std::invoke_result_t<std::multiplies<>, L, R>>
+constexpr auto operator*=(value_t<L, QL, SL>& lhs, R rhs) noexcept -> value_t<L, QL, SL>&
 {
-    return lhs.reset((lhs * rhs).template as<L>());
+    lhs.m_value = static_cast<L>(lhs.get() * rhs);
+    return lhs;
 }
 
-template <class L, class R, class QL, class QR, class Res = std::invoke_result_t<std::divides<>, L, R>>
-constexpr auto operator/(value_t<L, QL> lhs, value_t<R, QR> rhs) -> value_t<Res, div_result_t<QL, QR>>
+template <
+    class L,
+    class R,
+    class QL,
+    class QR,
+    class SL,
+    class SR,
+    class Res = std::invoke_result_t<std::divides<>, L, R>,
+    class S = std::ratio_divide<SL, SR>>
+constexpr auto operator/(value_t<L, QL, SL> lhs, value_t<R, QR, SR> rhs) noexcept -> value_t<Res, div_result_t<QL, QR>, S>
 {
-    return value_t<Res, div_result_t<QL, QR>>{ lhs.get() / rhs.get() };
+    return value_t<Res, div_result_t<QL, QR>, S>{ lhs.get() / rhs.get() };
 }
 
-template <class L, class R, class Q, class Res = std::invoke_result_t<std::divides<>, L, R>>
-constexpr auto operator/(value_t<L, Q> lhs, value_t<R, Q> rhs) -> Res
+template <
+    class L,
+    class R,
+    class Q,
+    class SL,
+    class SR,
+    class Res = std::invoke_result_t<std::divides<>, L, R>,
+    class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator/(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> Res
 {
-    return lhs.get() / rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) / detail::rescale<SR, S>(rhs.get());
 }
 
-template <class L, class R, class QL, class Res = std::invoke_result_t<std::divides<>, L, R>>
-constexpr auto operator/=(value_t<L, QL>& lhs, R rhs) -> value_t<L, QL>&
+template <class L, class R, class QL, class SL, class Res = std::invoke_result_t<std::divides<>, L, R>>
+constexpr auto operator/=(value_t<L, QL, SL>& lhs, R rhs) noexcept -> value_t<L, QL, SL>&
 {
-    return lhs.reset((lhs / rhs).template as<L>());
+    lhs.m_value = static_cast<L>(lhs.get() / rhs);
+    return lhs;
 }
 
-template <class L, class R, class QL, class Res = std::invoke_result_t<std::divides<>, L, R>>
-constexpr auto operator/(value_t<L, QL> lhs, R rhs) -> value_t<Res, QL>
+template <
+    class L,
+    class R,
+    class QL,
+    class SL,
+    class = std::enable_if_t<!is_value_array<R>{}>,
+    class Res = std::invoke_result_t<std::divides<>, L, R>>
+constexpr auto operator/(value_t<L, QL, SL> lhs, R rhs) noexcept -> value_t<Res, QL, SL>
 {
-    return value_t<Res, QL>{ lhs.get() / rhs };
+    return value_t<Res, QL, SL>{ lhs.get() / rhs };
 }
 
-template <class L, class R, class QR, class Res = std::invoke_result_t<std::divides<>, L, R>>
-constexpr auto operator/(L lhs, value_t<R, QR> rhs) -> value_t<Res, inv_result_t<QR>>
+template <
+    class L,
+    class R,
+    class QR,
+    class SR,
+    class = std::enable_if_t<!is_value_array<L>{}>,
+    class Res = std::invoke_result_t<std::divides<>, L, R>,
+    class S = std::ratio_divide<std::ratio<1>, SR>>
+constexpr auto operator/(L lhs, value_t<R, QR, SR> rhs) noexcept -> value_t<Res, inv_result_t<QR>, S>
 {
-    return value_t<Res, inv_result_t<QR>>{ lhs / rhs.get() };
+    return value_t<Res, inv_result_t<QR>, S>{ lhs / rhs.get() };
 }
 
-template <class L, class R, class Q>
-constexpr auto operator==(value_t<L, Q> lhs, value_t<R, Q> rhs) -> bool
+template <class L, class R, class Q, class SL, class SR, class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator==(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> bool
 {
-    return lhs.get() == rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) == detail::rescale<SR, S>(rhs.get());
 }
 
-template <class L, class R, class Q>
-constexpr auto operator!=(value_t<L, Q> lhs, value_t<R, Q> rhs) -> bool
+template <class L, class R, class Q, class SL, class SR, class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator!=(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> bool
 {
-    return lhs.get() != rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) != detail::rescale<SR, S>(rhs.get());
 }
 
-template <class L, class R, class Q>
-constexpr auto operator<(value_t<L, Q> lhs, value_t<R, Q> rhs) -> bool
+template <class L, class R, class Q, class SL, class SR, class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator<(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> bool
 {
-    return lhs.get() < rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) < detail::rescale<SR, S>(rhs.get());
 }
 
-template <class L, class R, class Q>
-constexpr auto operator>(value_t<L, Q> lhs, value_t<R, Q> rhs) -> bool
+template <class L, class R, class Q, class SL, class SR, class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator>(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> bool
 {
-    return lhs.get() > rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) > detail::rescale<SR, S>(rhs.get());
 }
 
-template <class L, class R, class Q>
-constexpr auto operator<=(value_t<L, Q> lhs, value_t<R, Q> rhs) -> bool
+template <class L, class R, class Q, class SL, class SR, class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator<=(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> bool
 {
-    return lhs.get() <= rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) <= detail::rescale<SR, S>(rhs.get());
 }
 
-template <class L, class R, class Q>
-constexpr auto operator>=(value_t<L, Q> lhs, value_t<R, Q> rhs) -> bool
+template <class L, class R, class Q, class SL, class SR, class S = detail::common_scale_t<SL, SR>>
+constexpr auto operator>=(value_t<L, Q, SL> lhs, value_t<R, Q, SR> rhs) noexcept -> bool
 {
-    return lhs.get() >= rhs.get();
+    return detail::rescale<SL, S>(lhs.get()) >= detail::rescale<SR, S>(rhs.get());
+}
+
+// Values of one quantity stored as plain T. Arithmetic on arrays and spans builds an array_expr that is evaluated in a
+// single vectorized pass when it is assigned to an array, added to one in place, or passed to eval.
+template <class T, class Q>
+struct array
+{
+    static_assert(is_quality<Q>{}, "quants::array: quantity expected");
+
+    using value_type = value_t<T, Q>;
+
+    array() = default;
+
+    explicit array(std::size_t count, value_type init = value_type{}) : m_data(count, init.get())
+    {
+    }
+
+    array(std::initializer_list<value_type> init)
+    {
+        m_data.reserve(init.size());
+        for (const auto& item : init)
+        {
+            m_data.push_back(item.get());
+        }
+    }
+
+    template <class Op, class L, class R>
+    array(const array_expr<Q, Op, L, R>& expr)
+    {
+        *this = expr;
+    }
+
+    array(const array&) = default;
+    array(array&&) = default;
+    array& operator=(const array&) = default;
+    array& operator=(array&&) = default;
+
+    // Storage of the same size is reused; each element only reads its own lane, so the expression may refer to *this.
+    template <class Op, class L, class R>
+    array& operator=(const array_expr<Q, Op, L, R>& expr)
+    {
+        if (expr.size() == m_data.size())
+        {
+            detail::array_kernel(m_data.data(), m_data.size(), expr);
+            return *this;
+        }
+        std::vector<T> data(expr.size());
+        detail::array_kernel(data.data(), data.size(), expr);
+        m_data = std::move(data);
+        return *this;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_data.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return m_data.empty();
+    }
+
+    void resize(std::size_t count)
+    {
+        m_data.resize(count);
+    }
+
+    void push_back(value_type item)
+    {
+        m_data.push_back(item.get());
+    }
+
+    const T* data() const noexcept
+    {
+        return m_data.data();
+    }
+
+    T* data() noexcept
+    {
+        return m_data.data();
+    }
+
+    std::span<const T> raw() const noexcept
+    {
+        return m_data;
+    }
+
+    std::span<T> raw() noexcept
+    {
+        return m_data;
+    }
+
+    value_type operator[](std::size_t n) const noexcept
+    {
+        return value_type{ m_data[n] };
+    }
+
+    void set(std::size_t n, value_type item) noexcept
+    {
+        m_data[n] = item.get();
+    }
+
+    operator span<const T, Q>() const noexcept
+    {
+        return span<const T, Q>{ raw() };
+    }
+
+    operator span<T, Q>() noexcept
+    {
+        return span<T, Q>{ raw() };
+    }
+
+    std::vector<T> m_data;
+};
+
+// Non-owning counterpart of array over existing storage; T may be const.
+template <class T, class Q>
+struct span
+{
+    static_assert(is_quality<Q>{}, "quants::span: quantity expected");
+
+    using element_type = T;
+    using value_type = value_t<std::remove_const_t<T>, Q>;
+
+    constexpr span() noexcept = default;
+
+    constexpr explicit span(std::span<T> data) noexcept : m_data{ data }
+    {
+    }
+
+    template <class U, class = std::enable_if_t<std::is_same_v<const U, T>>>
+    constexpr span(span<U, Q> other) noexcept : m_data{ other.raw() }
+    {
+    }
+
+    constexpr std::size_t size() const noexcept
+    {
+        return m_data.size();
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return m_data.empty();
+    }
+
+    constexpr T* data() const noexcept
+    {
+        return m_data.data();
+    }
+
+    constexpr std::span<T> raw() const noexcept
+    {
+        return m_data;
+    }
+
+    constexpr value_type operator[](std::size_t n) const noexcept
+    {
+        return value_type{ m_data[n] };
+    }
+
+    template <class U = T, class = std::enable_if_t<!std::is_const_v<U>>>
+    constexpr void set(std::size_t n, value_type item) const noexcept
+    {
+        m_data[n] = item.get();
+    }
+
+    std::span<T> m_data;
+};
+
+namespace detail
+{
+
+// Operands of array_expr expose the raw element type, the quantity (void for plain numbers), size() and element / lane
+// access. `simd_type<T>` tells whether all leaves hold T, so that whole registers can be loaded.
+
+template <class T, class Q>
+struct array_operand
+{
+    using element_type = T;
+    using quantity_type = Q;
+
+    template <class U>
+    static constexpr bool simd_type = std::is_same_v<T, U>;
+
+    const T* m_data;
+    std::size_t m_size;
+
+    constexpr std::size_t size() const
+    {
+        return m_size;
+    }
+
+    constexpr T get(std::size_t n) const
+    {
+        return m_data[n];
+    }
+
+    template <class S>
+    auto load(std::size_t n) const
+    {
+        return S::load(m_data + n);
+    }
+};
+
+// Temporaries are moved into the expression so that it does not outlive them.
+template <class T, class Q>
+struct owning_operand
+{
+    using element_type = T;
+    using quantity_type = Q;
+
+    template <class U>
+    static constexpr bool simd_type = std::is_same_v<T, U>;
+
+    array<T, Q> m_array;
+
+    std::size_t size() const
+    {
+        return m_array.size();
+    }
+
+    T get(std::size_t n) const
+    {
+        return m_array.m_data[n];
+    }
+
+    template <class S>
+    auto load(std::size_t n) const
+    {
+        return S::load(m_array.data() + n);
+    }
+};
+
+template <class T, class Q>
+struct broadcast_operand
+{
+    using element_type = T;
+    using quantity_type = Q;
+
+    template <class U>
+    static constexpr bool simd_type = std::is_same_v<T, U>;
+
+    T m_value;
+
+    constexpr std::size_t size() const
+    {
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    constexpr T get(std::size_t) const
+    {
+        return m_value;
+    }
+
+    template <class S>
+    auto load(std::size_t) const
+    {
+        return S::broadcast(m_value);
+    }
+};
+
+inline std::size_t common_size(std::size_t lhs, std::size_t rhs)
+{
+    if (lhs != rhs && lhs != std::numeric_limits<std::size_t>::max() && rhs != std::numeric_limits<std::size_t>::max())
+    {
+        throw std::invalid_argument{ "quants::array: size mismatch" };
+    }
+    return std::min(lhs, rhs);
+}
+
+// out[i] = expr[i], a register of lanes at a time when every leaf of expr holds the floating point type of out.
+template <class Res, class Expr>
+void array_kernel(Res* out, std::size_t count, const Expr& expr)
+{
+    if constexpr (
+        std::is_floating_point_v<Res> && Expr::template simd_type<Res>
+        && std::is_same_v<typename Expr::element_type, Res>)
+    {
+        core::detail::simd_for_each<Res>(
+            count,
+            [&](auto simd, std::size_t i)
+            {
+                using S = decltype(simd);
+                S::store(out + i, expr.template load<S>(i));
+            });
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out[i] = static_cast<Res>(expr.get(i));
+        }
+    }
+}
+
+}  // namespace detail
+
+template <class Q, class Op, class L, class R>
+struct array_expr
+{
+    using quantity_type = Q;
+    using element_type = std::invoke_result_t<Op, typename L::element_type, typename R::element_type>;
+    using value_type = value_t<element_type, Q>;
+
+    template <class U>
+    static constexpr bool simd_type = L::template simd_type<U> && R::template simd_type<U>;
+
+    Op m_op;
+    L m_lhs;
+    R m_rhs;
+    std::size_t m_size;
+
+    array_expr(Op op, L lhs, R rhs)
+        : m_op{ op }
+        , m_lhs{ std::move(lhs) }
+        , m_rhs{ std::move(rhs) }
+        , m_size{ detail::common_size(m_lhs.size(), m_rhs.size()) }
+    {
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    element_type get(std::size_t n) const
+    {
+        return m_op(m_lhs.get(n), m_rhs.get(n));
+    }
+
+    value_type operator[](std::size_t n) const
+    {
+        return value_type{ get(n) };
+    }
+
+    template <class S>
+    auto load(std::size_t n) const
+    {
+        return m_op(m_lhs.template load<S>(n), m_rhs.template load<S>(n));
+    }
+};
+
+template <class Q, class Op, class L, class R>
+struct is_value_array<array_expr<Q, Op, L, R>> : std::true_type
+{
+};
+
+namespace detail
+{
+
+template <class T, class Q>
+auto make_operand(const array<T, Q>& item) -> array_operand<T, Q>
+{
+    return { item.data(), item.size() };
+}
+
+template <class T, class Q>
+auto make_operand(array<T, Q>&& item) -> owning_operand<T, Q>
+{
+    return { std::move(item) };
+}
+
+template <class T, class Q>
+auto make_operand(const span<T, Q>& item) -> array_operand<std::remove_const_t<T>, Q>
+{
+    return { item.data(), item.size() };
+}
+
+template <class Q, class Op, class L, class R>
+auto make_operand(const array_expr<Q, Op, L, R>& item) -> array_expr<Q, Op, L, R>
+{
+    return item;
+}
+
+// Arrays hold base units; a scaled operand is converted once, before the loop. The conversion waits for match_scalar,
+// so that 500 mm of int against doubles becomes 0.5 rather than the integer 0.
+template <class T, class Q, class S>
+struct scaled_operand
+{
+    using element_type = T;
+    using quantity_type = Q;
+
+    T m_value;
+};
+
+template <class T, class Q, class S>
+auto make_operand(value_t<T, Q, S> item) -> scaled_operand<T, Q, S>
+{
+    return { item.get() };
+}
+
+template <class T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+auto make_operand(T item) -> broadcast_operand<T, void>
+{
+    return { item };
+}
+
+// A scalar takes the element type of the operand it is combined with, so that `x * 2` on doubles stays on the vector
+// path. A floating point scalar combined with integers is left as it is.
+template <class T, class Operand>
+auto match_scalar(Operand operand) -> Operand
+{
+    return operand;
+}
+
+template <
+    class T,
+    class U,
+    class Q,
+    std::enable_if_t<std::is_arithmetic_v<T> && (std::is_floating_point_v<T> || std::is_integral_v<U>), int> = 0>
+auto match_scalar(broadcast_operand<U, Q> operand) -> broadcast_operand<T, Q>
+{
+    return { static_cast<T>(operand.m_value) };
+}
+
+template <class T, class U, class Q, class S>
+auto match_scalar(scaled_operand<U, Q, S> operand)
+{
+    using element_type
+        = std::conditional_t<std::is_arithmetic_v<T> && (std::is_floating_point_v<T> || std::is_integral_v<U>), T, U>;
+    return broadcast_operand<element_type, Q>{ rescale<S, std::ratio<1>>(static_cast<element_type>(operand.m_value)) };
+}
+
+// -x for array_expr, which only combines two operands; the left one is a placeholder.
+struct negate_right
+{
+    template <class L, class R>
+    constexpr auto operator()(const L&, const R& rhs) const
+    {
+        return -rhs;
+    }
+};
+
+template <class T>
+using operand_t = decltype(make_operand(std::declval<T>()));
+
+template <class T>
+using operand_quantity_t = typename operand_t<T>::quantity_type;
+
+template <class L, class R, class = void>
+struct is_array_operation : std::false_type
+{
+};
+
+template <class L, class R>
+struct is_array_operation<L, R, std::void_t<operand_t<L>, operand_t<R>>>
+    : std::bool_constant<is_value_array<std::decay_t<L>>{} || is_value_array<std::decay_t<R>>{}>
+{
+};
+
+template <class L, class R, class = void>
+struct is_additive_array_operation : std::false_type
+{
+};
+
+template <class L, class R>
+struct is_additive_array_operation<L, R, std::enable_if_t<is_array_operation<L, R>{}>>
+    : std::bool_constant<
+          !std::is_void_v<operand_quantity_t<L>> && std::is_same_v<operand_quantity_t<L>, operand_quantity_t<R>>>
+{
+};
+
+template <class QL, class QR>
+struct mul_quantity
+{
+    using type = mul_result_t<QL, QR>;
+};
+
+template <class Q>
+struct mul_quantity<Q, void>
+{
+    using type = Q;
+};
+
+template <class Q>
+struct mul_quantity<void, Q>
+{
+    using type = Q;
+};
+
+template <class QL, class QR>
+struct div_quantity
+{
+    using type = div_result_t<QL, QR>;
+};
+
+template <class Q>
+struct div_quantity<Q, void>
+{
+    using type = Q;
+};
+
+template <class Q>
+struct div_quantity<void, Q>
+{
+    using type = inv_result_t<Q>;
+};
+
+template <class Q, class Op, class L, class R>
+auto make_array_expr(Op op, L&& lhs, R&& rhs)
+{
+    auto l = make_operand(std::forward<L>(lhs));
+    auto r = make_operand(std::forward<R>(rhs));
+    using lhs_element = typename decltype(l)::element_type;
+    using rhs_element = typename decltype(r)::element_type;
+    auto ml = match_scalar<rhs_element>(std::move(l));
+    auto mr = match_scalar<lhs_element>(std::move(r));
+    return array_expr<Q, Op, decltype(ml), decltype(mr)>{ op, std::move(ml), std::move(mr) };
+}
+
+template <class Op, class T, class Q, class R>
+void array_update(Op op, T* data, std::size_t size, R&& rhs)
+{
+    auto r = match_scalar<T>(make_operand(std::forward<R>(rhs)));
+    using operand_type = decltype(r);
+    const auto expr = array_expr<Q, Op, array_operand<T, Q>, operand_type>{ op, { data, size }, std::move(r) };
+    if (expr.size() != size)
+    {
+        throw std::invalid_argument{ "quants::array: size mismatch" };
+    }
+    array_kernel(data, size, expr);
+}
+
+}  // namespace detail
+
+template <class Q, class Op, class L, class R>
+auto eval(const array_expr<Q, Op, L, R>& expr) -> array<typename array_expr<Q, Op, L, R>::element_type, Q>
+{
+    return expr;
+}
+
+template <class L, class = std::enable_if_t<is_value_array<std::decay_t<L>>{}>>
+auto operator-(L&& item)
+{
+    using T = typename detail::operand_t<L>::element_type;
+    return detail::make_array_expr<detail::operand_quantity_t<L>>(detail::negate_right{}, T{}, std::forward<L>(item));
+}
+
+template <class L, class R, class = std::enable_if_t<detail::is_additive_array_operation<L, R>{}>>
+auto operator+(L&& lhs, R&& rhs)
+{
+    return detail::make_array_expr<detail::operand_quantity_t<L>>(
+        std::plus<>{}, std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+template <class L, class R, class = std::enable_if_t<detail::is_additive_array_operation<L, R>{}>>
+auto operator-(L&& lhs, R&& rhs)
+{
+    return detail::make_array_expr<detail::operand_quantity_t<L>>(
+        std::minus<>{}, std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+template <class L, class R, class = std::enable_if_t<detail::is_array_operation<L, R>{}>>
+auto operator*(L&& lhs, R&& rhs)
+{
+    using quantity_type =
+        typename detail::mul_quantity<detail::operand_quantity_t<L>, detail::operand_quantity_t<R>>::type;
+    return detail::make_array_expr<quantity_type>(std::multiplies<>{}, std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+template <class L, class R, class = std::enable_if_t<detail::is_array_operation<L, R>{}>>
+auto operator/(L&& lhs, R&& rhs)
+{
+    using quantity_type =
+        typename detail::div_quantity<detail::operand_quantity_t<L>, detail::operand_quantity_t<R>>::type;
+    return detail::make_array_expr<quantity_type>(std::divides<>{}, std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+template <class T, class Q, class R, class = std::enable_if_t<std::is_same_v<Q, detail::operand_quantity_t<R>>>>
+auto operator+=(array<T, Q>& lhs, R&& rhs) -> array<T, Q>&
+{
+    detail::array_update<std::plus<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <class T, class Q, class R, class = std::enable_if_t<std::is_same_v<Q, detail::operand_quantity_t<R>>>>
+auto operator-=(array<T, Q>& lhs, R&& rhs) -> array<T, Q>&
+{
+    detail::array_update<std::minus<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <
+    class T,
+    class Q,
+    class R,
+    class = std::enable_if_t<std::is_same_v<Q, typename detail::mul_quantity<Q, detail::operand_quantity_t<R>>::type>>>
+auto operator*=(array<T, Q>& lhs, R&& rhs) -> array<T, Q>&
+{
+    detail::array_update<std::multiplies<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <
+    class T,
+    class Q,
+    class R,
+    class = std::enable_if_t<std::is_same_v<Q, typename detail::div_quantity<Q, detail::operand_quantity_t<R>>::type>>>
+auto operator/=(array<T, Q>& lhs, R&& rhs) -> array<T, Q>&
+{
+    detail::array_update<std::divides<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <
+    class T,
+    class Q,
+    class R,
+    class = std::enable_if_t<!std::is_const_v<T> && std::is_same_v<Q, detail::operand_quantity_t<R>>>>
+auto operator+=(const span<T, Q>& lhs, R&& rhs) -> const span<T, Q>&
+{
+    detail::array_update<std::plus<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <
+    class T,
+    class Q,
+    class R,
+    class = std::enable_if_t<!std::is_const_v<T> && std::is_same_v<Q, detail::operand_quantity_t<R>>>>
+auto operator-=(const span<T, Q>& lhs, R&& rhs) -> const span<T, Q>&
+{
+    detail::array_update<std::minus<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <
+    class T,
+    class Q,
+    class R,
+    class = std::enable_if_t<
+        !std::is_const_v<T>
+        && std::is_same_v<Q, typename detail::mul_quantity<Q, detail::operand_quantity_t<R>>::type>>>
+auto operator*=(const span<T, Q>& lhs, R&& rhs) -> const span<T, Q>&
+{
+    detail::array_update<std::multiplies<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <
+    class T,
+    class Q,
+    class R,
+    class = std::enable_if_t<
+        !std::is_const_v<T>
+        && std::is_same_v<Q, typename detail::div_quantity<Q, detail::operand_quantity_t<R>>::type>>>
+auto operator/=(const span<T, Q>& lhs, R&& rhs) -> const span<T, Q>&
+{
+    detail::array_update<std::divides<>, T, Q>({}, lhs.data(), lhs.size(), std::forward<R>(rhs));
+    return lhs;
+}
+
+template <class T, class Q>
+std::ostream& operator<<(std::ostream& os, span<T, Q> item)
+{
+    os << "[";
+    for (std::size_t n = 0; n < item.size(); ++n)
+    {
+        if (n != 0)
+        {
+            os << " ";
+        }
+        os << item.raw()[n];
+    }
+    return os << "] " << Q{};
+}
+
+template <class T, class Q>
+std::ostream& operator<<(std::ostream& os, const array<T, Q>& item)
+{
+    return os << span<const T, Q>{ item };
+}
+
+template <class Q, class Op, class L, class R>
+std::ostream& operator<<(std::ostream& os, const array_expr<Q, Op, L, R>& item)
+{
+    return os << eval(item);
 }
 
 namespace quantities
@@ -366,20 +1236,22 @@ using angular_energy        = mul_result_t<torque, angle>;
 
 }  // namespace quantities
 
-#define DEFINE_QUANTITY(NAME)                                         \
-                                                                      \
-    template <class T>                                                \
-    using NAME##_t = value_t<T, quantities::NAME>;                    \
-    namespace literals                                                \
-    {                                                                 \
-    auto operator"" _##NAME(double long v) -> NAME##_t<double>        \
-    {                                                                 \
-        return NAME##_t<double>(double(v));                           \
-    }                                                                 \
-    auto operator"" _##NAME(unsigned long long v) -> NAME##_t<double> \
-    {                                                                 \
-        return NAME##_t<double>(double(v));                           \
-    }                                                                 \
+#define DEFINE_QUANTITY(NAME)                                                            \
+                                                                                         \
+    template <class T, class Scale = std::ratio<1>>                                      \
+    using NAME##_t = value_t<T, quantities::NAME, Scale>;                                \
+    template <class T>                                                                   \
+    using NAME##_array = array<T, quantities::NAME>;                                     \
+    namespace literals                                                                   \
+    {                                                                                    \
+    constexpr auto operator"" _##NAME(double long v) noexcept -> NAME##_t<double>        \
+    {                                                                                    \
+        return NAME##_t<double>(double(v));                                              \
+    }                                                                                    \
+    constexpr auto operator"" _##NAME(unsigned long long v) noexcept -> NAME##_t<double> \
+    {                                                                                    \
+        return NAME##_t<double>(double(v));                                              \
+    }                                                                                    \
     }
 
 DEFINE_QUANTITY(scalar)
@@ -438,5 +1310,80 @@ DEFINE_QUANTITY(angular_energy)
 
 #undef DEFINE_QUANTITY
 
+namespace scales
+{
+
+using minute = std::ratio<60>;
+using hour = std::ratio<3600>;
+using kilometer_per_hour = std::ratio_divide<std::kilo, hour>;
+
+}  // namespace scales
+
+#define DEFINE_UNIT(SYMBOL, NAME, SCALE)                                                                          \
+                                                                                                                  \
+    namespace literals                                                                                            \
+    {                                                                                                             \
+    constexpr auto operator""_##SYMBOL(double long v) noexcept -> value_t<double, quantities::NAME, SCALE>        \
+    {                                                                                                             \
+        return value_t<double, quantities::NAME, SCALE>(double(v));                                               \
+    }                                                                                                             \
+    constexpr auto operator""_##SYMBOL(unsigned long long v) noexcept -> value_t<double, quantities::NAME, SCALE> \
+    {                                                                                                             \
+        return value_t<double, quantities::NAME, SCALE>(double(v));                                               \
+    }                                                                                                             \
+    }
+
+DEFINE_UNIT(nm, length, std::nano)
+DEFINE_UNIT(um, length, std::micro)
+DEFINE_UNIT(mm, length, std::milli)
+DEFINE_UNIT(cm, length, std::centi)
+DEFINE_UNIT(m, length, std::ratio<1>)
+DEFINE_UNIT(km, length, std::kilo)
+
+DEFINE_UNIT(mg, mass, std::micro)
+DEFINE_UNIT(g, mass, std::milli)
+DEFINE_UNIT(kg, mass, std::ratio<1>)
+DEFINE_UNIT(t, mass, std::kilo)
+
+DEFINE_UNIT(ns, time, std::nano)
+DEFINE_UNIT(us, time, std::micro)
+DEFINE_UNIT(ms, time, std::milli)
+DEFINE_UNIT(s, time, std::ratio<1>)
+DEFINE_UNIT(min, time, scales::minute)
+DEFINE_UNIT(h, time, scales::hour)
+
+DEFINE_UNIT(mps, velocity, std::ratio<1>)
+DEFINE_UNIT(kmph, velocity, scales::kilometer_per_hour)
+
+DEFINE_UNIT(Hz, frequency, std::ratio<1>)
+DEFINE_UNIT(kHz, frequency, std::kilo)
+DEFINE_UNIT(MHz, frequency, std::mega)
+DEFINE_UNIT(GHz, frequency, std::giga)
+
+DEFINE_UNIT(N, force, std::ratio<1>)
+DEFINE_UNIT(kN, force, std::kilo)
+
+DEFINE_UNIT(Pa, pressure, std::ratio<1>)
+DEFINE_UNIT(kPa, pressure, std::kilo)
+DEFINE_UNIT(MPa, pressure, std::mega)
+DEFINE_UNIT(GPa, pressure, std::giga)
+
+DEFINE_UNIT(J, energy, std::ratio<1>)
+DEFINE_UNIT(kJ, energy, std::kilo)
+DEFINE_UNIT(MJ, energy, std::mega)
+
+DEFINE_UNIT(W, power, std::ratio<1>)
+DEFINE_UNIT(kW, power, std::kilo)
+DEFINE_UNIT(MW, power, std::mega)
+
+DEFINE_UNIT(mA, electric_current, std::milli)
+DEFINE_UNIT(A, electric_current, std::ratio<1>)
+
+DEFINE_UNIT(mV, voltage, std::milli)
+DEFINE_UNIT(V, voltage, std::ratio<1>)
+DEFINE_UNIT(kV, voltage, std::kilo)
+
+#undef DEFINE_UNIT
+
 }  // namespace quants
 }  // namespace ferrugo
@@ -15,65 +15,47 @@ namespace detail
 {
 
 template <class T>
-struct i_forward_iterator : i_cloneable<i_forward_iterator<T>>
+struct forward_iterator_vtable_t
 {
-    virtual ~i_forward_iterator() = default;
-
-    virtual T deref() const = 0;
-    virtual void inc() = 0;
-    virtual bool is_equal(const i_forward_iterator& other) const = 0;
+    erased_ops_t ops;
+    T (*deref)(const void*);
+    void (*inc)(void*);
+    bool (*is_equal)(const void*, const void*);
 };
 
-template <class T>
-using i_forward_range = i_range<i_forward_iterator<T>>;
-
 template <class T, class Iter>
-struct forward_iterator_impl : public i_forward_iterator<T>
-{
-    Iter m_it;
-
-    forward_iterator_impl(Iter it) : m_it{ it }
-    {
-    }
-
-    std::unique_ptr<i_forward_iterator<T>> clone() const override
-    {
-        return std::make_unique<forward_iterator_impl>(m_it);
-    }
-
-    T deref() const override
-    {
-        return *m_it;
-    }
+inline constexpr forward_iterator_vtable_t<T> forward_iterator_vtable = {
+    erased_ops_t::of<Iter>(),
+    [](const void* self) -> T { return *erased_object<Iter>(self); },
+    [](void* self) { ++erased_object<Iter>(self); },
+    [](const void* self, const void* other) { return erased_object<Iter>(self) == erased_object<Iter>(other); },
+};
 
-    void inc() override
-    {
-        ++m_it;
-    }
+template <class T>
+using erased_forward_iterator = erased_t<forward_iterator_vtable_t<T>>;
 
-    bool is_equal(const i_forward_iterator<T>& other) const override
-    {
-        return m_it == static_cast<const forward_iterator_impl&>(other).m_it;
-    }
-};
+template <class T>
+using i_forward_range = i_range<erased_forward_iterator<T>>;
 
 template <class T, class Range>
 struct forward_range_impl : public i_forward_range<T>
 {
+    using iterator_type = iterator_t<const Range>;
+
     Range m_range;
 
     forward_range_impl(Range range) : m_range{ std::move(range) }
     {
     }
 
-    std::unique_ptr<i_forward_iterator<T>> begin() const override
+    erased_forward_iterator<T> begin() const override
     {
-        return std::make_unique<forward_iterator_impl<T, iterator_t<Range>>>(std::begin(m_range));
+        return { &forward_iterator_vtable<T, iterator_type>, std::begin(m_range) };
     }
 
-    std::unique_ptr<i_forward_iterator<T>> end() const override
+    erased_forward_iterator<T> end() const override
     {
-        return std::make_unique<forward_iterator_impl<T, iterator_t<Range>>>(std::end(m_range));
+        return { &forward_iterator_vtable<T, iterator_type>, std::end(m_range) };
     }
 };
 
@@ -82,35 +64,27 @@ struct forward_iterable
 {
     struct iter
     {
-        std::unique_ptr<i_forward_iterator<T>> m_it;
+        erased_forward_iterator<T> m_it;
 
         iter() = default;
 
-        iter(std::unique_ptr<i_forward_iterator<T>> it) : m_it{ std::move(it) }
-        {
-        }
-
-        iter(const iter& other) : m_it{ other.m_it ? other.m_it->clone() : nullptr }
-        {
-        }
-
-        iter(iter&& other) : m_it{ std::move(other.m_it) }
+        iter(erased_forward_iterator<T> it) : m_it{ std::move(it) }
         {
         }
 
         T deref() const
         {
-            return m_it->deref();
+            return m_it.vtable()->deref(m_it.get());
         }
 
         void inc()
         {
-            m_it->inc();
+            m_it.vtable()->inc(m_it.get());
         }
 
         bool is_equal(const iter& other) const
         {
-            return m_it->is_equal(*other.m_it);
+            return m_it.vtable()->is_equal(m_it.get(), other.m_it.get());
         }
     };
 
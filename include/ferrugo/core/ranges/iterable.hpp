@@ -1,7 +1,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace ferrugo
 {
@@ -16,15 +20,147 @@ template <class It>
 struct i_range
 {
     virtual ~i_range() = default;
-    virtual std::unique_ptr<It> begin() const = 0;
-    virtual std::unique_ptr<It> end() const = 0;
+    virtual It begin() const = 0;
+    virtual It end() const = 0;
 };
 
-template <class T>
-struct i_cloneable
+inline constexpr std::size_t erased_buffer_size = 32;
+
+template <class U>
+inline constexpr bool erased_inline = sizeof(U) <= erased_buffer_size && alignof(U) <= alignof(std::max_align_t)
+                                      && std::is_nothrow_move_constructible_v<U>;
+
+// The object held in an erased_t buffer: in place when it fits, otherwise behind a pointer stored in place.
+template <class U>
+U& erased_object(void* buffer)
+{
+    if constexpr (erased_inline<U>)
+    {
+        return *std::launder(static_cast<U*>(buffer));
+    }
+    else
+    {
+        return **std::launder(static_cast<U**>(buffer));
+    }
+}
+
+template <class U>
+const U& erased_object(const void* buffer)
+{
+    return erased_object<U>(const_cast<void*>(buffer));
+}
+
+// Lifetime operations of an erased value; the first member of every vtable used with erased_t.
+struct erased_ops_t
+{
+    void (*copy)(void* dst, const void* src);
+    // Moves src into dst and ends the lifetime of src.
+    void (*relocate)(void* dst, void* src) noexcept;
+    void (*destroy)(void* buffer) noexcept;
+
+    template <class U>
+    static constexpr erased_ops_t of()
+    {
+        if constexpr (erased_inline<U>)
+        {
+            return { [](void* dst, const void* src) { ::new (dst) U(erased_object<U>(src)); },
+                     [](void* dst, void* src) noexcept
+                     {
+                         ::new (dst) U(std::move(erased_object<U>(src)));
+                         erased_object<U>(src).~U();
+                     },
+                     [](void* buffer) noexcept { erased_object<U>(buffer).~U(); } };
+        }
+        else
+        {
+            return { [](void* dst, const void* src) { ::new (dst) U*(new U(erased_object<U>(src))); },
+                     [](void* dst, void* src) noexcept { ::new (dst) U*(&erased_object<U>(src)); },
+                     [](void* buffer) noexcept { delete &erased_object<U>(buffer); } };
+        }
+    }
+};
+
+// A copyable type-erased value with a hand-rolled vtable: a static table of function pointers per stored type,
+// whose first member is the erased_ops_t. Values of up to erased_buffer_size bytes are kept inline, so erasing an
+// iterator, and copying it, does not allocate.
+template <class VTable>
+class erased_t
 {
-    virtual ~i_cloneable() = default;
-    virtual std::unique_ptr<T> clone() const = 0;
+public:
+    erased_t() = default;
+
+    template <class U>
+    erased_t(const VTable* vtable, U value) : m_vtable{ vtable }
+    {
+        if constexpr (erased_inline<U>)
+        {
+            ::new (static_cast<void*>(m_buffer)) U(std::move(value));
+        }
+        else
+        {
+            ::new (static_cast<void*>(m_buffer)) U*(new U(std::move(value)));
+        }
+    }
+
+    erased_t(const erased_t& other) : m_vtable{ other.m_vtable }
+    {
+        if (m_vtable)
+        {
+            m_vtable->ops.copy(m_buffer, other.m_buffer);
+        }
+    }
+
+    erased_t(erased_t&& other) noexcept : m_vtable{ std::exchange(other.m_vtable, nullptr) }
+    {
+        if (m_vtable)
+        {
+            m_vtable->ops.relocate(m_buffer, other.m_buffer);
+        }
+    }
+
+    ~erased_t()
+    {
+        reset();
+    }
+
+    erased_t& operator=(erased_t other) noexcept
+    {
+        reset();
+        m_vtable = std::exchange(other.m_vtable, nullptr);
+        if (m_vtable)
+        {
+            m_vtable->ops.relocate(m_buffer, other.m_buffer);
+        }
+        return *this;
+    }
+
+    const VTable* vtable() const
+    {
+        return m_vtable;
+    }
+
+    void* get()
+    {
+        return m_buffer;
+    }
+
+    const void* get() const
+    {
+        return m_buffer;
+    }
+
+private:
+    void reset() noexcept
+    {
+        if (m_vtable)
+        {
+            m_vtable->ops.destroy(m_buffer);
+            m_vtable = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char m_buffer[erased_buffer_size];
+    const VTable* m_vtable = nullptr;
 };
 
 }  // namespace detail
@@ -1,9 +1,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <ferrugo/core/iterator_interface.hpp>
 #include <ferrugo/core/range_interface.hpp>
 #include <ferrugo/core/ranges/iterable.hpp>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 namespace ferrugo
 {
@@ -15,65 +20,95 @@ namespace detail
 {
 
 template <class T>
-struct i_random_access_iterator : i_cloneable<i_random_access_iterator<T>>
+struct random_access_iterator_vtable_t
 {
-    virtual ~i_random_access_iterator() = default;
+    erased_ops_t ops;
+    T (*deref)(const void*);
+    std::ptrdiff_t (*distance_to)(const void*, const void*);
+    void (*advance)(void*, std::ptrdiff_t);
+};
 
-    virtual T deref() const = 0;
-    virtual std::ptrdiff_t distance_to(const i_random_access_iterator& other) const = 0;
-    virtual void advance(std::ptrdiff_t offset) = 0;
+template <class T, class Iter>
+inline constexpr random_access_iterator_vtable_t<T> random_access_iterator_vtable = {
+    erased_ops_t::of<Iter>(),
+    [](const void* self) -> T { return *erased_object<Iter>(self); },
+    [](const void* self, const void* other) -> std::ptrdiff_t
+    { return std::distance(erased_object<Iter>(self), erased_object<Iter>(other)); },
+    [](void* self, std::ptrdiff_t offset) { std::advance(erased_object<Iter>(self), offset); },
 };
 
 template <class T>
-using i_random_access_range = i_range<i_random_access_iterator<T>>;
+using erased_random_access_iterator = erased_t<random_access_iterator_vtable_t<T>>;
 
-template <class T, class Iter>
-struct random_access_iterator_impl : public i_random_access_iterator<T>
+// Besides iterators, the range hands out its elements in bulk, so that algorithms can work on plain pointers instead
+// of paying a call per element.
+template <class T>
+struct i_random_access_range : i_range<erased_random_access_iterator<T>>
 {
-    Iter m_it;
+    using value_type = std::remove_cvref_t<T>;
 
-    random_access_iterator_impl(Iter it) : m_it{ it }
-    {
-    }
+    virtual std::ptrdiff_t size() const = 0;
+    // The elements from `offset` to the end if they are stored contiguously as value_type; empty otherwise.
+    virtual std::span<const value_type> segment(std::ptrdiff_t offset) const = 0;
+    // Copies the elements [offset, offset + n) to out.
+    virtual void copy_out(std::ptrdiff_t offset, std::ptrdiff_t n, value_type* out) const = 0;
+};
 
-    std::unique_ptr<i_random_access_iterator<T>> clone() const override
-    {
-        return std::make_unique<random_access_iterator_impl>(m_it);
-    }
+template <class T, class Range>
+struct random_access_range_impl : public i_random_access_range<T>
+{
+    using iterator_type = iterator_t<const Range>;
+    using value_type = std::remove_cvref_t<T>;
 
-    T deref() const override
+    static constexpr bool is_contiguous
+        = std::contiguous_iterator<iterator_type> && std::is_same_v<std::iter_value_t<iterator_type>, value_type>;
+
+    Range range_;
+
+    random_access_range_impl(Range range) : range_{ std::move(range) }
     {
-        return *m_it;
     }
 
-    std::ptrdiff_t distance_to(const i_random_access_iterator<T>& other) const override
+    erased_random_access_iterator<T> begin() const override
     {
-        return std::distance(m_it, static_cast<const random_access_iterator_impl&>(other).m_it);
+        return { &random_access_iterator_vtable<T, iterator_type>, std::begin(range_) };
     }
 
-    void advance(std::ptrdiff_t offset) override
+    erased_random_access_iterator<T> end() const override
     {
-        std::advance(m_it, offset);
+        return { &random_access_iterator_vtable<T, iterator_type>, std::end(range_) };
     }
-};
-
-template <class T, class Range>
-struct random_access_range_impl : public i_random_access_range<T>
-{
-    Range range_;
 
-    random_access_range_impl(Range range) : range_{ std::move(range) }
+    std::ptrdiff_t size() const override
     {
+        return std::distance(std::begin(range_), std::end(range_));
     }
 
-    std::unique_ptr<i_random_access_iterator<T>> begin() const override
+    std::span<const value_type> segment(std::ptrdiff_t offset) const override
     {
-        return std::make_unique<random_access_iterator_impl<T, iterator_t<Range>>>(std::begin(range_));
+        const auto count = size();
+        if (offset < 0 || offset > count)
+        {
+            throw std::out_of_range{ "index out of range" };
+        }
+        if constexpr (is_contiguous)
+        {
+            return std::span<const value_type>{ std::to_address(std::begin(range_)), static_cast<std::size_t>(count) }
+                .subspan(static_cast<std::size_t>(offset));
+        }
+        else
+        {
+            return {};
+        }
     }
 
-    std::unique_ptr<i_random_access_iterator<T>> end() const override
+    void copy_out(std::ptrdiff_t offset, std::ptrdiff_t n, value_type* out) const override
     {
-        return std::make_unique<random_access_iterator_impl<T, iterator_t<Range>>>(std::end(range_));
+        if (offset < 0 || n < 0 || n > size() - offset)
+        {
+            throw std::out_of_range{ "index out of range" };
+        }
+        std::copy_n(std::next(std::begin(range_), offset), n, out);
     }
 };
 
@@ -82,35 +117,27 @@ struct random_access_iterable
 {
     struct iter
     {
-        std::unique_ptr<i_random_access_iterator<T>> m_it;
+        erased_random_access_iterator<T> m_it;
 
         iter() = default;
 
-        iter(std::unique_ptr<i_random_access_iterator<T>> it) : m_it{ std::move(it) }
-        {
-        }
-
-        iter(const iter& other) : m_it{ other.m_it ? other.m_it->clone() : nullptr }
-        {
-        }
-
-        iter(iter&& other) : m_it{ std::move(other.m_it) }
+        iter(erased_random_access_iterator<T> it) : m_it{ std::move(it) }
         {
         }
 
         T deref() const
         {
-            return m_it->deref();
+            return m_it.vtable()->deref(m_it.get());
         }
 
         std::ptrdiff_t distance_to(const iter& other) const
         {
-            return m_it->distance_to(*other.m_it);
+            return m_it.vtable()->distance_to(m_it.get(), other.m_it.get());
         }
 
         void advance(std::ptrdiff_t offset)
         {
-            m_it->advance(offset);
+            m_it.vtable()->advance(m_it.get(), offset);
         }
     };
 
@@ -145,6 +172,62 @@ struct random_access_iterable : range_interface<detail::random_access_iterable<T
 {
     using base_type = range_interface<detail::random_access_iterable<T>>;
     using base_type::base_type;
+
+    using value_type = std::remove_cvref_t<T>;
+    using segment_type = std::span<const value_type>;
+
+    typename base_type::size_type size() const
+    {
+        return impl().size();
+    }
+
+    // The elements from `offset` to the end, without copying, if the erased range stores them contiguously (e.g. a
+    // std::vector or std::array); empty otherwise. Throws std::out_of_range unless 0 <= offset <= size().
+    segment_type segment(typename base_type::difference_type offset = 0) const
+    {
+        return impl().segment(offset);
+    }
+
+    // Throws std::out_of_range unless [offset, offset + n) lies within the range.
+    void copy_out(typename base_type::difference_type offset, typename base_type::difference_type n, value_type* out) const
+    {
+        impl().copy_out(offset, n, out);
+    }
+
+    // Calls fn(segment_type) on consecutive segments covering the range: the range itself when it is contiguous,
+    // otherwise chunks of at most chunk_size elements copied to a buffer.
+    template <class Fn>
+    void for_each_segment(Fn&& fn, std::size_t chunk_size = 4096) const
+    {
+        if (chunk_size == 0)
+        {
+            throw std::invalid_argument{ "for_each_segment: chunk_size must be positive" };
+        }
+        const auto count = size();
+        if (count == 0)
+        {
+            return;
+        }
+        if (const auto whole = segment(); !whole.empty())
+        {
+            fn(whole);
+            return;
+        }
+        std::vector<value_type> buffer(std::min(chunk_size, static_cast<std::size_t>(count)));
+        for (std::ptrdiff_t offset = 0; offset < count;)
+        {
+            const auto n = std::min(static_cast<std::ptrdiff_t>(buffer.size()), count - offset);
+            copy_out(offset, n, buffer.data());
+            fn(segment_type{ buffer.data(), static_cast<std::size_t>(n) });
+            offset += n;
+        }
+    }
+
+private:
+    const detail::i_random_access_range<T>& impl() const
+    {
+        return *this->get_impl().m_impl;
+    }
 };
 
 }  // namespace core
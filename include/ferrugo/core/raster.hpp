@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ferrugo/core/ansi.hpp>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ferrugo
+{
+namespace core
+{
+
+// A read-only view of pixels stored row after row.
+template <class T>
+struct image_ref_t
+{
+    explicit image_ref_t(const T* ptr, extent_t e, std::size_t row_stride)
+        : m_ptr{ ptr }
+        , m_extent{ e }
+        , m_row_stride{ row_stride }
+    {
+    }
+
+    explicit image_ref_t(const T* ptr, extent_t e) : image_ref_t{ ptr, e, static_cast<std::size_t>(e.width) }
+    {
+    }
+
+    const T* row(int y) const
+    {
+        return m_ptr + m_row_stride * y;
+    }
+
+    const T* m_ptr;
+    extent_t m_extent;
+    std::size_t m_row_stride;
+};
+
+namespace detail
+{
+
+// Bit i is set for each value in [row, row + n) above the threshold; n <= 64.
+inline std::uint64_t threshold_mask(const float* row, int n, float threshold)
+{
+    std::uint64_t result = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    const auto t8 = _mm256_set1_ps(threshold);
+    for (; i + 8 <= n; i += 8)
+    {
+        const auto mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row + i), t8, _CMP_GT_OQ));
+        result |= static_cast<std::uint64_t>(mask) << i;
+    }
+#endif
+#if defined(__SSE2__)
+    const auto t4 = _mm_set1_ps(threshold);
+    for (; i + 4 <= n; i += 4)
+    {
+        const auto mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(row + i), t4));
+        result |= static_cast<std::uint64_t>(mask) << i;
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        result |= static_cast<std::uint64_t>(row[i] > threshold) << i;
+    }
+    return result;
+}
+
+// Maps values in [0, 1] to the nearest of `levels` steps, clamping the rest (NaN gives 0).
+inline void quantize(const float* row, int n, int levels, std::uint8_t* out)
+{
+    const float scale = static_cast<float>(levels - 1);
+    int i = 0;
+#if defined(__SSE2__)
+    const auto s = _mm_set1_ps(scale);
+    const auto half = _mm_set1_ps(0.5F);
+    const auto zero = _mm_setzero_ps();
+    const auto level = [&](const float* p)
+    { return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p), s), half), zero), s)); };
+    for (; i + 8 <= n; i += 8)
+    {
+        const auto packed = _mm_packus_epi16(_mm_packs_epi32(level(row + i), level(row + i + 4)), _mm_setzero_si128());
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        const float v = row[i] * scale + 0.5F;
+        out[i] = static_cast<std::uint8_t>(v > 0.F ? std::min(v, scale) : 0.F);
+    }
+}
+
+// Clips `dirty`, in pixels, to the image and returns the cells covering it, clipped to the area.
+inline bounds_t dirty_cells(bounds_t dirty, extent_t image, extent_t area, extent_t cell)
+{
+    const auto pixels = clip(dirty, image);
+    const int x0 = pixels.location.x / cell.width;
+    const int y0 = pixels.location.y / cell.height;
+    const int x1 = (pixels.location.x + pixels.extent.width + cell.width - 1) / cell.width;
+    const int y1 = (pixels.location.y + pixels.extent.height + cell.height - 1) / cell.height;
+    return clip(bounds_t{ { x0, y0 }, { x1 - x0, y1 - y0 } }, area);
+}
+
+}  // namespace detail
+
+inline constexpr bounds_t whole_image = { { 0, 0 }, { std::numeric_limits<int>::max(), std::numeric_limits<int>::max() } };
+
+// Box filter: each output pixel is the mean of a factor_x by factor_y block; a partial block at the right or bottom
+// edge is left out. Returns the extent written to `out`, whose rows are packed.
+inline extent_t downsample(const image_ref_t<float>& image, int factor_x, int factor_y, float* out)
+{
+    if (factor_x <= 0 || factor_y <= 0)
+    {
+        throw std::invalid_argument{ "downsample: factors must be positive" };
+    }
+    const extent_t result{ image.m_extent.width / factor_x, image.m_extent.height / factor_y };
+    const int width = result.width * factor_x;
+    const float scale = 1.F / static_cast<float>(factor_x * factor_y);
+    std::vector<float> sums(static_cast<std::size_t>(width));
+    for (int y = 0; y < result.height; ++y)
+    {
+        std::fill(sums.begin(), sums.end(), 0.F);
+        for (int dy = 0; dy < factor_y; ++dy)
+        {
+            const float* row = image.row(y * factor_y + dy);
+            int x = 0;
+#if defined(__SSE2__)
+            for (; x + 4 <= width; x += 4)
+            {
+                _mm_storeu_ps(sums.data() + x, _mm_add_ps(_mm_loadu_ps(sums.data() + x), _mm_loadu_ps(row + x)));
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                sums[x] += row[x];
+            }
+        }
+        float* out_row = out + static_cast<std::size_t>(y) * result.width;
+        if (factor_x == 2)
+        {
+            int x = 0;
+#if defined(__SSE2__)
+            const auto s = _mm_set1_ps(scale);
+            for (; x + 4 <= result.width; x += 4)
+            {
+                const auto a = _mm_loadu_ps(sums.data() + 2 * x);
+                const auto b = _mm_loadu_ps(sums.data() + 2 * x + 4);
+                const auto even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                const auto odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out_row + x, _mm_mul_ps(_mm_add_ps(even, odd), s));
+            }
+#endif
+            for (; x < result.width; ++x)
+            {
+                out_row[x] = (sums[2 * x] + sums[2 * x + 1]) * scale;
+            }
+            continue;
+        }
+        for (int x = 0; x < result.width; ++x)
+        {
+            float sum = 0.F;
+            for (int dx = 0; dx < factor_x; ++dx)
+            {
+                sum += sums[x * factor_x + dx];
+            }
+            out_row[x] = sum * scale;
+        }
+    }
+    return result;
+}
+
+// Braille patterns, 2x4 pixels per cell: a dot for each pixel above the threshold, drawn in `style`. Only the cells
+// covering `dirty` (in pixels) are written; cells without dots are left blank.
+inline void rasterize_braille(
+    const image_ref_t<float>& image,
+    float threshold,
+    const glyph_style_t& style,
+    const area_t::mut_ref_type& dst,
+    bounds_t dirty = whole_image)
+{
+    // Dot bits of the left and right pixel of each row, indexed by the two threshold bits of the pair.
+    static constexpr std::array<std::array<std::uint8_t, 4>, 4> dots = { {
+        { 0x00, 0x01, 0x08, 0x09 },
+        { 0x00, 0x02, 0x10, 0x12 },
+        { 0x00, 0x04, 0x20, 0x24 },
+        { 0x00, 0x40, 0x80, 0xC0 },
+    } };
+
+    const auto cells = detail::dirty_cells(dirty, image.m_extent, dst.m_extent, extent_t{ 2, 4 });
+    const std::uint16_t style_index = dst.m_styles->intern(style);
+    const int cx0 = cells.location.x;
+    const int cx1 = cx0 + cells.extent.width;
+    for (int cy = cells.location.y; cy < cells.location.y + cells.extent.height; ++cy)
+    {
+        cell_t* out = dst.row(cy).data();
+        // 32 cells, i.e. 64 pixels, at a time
+        for (int cx = cx0; cx < cx1; cx += 32)
+        {
+            const int count = std::min(32, cx1 - cx);
+            const int pixels = std::max(std::min(2 * count, image.m_extent.width - 2 * cx), 0);
+            std::array<std::uint64_t, 4> masks{};
+            for (int r = 0; r < 4; ++r)
+            {
+                const int y = 4 * cy + r;
+                if (y < image.m_extent.height)
+                {
+                    masks[r] = detail::threshold_mask(image.row(y) + 2 * cx, pixels, threshold);
+                }
+            }
+            for (int k = 0; k < count; ++k)
+            {
+                const int code = dots[0][masks[0] >> 2 * k & 3] | dots[1][masks[1] >> 2 * k & 3]
+                                 | dots[2][masks[2] >> 2 * k & 3] | dots[3][masks[3] >> 2 * k & 3];
+                out[cx + k].m_code_point = code != 0 ? 0x2800 + code : U' ';
+                out[cx + k].m_style = style_index;
+            }
+        }
+    }
+}
+
+// Upper half blocks, 1x2 pixels per cell: the top pixel in the foreground and the bottom one in the background
+// color. Values in [0, 1] pick from `colormap` (at most 64 colors, so that every pair of them can be interned).
+inline void rasterize_half_blocks(
+    const image_ref_t<float>& image,
+    std::span<const true_color_t> colormap,
+    const area_t::mut_ref_type& dst,
+    bounds_t dirty = whole_image)
+{
+    if (colormap.empty() || colormap.size() > 64)
+    {
+        throw std::invalid_argument{ "rasterize_half_blocks: 1 to 64 colors expected" };
+    }
+    const int levels = static_cast<int>(colormap.size());
+    const auto cells = detail::dirty_cells(dirty, image.m_extent, dst.m_extent, extent_t{ 1, 2 });
+    const int cx0 = cells.location.x;
+    const int width = std::min(cells.extent.width, image.m_extent.width - cx0);
+
+    std::vector<std::int32_t> pair_styles(colormap.size() * colormap.size(), -1);
+    const auto style_of = [&](int top, int bottom)
+    {
+        auto& index = pair_styles[top * levels + bottom];
+        if (index < 0)
+        {
+            index = dst.m_styles->intern(glyph_style_t{ colormap[top], colormap[bottom] });
+        }
+        return static_cast<std::uint16_t>(index);
+    };
+
+    std::vector<std::uint8_t> top(static_cast<std::size_t>(std::max(width, 0)));
+    std::vector<std::uint8_t> bottom(top.size());
+    for (int cy = cells.location.y; cy < cells.location.y + cells.extent.height; ++cy)
+    {
+        detail::quantize(image.row(2 * cy) + cx0, width, levels, top.data());
+        if (2 * cy + 1 < image.m_extent.height)
+        {
+            detail::quantize(image.row(2 * cy + 1) + cx0, width, levels, bottom.data());
+        }
+        else
+        {
+            std::fill(bottom.begin(), bottom.end(), std::uint8_t{ 0 });
+        }
+        cell_t* out = dst.row(cy).data() + cx0;
+        for (int x = 0; x < width; ++x)
+        {
+            out[x].m_code_point = U'▀';
+            out[x].m_style = style_of(top[x], bottom[x]);
+        }
+    }
+}
+
+// As above, with the colors taken from the pixels. Every distinct pair of colors takes a place in the area's style
+// table, so this suits charts drawn with a limited set of colors; quantize photographs first.
+inline void rasterize_half_blocks(
+    const image_ref_t<true_color_t>& image, const area_t::mut_ref_type& dst, bounds_t dirty = whole_image)
+{
+    const auto cells = detail::dirty_cells(dirty, image.m_extent, dst.m_extent, extent_t{ 1, 2 });
+    const int cx0 = cells.location.x;
+    const int width = std::min(cells.extent.width, image.m_extent.width - cx0);
+    const true_color_t black{};
+    for (int cy = cells.location.y; cy < cells.location.y + cells.extent.height; ++cy)
+    {
+        const true_color_t* top = image.row(2 * cy) + cx0;
+        const true_color_t* bottom = 2 * cy + 1 < image.m_extent.height ? image.row(2 * cy + 1) + cx0 : nullptr;
+        cell_t* out = dst.row(cy).data() + cx0;
+        std::uint16_t style = 0;
+        for (int x = 0; x < width; ++x)
+        {
+            const true_color_t& b = bottom ? bottom[x] : black;
+            if (x == 0 || top[x] != top[x - 1] || b != (bottom ? bottom[x - 1] : black))
+            {
+                style = dst.m_styles->intern(glyph_style_t{ top[x], b });
+            }
+            out[x].m_code_point = U'▀';
+            out[x].m_style = style;
+        }
+    }
+}
+
+}  // namespace core
+}  // namespace ferrugo
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ferrugo
+{
+namespace core
+{
+
+// A fixed set of worker threads for fork-join loops, started once so that per-frame work does not pay for thread
+// creation. The calling thread takes part in every loop.
+class thread_pool_t
+{
+public:
+    explicit thread_pool_t(std::size_t thread_count = std::max(std::thread::hardware_concurrency(), 1U))
+    {
+        for (std::size_t n = 1; n < thread_count; ++n)
+        {
+            m_workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    thread_pool_t(const thread_pool_t&) = delete;
+    thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+    ~thread_pool_t()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_job_cv.notify_all();
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    // Including the calling thread
+    std::size_t size() const
+    {
+        return m_workers.size() + 1;
+    }
+
+    // Calls fn(i) for every i in [0, count) and returns once all calls are done. If any of them throws, the remaining
+    // indices are skipped and the first exception is rethrown. Called from within fn, the loop runs on the calling
+    // thread alone.
+    template <class Fn>
+    void parallel_for(std::size_t count, Fn&& fn)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        if (count == 1 || m_workers.empty() || inside_job())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                fn(i);
+            }
+            return;
+        }
+
+        using fn_type = std::remove_reference_t<Fn>;
+        job_t job{ [](void* f, std::size_t i) { (*static_cast<fn_type*>(f))(i); }, &fn, count };
+
+        std::lock_guard<std::mutex> submit_lock{ m_submit_mutex };
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_job = &job;
+            ++m_generation;
+        }
+        m_job_cv.notify_all();
+        run(job);
+        {
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            m_job = nullptr;
+            m_idle_cv.wait(lock, [&]() { return m_busy == 0; });
+        }
+        if (job.error)
+        {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct job_t
+    {
+        void (*invoke)(void*, std::size_t);
+        void* fn;
+        std::size_t count;
+        std::atomic<std::size_t> next = 0;
+        std::mutex error_mutex = {};
+        std::exception_ptr error = {};
+    };
+
+    static bool& inside_job()
+    {
+        thread_local bool result = false;
+        return result;
+    }
+
+    static void run(job_t& job)
+    {
+        inside_job() = true;
+        for (std::size_t i = job.next++; i < job.count; i = job.next++)
+        {
+            try
+            {
+                job.invoke(job.fn, i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{ job.error_mutex };
+                if (!job.error)
+                {
+                    job.error = std::current_exception();
+                }
+                job.next = job.count;
+            }
+        }
+        inside_job() = false;
+    }
+
+    void work()
+    {
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        while (true)
+        {
+            m_job_cv.wait(lock, [&]() { return m_stop || (m_job && m_generation != seen); });
+            if (m_stop)
+            {
+                return;
+            }
+            seen = m_generation;
+            job_t* job = m_job;
+            ++m_busy;
+            lock.unlock();
+            run(*job);
+            lock.lock();
+            if (--m_busy == 0)
+            {
+                m_idle_cv.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_submit_mutex;
+    std::mutex m_mutex;
+    std::condition_variable m_job_cv;
+    std::condition_variable m_idle_cv;
+    job_t* m_job = nullptr;
+    std::uint64_t m_generation = 0;
+    std::size_t m_busy = 0;
+    bool m_stop = false;
+};
+
+}  // namespace core
+}  // namespace ferrugo
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ferrugo
+{
+namespace core
+{
+
+// UTF-8 as specified by RFC 3629: at most 4 bytes, no overlong forms, no surrogates, nothing above U+10FFFF. None of
+// the functions below depend on the C locale.
+
+static constexpr inline char32_t replacement_character = U'�';
+
+namespace detail
+{
+
+// First byte in [b, e) with the high bit set, i.e. the end of the ASCII prefix.
+inline const char* find_non_ascii(const char* b, const char* e)
+{
+#if defined(__AVX2__)
+    for (; e - b >= 32; b += 32)
+    {
+        const auto mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b))));
+        if (mask != 0)
+        {
+            return b + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; e - b >= 16; b += 16)
+    {
+        const auto mask
+            = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b))));
+        if (mask != 0)
+        {
+            return b + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; b != e; ++b)
+    {
+        if (static_cast<unsigned char>(*b) >= 0x80)
+        {
+            return b;
+        }
+    }
+    return e;
+}
+
+// Widens an ASCII run to code points, a register at a time.
+inline char32_t* widen_ascii(const char* b, const char* e, char32_t* out)
+{
+#if defined(__SSE2__)
+    const auto zero = _mm_setzero_si128();
+    for (; e - b >= 16; b += 16, out += 16)
+    {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        const auto lo = _mm_unpacklo_epi8(v, zero);
+        const auto hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+#endif
+    for (; b != e; ++b, ++out)
+    {
+        *out = static_cast<unsigned char>(*b);
+    }
+    return out;
+}
+
+}  // namespace detail
+
+enum class utf8_status
+{
+    ok,
+    invalid,
+    incomplete,
+};
+
+struct utf8_decode_result
+{
+    char32_t code_point;
+    std::size_t size;  // bytes consumed; 1 when invalid, so that decoding can resume after the offending byte
+    utf8_status status;
+};
+
+// Decodes the code point at the start of [b, e), which must not be empty.
+inline utf8_decode_result utf8_decode(const char* b, const char* e)
+{
+    const auto byte = [&](std::size_t n) { return static_cast<std::uint8_t>(b[n]); };
+    const std::uint8_t lead = byte(0);
+    if (lead < 0x80)
+    {
+        return { lead, 1, utf8_status::ok };
+    }
+
+    std::size_t size = 0;
+    char32_t result = 0;
+    char32_t min = 0;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        size = 2;
+        result = lead & 0x1F;
+        min = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        size = 3;
+        result = lead & 0x0F;
+        min = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        size = 4;
+        result = lead & 0x07;
+        min = 0x10000;
+    }
+    else
+    {
+        return { replacement_character, 1, utf8_status::invalid };
+    }
+
+    const auto available = static_cast<std::size_t>(e - b);
+    for (std::size_t n = 1; n < size; ++n)
+    {
+        if (n == available)
+        {
+            return { replacement_character, 1, utf8_status::incomplete };
+        }
+        if ((byte(n) & 0xC0) != 0x80)
+        {
+            return { replacement_character, 1, utf8_status::invalid };
+        }
+        result = (result << 6) | (byte(n) & 0x3F);
+    }
+    if (result < min || result > 0x10FFFF || (0xD800 <= result && result <= 0xDFFF))
+    {
+        return { replacement_character, 1, utf8_status::invalid };
+    }
+    return { result, size, utf8_status::ok };
+}
+
+// Size of the encoding of a scalar value.
+inline constexpr std::size_t utf8_size(char32_t ch)
+{
+    return ch < 0x80 ? 1 : ch < 0x800 ? 2 : ch < 0x10000 ? 3 : 4;
+}
+
+// Writes the encoding of ch to out (room for 4 bytes) and returns its size, or 0 if ch is not a scalar value.
+inline std::size_t utf8_encode(char32_t ch, char* out)
+{
+    if (ch < 0x80)
+    {
+        out[0] = static_cast<char>(ch);
+        return 1;
+    }
+    if (ch < 0x800)
+    {
+        out[0] = static_cast<char>(0xC0 | (ch >> 6));
+        out[1] = static_cast<char>(0x80 | (ch & 0x3F));
+        return 2;
+    }
+    if (0xD800 <= ch && ch <= 0xDFFF)
+    {
+        return 0;
+    }
+    if (ch < 0x10000)
+    {
+        out[0] = static_cast<char>(0xE0 | (ch >> 12));
+        out[1] = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (ch & 0x3F));
+        return 3;
+    }
+    if (ch <= 0x10FFFF)
+    {
+        out[0] = static_cast<char>(0xF0 | (ch >> 18));
+        out[1] = static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (ch & 0x3F));
+        return 4;
+    }
+    return 0;
+}
+
+// Start of the first malformed sequence in text, or its end if text is valid UTF-8.
+inline const char* utf8_find_invalid(std::string_view text)
+{
+    const char* b = text.data();
+    const char* e = b + text.size();
+    while (true)
+    {
+        b = detail::find_non_ascii(b, e);
+        if (b == e)
+        {
+            return e;
+        }
+        const auto decoded = utf8_decode(b, e);
+        if (decoded.status != utf8_status::ok)
+        {
+            return b;
+        }
+        b += decoded.size;
+    }
+}
+
+inline bool utf8_valid(std::string_view text)
+{
+    return utf8_find_invalid(text) == text.data() + text.size();
+}
+
+// Decodes text, replacing each malformed byte with U+FFFD.
+inline std::u32string utf8_to_u32(std::string_view text)
+{
+    std::u32string result(text.size(), U'\0');
+    const char* b = text.data();
+    const char* e = b + text.size();
+    char32_t* out = result.data();
+    while (b != e)
+    {
+        const char* ascii_end = detail::find_non_ascii(b, e);
+        out = detail::widen_ascii(b, ascii_end, out);
+        b = ascii_end;
+        if (b != e)
+        {
+            const auto decoded = utf8_decode(b, e);
+            *out++ = decoded.code_point;
+            b += decoded.size;
+        }
+    }
+    result.resize(static_cast<std::size_t>(out - result.data()));
+    return result;
+}
+
+// Encodes text, replacing code points which are not scalar values with U+FFFD.
+inline std::string u32_to_utf8(std::u32string_view text)
+{
+    std::string result(text.size() * 4, '\0');
+    char* out = result.data();
+    for (const char32_t ch : text)
+    {
+        const std::size_t size = utf8_encode(ch, out);
+        out += size != 0 ? size : utf8_encode(replacement_character, out);
+    }
+    result.resize(static_cast<std::size_t>(out - result.data()));
+    return result;
+}
+
+}  // namespace core
+}  // namespace ferrugo
@@ -10,6 +10,7 @@
 #include <ferrugo/core/overloaded.hpp>
 #include <ferrugo/core/pipeline.hpp>
 #include <ferrugo/core/predicates.hpp>
+#include <ferrugo/core/presenter.hpp>
 #include <ferrugo/core/quantities.hpp>
 #include <ferrugo/core/ranges.hpp>
 #include <ferrugo/core/type_name.hpp>
@@ -31,20 +32,20 @@ void loop(
     std::function<void(ferrugo::core::area_t::mut_ref_type&)> render,
     std::function<void()> update)
 {
-    for (int i = 0; i < 20; ++i)
-    {
-        update();
-        ferrugo::core::area_t::mut_ref_type ref = area.mut_ref();
-        ref.fill(ferrugo::core::glyph_t{});
-        render(ref);
-
-        std::stringstream ss;
-        ferrugo::core::buffer_t buffer{ ss };
-        ferrugo::core::output(area.ref(), buffer);
-        std::cout << "\033[2J\033[;H" << ss.str() << std::flush;
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    ferrugo::core::presenter_config_t config{};
+    config.update_step = std::chrono::milliseconds(50);
+    config.color_depth = ferrugo::core::color_depth_from_environment();
+    ferrugo::core::presenter_t presenter{ area.m_extent,
+                                          [&](std::chrono::nanoseconds) { update(); },
+                                          [&](const ferrugo::core::area_t::mut_ref_type& ref)
+                                          {
+                                              auto r = ref;
+                                              render(r);
+                                          },
+                                          config };
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    presenter.stop();
+    std::cout << "\033[m\033[" << area.m_extent.height + 1 << ";1H" << presenter.stats() << std::flush;
 }
 
 void run()
@@ -0,0 +1,445 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ferrugo/core/ansi.hpp>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+namespace
+{
+
+void text(core::area_t& area, core::location_t loc, const std::string& str, const core::glyph_style_t& style = {})
+{
+    const core::multibyte_string chars{ str };
+    for (std::size_t i = 0; i < chars.size(); ++i)
+    {
+        area.mut_ref()[core::location_t{ loc.x + static_cast<int>(i), loc.y }] = core::glyph_t{ chars[i], style };
+    }
+}
+
+}  // namespace
+
+TEST_CASE("diff_renderer_t - emits only changed cells", "[ansi]")
+{
+    core::area_t area{ { 16, 4 } };
+    core::diff_renderer_t renderer{};
+
+    text(area, { 0, 0 }, "abc");
+    REQUIRE_THAT(renderer.render(area.ref()), matchers::equal_to(std::string{ "\033[m\033[2J\033[1;1Habc" }));
+
+    REQUIRE_THAT(renderer.render(area.ref()), matchers::equal_to(std::string{}));
+
+    text(area, { 5, 2 }, "x");
+    text(area, { 12, 2 }, "y");
+    REQUIRE_THAT(renderer.render(area.ref()), matchers::equal_to(std::string{ "\033[3;6Hx\033[6Cy" }));
+
+    // A short unchanged gap in the current style is cheaper to write again than to skip.
+    text(area, { 0, 3 }, "p");
+    text(area, { 2, 3 }, "q");
+    REQUIRE_THAT(renderer.render(area.ref()), matchers::equal_to(std::string{ "\033[4;1Hp q" }));
+
+    renderer.invalidate();
+    REQUIRE(renderer.render(area.ref()).find("\033[2J") != std::string::npos);
+
+    core::area_t resized{ { 8, 2 } };
+    text(resized, { 7, 1 }, "z");
+    REQUIRE_THAT(renderer.render(resized.ref()), matchers::equal_to(std::string{ "\033[m\033[2J\033[2;8Hz" }));
+}
+
+TEST_CASE("diff_renderer_t - coalesces style changes", "[ansi]")
+{
+    core::area_t area{ { 4, 2 } };
+    core::diff_renderer_t renderer{};
+    renderer.render(area.ref());
+
+    const core::glyph_style_t style
+        = core::fg(core::true_color_t{ 255, 128, 0 }) | core::bg(core::basic_color_t::blue) | core::mode::bold;
+    text(area, { 0, 0 }, "ab", style);
+    text(area, { 2, 0 }, "c", core::glyph_style_t{} | core::mode::bold);
+    REQUIRE_THAT(
+        renderer.render(area.ref()),
+        matchers::equal_to(std::string{ "\033[1;1H\033[1;38;2;255;128;0;104mab\033[39;49mc" }));
+
+    area.mut_ref()[core::location_t{ 0, 0 }] = core::glyph_t{ 'a', core::glyph_style_t{} | core::mode::dim };
+    area.mut_ref()[core::location_t{ 1, 0 }] = core::glyph_t{ 'b', core::glyph_style_t{} | core::mode::bold };
+    // 22 turns off bold as well, so bold is set again after it.
+    REQUIRE_THAT(
+        renderer.render(area.ref()), matchers::equal_to(std::string{ "\033[1;1H\033[22;2ma\033[22;1mb" }));
+}
+
+TEST_CASE("buffer_t - escape sequences", "[ansi]")
+{
+    core::buffer_t buffer{};
+    buffer.set_style(core::fg(core::palette_color_t{ 208 }) | core::bg(core::basic_color_t::dark_red));
+    buffer.set_style(core::fg(core::palette_color_t{ 208 }) | core::bg(core::basic_color_t::dark_red));
+    buffer.set_style(core::glyph_style_t{} | core::mode::underline | core::mode::double_underline);
+    buffer.set_style(core::glyph_style_t{} | core::mode::double_underline);
+    buffer.move_to(core::location_t{ 1023, 299 });
+    buffer.move_right(1);
+    buffer.move_right(12);
+    REQUIRE_THAT(
+        buffer.view(),
+        matchers::equal_to(std::string_view{ "\033[38;5;208;41m\033[4;21;39;49m\033[24;21m\033[300;1024H\033[C\033[12C" }));
+
+    std::ostringstream os;
+    {
+        core::buffer_t stream_buffer{ os };
+        stream_buffer.write(core::character_t{ 'x' });
+        REQUIRE(os.str().empty());
+    }
+    REQUIRE_THAT(os.str(), matchers::equal_to(std::string{ "x" }));
+}
+
+TEST_CASE("cell_t - packs glyphs with interned styles", "[ansi]")
+{
+    STATIC_REQUIRE(sizeof(core::cell_t) == 8);
+
+    const auto style = core::glyph_style_t{ core::true_color_t{ 1, 2, 3 }, core::basic_color_t::dark_cyan }
+                       | core::mode::bold | core::mode::double_underline;
+    const core::glyph_t glyph{ core::character_t{ U'☢' }, style };
+    core::area_t area{ { 1, 1 } };
+    core::style_table_t& styles = *area.m_styles;
+    const core::cell_t cell = styles.cell(glyph);
+    REQUIRE(cell.m_code_point == U'☢');
+    REQUIRE(styles.glyph(cell) == glyph);
+    REQUIRE(styles.cell(glyph).m_style == cell.m_style);
+    REQUIRE(styles.cell(core::glyph_t{}).m_style == 0);
+    REQUIRE(styles.cell(core::glyph_t{ 'x', core::glyph_style_t{} | core::fg(core::palette_color_t{ 7 }) }).m_style
+            != cell.m_style);
+}
+
+TEST_CASE("area_t - writes through packed cells", "[ansi]")
+{
+    core::area_t area{ { 4, 2 } };
+    const auto style = core::glyph_style_t{} | core::fg(core::true_color_t{ 255, 0, 0 });
+    auto ref = area.mut_ref();
+
+    ref.fill(core::glyph_t{ '.', style });
+    REQUIRE(area.ref()[core::location_t{ 3, 1 }] == (core::glyph_t{ '.', style }));
+
+    ref[core::location_t{ 1, 0 }].character = core::character_t{ U'ł' };
+    REQUIRE(area.ref()[core::location_t{ 1, 0 }] == (core::glyph_t{ core::character_t{ U'ł' }, style }));
+
+    ref[core::location_t{ 1, 0 }].style = core::glyph_style_t{};
+    REQUIRE(area.ref()[core::location_t{ 1, 0 }] == (core::glyph_t{ core::character_t{ U'ł' } }));
+
+    ref[core::location_t{ 2, 1 }] = ref[core::location_t{ 1, 0 }];
+    REQUIRE(area.ref()[core::location_t{ 2, 1 }] == (core::glyph_t{ core::character_t{ U'ł' } }));
+    REQUIRE(static_cast<core::glyph_style_t>(ref[core::location_t{ 0, 0 }].style) == style);
+}
+
+TEST_CASE("area_t - bounds checks", "[ansi]")
+{
+    core::area_t area{ { 3, 1 } };
+    const auto ref = area.ref();
+    REQUIRE(ref.contains(core::location_t{ 2, 0 }));
+    REQUIRE_FALSE(ref.contains(core::location_t{ 3, 0 }));
+    REQUIRE_FALSE(ref.contains(core::location_t{ 0, 1 }));
+    REQUIRE_FALSE(ref.contains(core::location_t{ -1, 0 }));
+    REQUIRE(ref.to_index(core::location_t{ 2, 0 }) == 2);
+    REQUIRE_THROWS_AS(ref[(core::location_t{ 3, 0 })], std::runtime_error);
+    REQUIRE_THROWS_AS(area.mut_ref()[(core::location_t{ 0, -1 })], std::runtime_error);
+}
+
+namespace
+{
+
+std::string rows(const core::area_t& area)
+{
+    std::string result;
+    for (int y = 0; y < area.m_extent.height; ++y)
+    {
+        for (const core::cell_t& cell : area.ref().row(y))
+        {
+            result += static_cast<char>(cell.m_code_point);
+        }
+        result += '|';
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("area_t - fill_rect, blit and scroll", "[ansi]")
+{
+    core::area_t area{ { 4, 3 } };
+    const auto ref = area.mut_ref();
+    ref.fill(core::glyph_t{ '.' });
+
+    ref.fill_rect(core::bounds_t{ { 2, -1 }, { 5, 2 } }, core::glyph_t{ '#' });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ "..##|....|....|" }));
+
+    core::area_t sprite{ { 2, 2 } };
+    text(sprite, { 0, 0 }, "ab");
+    text(sprite, { 0, 1 }, "cd");
+    ref.blit(sprite.ref(), core::location_t{ -1, 2 });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ "..##|....|b...|" }));
+    ref.blit(sprite.ref(), core::location_t{ 1, 0 });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ ".ab#|.cd.|b...|" }));
+
+    // Overlapping source and destination
+    ref.blit(area.ref(), core::location_t{ 1, 1 });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ ".ab#|..ab|b.cd|" }));
+
+    ref.scroll(1, core::glyph_t{ '-' });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ "..ab|b.cd|----|" }));
+    ref.scroll(-2);
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ "    |    |..ab|" }));
+    ref.scroll(3, core::glyph_t{ '=' });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ "====|====|====|" }));
+}
+
+TEST_CASE("area_t - sub-views and tiles share the storage", "[ansi]")
+{
+    core::area_t area{ { 5, 4 } };
+    const auto ref = area.mut_ref();
+    ref.fill(core::glyph_t{ '.' });
+
+    const auto view = ref.sub(core::bounds_t{ { 1, 1 }, { 3, 5 } });
+    REQUIRE(view.m_extent == (core::extent_t{ 3, 3 }));
+    REQUIRE_FALSE(view.contiguous());
+    view.fill(core::glyph_t{ 'o' });
+    view[core::location_t{ 0, 0 }] = core::glyph_t{ 'x' };
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ ".....|.xoo.|.ooo.|.ooo.|" }));
+
+    view.scroll(1, core::glyph_t{ '-' });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ ".....|.ooo.|.ooo.|.---.|" }));
+    view.scroll(-1, core::glyph_t{ '+' });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ ".....|.+++.|.ooo.|.ooo.|" }));
+
+    const auto tiles = ref.tiles(core::extent_t{ 2, 3 });
+    REQUIRE(tiles.size() == 6);
+    REQUIRE(tiles[2].m_extent == (core::extent_t{ 1, 3 }));
+    REQUIRE(tiles[5].m_extent == (core::extent_t{ 1, 1 }));
+    REQUIRE(ref.sub(core::bounds_t{ { 7, 9 }, { 2, 2 } }).m_extent == (core::extent_t{ 0, 0 }));
+
+    core::thread_pool_t pool{ 3 };
+    core::render_parallel(
+        pool,
+        tiles,
+        [](const core::area_t::mut_ref_type& tile, std::size_t index)
+        { tile.fill(core::glyph_t{ static_cast<char32_t>('a' + index) }); });
+    REQUIRE_THAT(rows(area), matchers::equal_to(std::string{ "aabbc|aabbc|aabbc|ddeef|" }));
+
+    // A view renders the same as an area holding a copy of it.
+    core::area_t copy{ view.m_extent };
+    copy.mut_ref().blit(view, core::location_t{});
+    REQUIRE(core::diff_renderer_t{}.render(view) == core::diff_renderer_t{}.render(copy.ref()));
+}
+
+TEST_CASE("area_t - blit between overlapping sub-views", "[ansi]")
+{
+    core::area_t area{ { 1, 8 } };
+    const auto ref = area.mut_ref();
+    const auto reset = [&]()
+    {
+        for (int y = 0; y < 8; ++y)
+        {
+            ref[core::location_t{ 0, y }] = core::glyph_t{ static_cast<char32_t>('0' + y) };
+        }
+    };
+    const auto column = [&]()
+    {
+        std::string result;
+        for (int y = 0; y < 8; ++y)
+        {
+            result += static_cast<char>(area.ref().row(y)[0].m_code_point);
+        }
+        return result;
+    };
+
+    // Source below the destination
+    reset();
+    ref.blit(ref.sub(core::bounds_t{ { 0, 4 }, { 1, 4 } }), core::location_t{ 0, 2 });
+    REQUIRE_THAT(column(), matchers::equal_to(std::string{ "01456767" }));
+
+    // Source above the destination, at the same location within each view
+    reset();
+    ref.sub(core::bounds_t{ { 0, 3 }, { 1, 5 } }).blit(ref.sub(core::bounds_t{ { 0, 0 }, { 1, 4 } }), core::location_t{});
+    REQUIRE_THAT(column(), matchers::equal_to(std::string{ "01201237" }));
+}
+
+namespace
+{
+
+core::glyph_t gradient_glyph(int x, int y, int phase)
+{
+    const auto r = static_cast<std::uint8_t>(x + phase);
+    const auto g = static_cast<std::uint8_t>(y * 3 + phase * 7);
+    const auto b = static_cast<std::uint8_t>(phase);
+    return core::glyph_t{ 'g', core::glyph_style_t{ core::true_color_t{ r, g, b }, core::true_color_t{ b, r, g } } };
+}
+
+void draw_gradient(const core::area_t::mut_ref_type& ref, int phase, core::location_t origin = {})
+{
+    for (int y = 0; y < ref.m_extent.height; ++y)
+    {
+        for (int x = 0; x < ref.m_extent.width; ++x)
+        {
+            ref[core::location_t{ x, y }] = gradient_glyph(origin.x + x, origin.y + y, phase);
+        }
+    }
+}
+
+bool holds_gradient(const core::area_t& area, int phase)
+{
+    for (int y = 0; y < area.m_extent.height; ++y)
+    {
+        for (int x = 0; x < area.m_extent.width; ++x)
+        {
+            if (area.ref()[core::location_t{ x, y }] != gradient_glyph(x, y, phase))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("style_table_t - styles no cell uses are reclaimed", "[ansi]")
+{
+    // 12000 new styles a frame; the table holds 65536.
+    core::area_t area{ { 200, 60 } };
+    for (int phase = 0; phase < 12; ++phase)
+    {
+        draw_gradient(area.mut_ref(), phase);
+        REQUIRE(holds_gradient(area, phase));
+    }
+    REQUIRE(area.m_styles->size() <= core::style_table_t::capacity);
+
+    // Filling the whole area starts over; filling a part does not.
+    area.mut_ref().sub(core::bounds_t{ { 0, 0 }, { 200, 30 } }).fill(core::glyph_t{ '.' });
+    REQUIRE(area.m_styles->size() > 1000);
+    const auto id = area.m_styles->id();
+    area.mut_ref().fill(core::glyph_t{ '.', core::glyph_style_t{} | core::fg(core::basic_color_t::red) });
+    REQUIRE(area.m_styles->size() == 2);
+    REQUIRE(area.m_styles->id() != id);
+    REQUIRE(area.ref()[core::location_t{ 199, 59 }]
+            == (core::glyph_t{ '.', core::glyph_style_t{} | core::fg(core::basic_color_t::red) }));
+}
+
+TEST_CASE("style_table_t - areas keep their own styles", "[ansi]")
+{
+    core::area_t lhs{ { 20, 10 } };
+    core::area_t rhs{ { 20, 10 } };
+    draw_gradient(lhs.mut_ref(), 3);
+    rhs.mut_ref().fill(core::glyph_t{ '#', core::glyph_style_t{} | core::bg(core::palette_color_t{ 9 }) });
+
+    // Copies, blits and cell copies convert to the styles of the destination.
+    const core::area_t copy = lhs;
+    lhs.mut_ref().fill(core::glyph_t{});
+    REQUIRE(holds_gradient(copy, 3));
+
+    rhs.mut_ref().blit(copy.ref(), core::location_t{});
+    REQUIRE(holds_gradient(rhs, 3));
+
+    lhs.mut_ref()[core::location_t{ 4, 5 }] = rhs.mut_ref()[core::location_t{ 4, 5 }];
+    REQUIRE(lhs.ref()[core::location_t{ 4, 5 }] == gradient_glyph(4, 5, 3));
+
+    // Frames indexing different tables are compared by their styles.
+    core::diff_renderer_t renderer{};
+    REQUIRE_FALSE(renderer.render(copy.ref()).empty());
+    REQUIRE(renderer.render(rhs.ref()).empty());
+    REQUIRE(renderer.render(copy.ref()).empty());
+    REQUIRE_FALSE(renderer.render(lhs.ref()).empty());
+}
+
+TEST_CASE("style_table_t - parallel renders make room for new styles", "[ansi]")
+{
+    core::area_t area{ { 200, 60 } };
+    const auto tiles = area.mut_ref().tiles(core::extent_t{ 50, 20 });
+    core::thread_pool_t pool{ 3 };
+    for (int phase = 0; phase < 12; ++phase)
+    {
+        core::render_parallel(
+            pool,
+            tiles,
+            [&](const core::area_t::mut_ref_type& tile, std::size_t index)
+            {
+                const auto column = static_cast<int>(index % 4);
+                const auto row = static_cast<int>(index / 4);
+                draw_gradient(tile, phase, core::location_t{ 50 * column, 20 * row });
+            });
+        REQUIRE(holds_gradient(area, phase));
+    }
+}
+
+TEST_CASE("glyph_style_applier_t - composes as a value", "[ansi]")
+{
+    const auto red = core::true_color_t{ 255, 0, 0 };
+    const auto blue = core::true_color_t{ 0, 0, 255 };
+
+    const auto applier = core::fg(red) | core::bg(blue) | core::mode::bold | core::fg(blue);
+    REQUIRE(applier.foreground == core::color_t{ blue });
+    REQUIRE(applier.background == core::color_t{ blue });
+
+    const auto style = core::glyph_style_t{ core::palette_color_t{ 3 }, core::palette_color_t{ 4 }, core::mode::italic };
+    REQUIRE((style | applier) == (core::glyph_style_t{ blue, blue, core::mode::italic | core::mode::bold }));
+    REQUIRE((style | core::mode::dim | core::clear_modes(core::mode::italic))
+            == (core::glyph_style_t{ core::palette_color_t{ 3 }, core::palette_color_t{ 4 }, core::mode::dim }));
+
+    // The later of a set and a clear of the same mode wins.
+    REQUIRE((style | (core::clear_modes(core::mode::bold) | core::mode::bold)).mode_value
+            == (core::mode::italic | core::mode::bold));
+    REQUIRE((style | (core::glyph_style_applier_t{ core::mode::bold } | core::clear_modes(core::mode::bold))).mode_value
+            == core::modes_t{ core::mode::italic });
+
+    REQUIRE(('x' | core::fg(red)) == (core::glyph_t{ 'x', core::glyph_style_t{ red } }));
+    REQUIRE(static_cast<core::glyph_style_t>(core::bg(red) | core::mode::underline)
+            == (core::glyph_style_t{ core::default_color_t{}, red, core::mode::underline }));
+}
+
+TEST_CASE("nearest_palette_color / nearest_basic_color - map true colors", "[ansi]")
+{
+    REQUIRE(core::nearest_palette_color(core::true_color_t{ 255, 0, 0 }).index == 196);
+    REQUIRE(core::nearest_palette_color(core::true_color_t{ 0, 0, 0 }).index == 16);
+    REQUIRE(core::nearest_palette_color(core::true_color_t{ 95, 135, 215 }).index == 16 + 36 * 1 + 6 * 2 + 4);
+    REQUIRE(core::nearest_palette_color(core::true_color_t{ 118, 118, 118 }).index == 243);
+    REQUIRE(core::nearest_palette_color(core::true_color_t{ 238, 238, 238 }).index == 255);
+
+    REQUIRE(core::nearest_basic_color(core::true_color_t{ 250, 10, 10 }) == core::basic_color_t::red);
+    REQUIRE(core::nearest_basic_color(core::true_color_t{ 200, 0, 0 }) == core::basic_color_t::dark_red);
+    REQUIRE(core::nearest_basic_color(core::true_color_t{ 10, 10, 10 }) == core::basic_color_t::black);
+    REQUIRE(core::nearest_basic_color(core::true_color_t{ 130, 125, 128 }) == core::basic_color_t::dark_gray);
+
+    // Every table entry agrees with a search over the palette for the center of its bucket.
+    for (int n = 0; n < (1 << 15); n += 97)
+    {
+        const core::true_color_t c{ static_cast<std::uint8_t>((n >> 10) << 3 | 4),
+                                    static_cast<std::uint8_t>((n >> 5 & 31) << 3 | 4),
+                                    static_cast<std::uint8_t>((n & 31) << 3 | 4) };
+        int best = 16;
+        for (int i = 17; i < 256; ++i)
+        {
+            const auto d = core::detail::distance(c, core::detail::palette_to_rgb(static_cast<std::uint8_t>(i)));
+            best = d < core::detail::distance(c, core::detail::palette_to_rgb(static_cast<std::uint8_t>(best))) ? i : best;
+        }
+        REQUIRE(core::detail::distance(c, core::detail::palette_to_rgb(core::nearest_palette_color(c).index))
+                == core::detail::distance(c, core::detail::palette_to_rgb(static_cast<std::uint8_t>(best))));
+    }
+}
+
+TEST_CASE("buffer_t - downgrades colors to the output depth", "[ansi]")
+{
+    const auto style = core::glyph_style_t{ core::true_color_t{ 255, 0, 0 }, core::palette_color_t{ 21 } };
+    const auto render = [&](core::color_depth_t depth)
+    {
+        core::buffer_t buffer{};
+        buffer.m_color_depth = depth;
+        buffer.set_style(style).write('x');
+        return std::string{ buffer.view() };
+    };
+    REQUIRE_THAT(render(core::color_depth_t::true_color), matchers::equal_to(std::string{ "\033[38;2;255;0;0;48;5;21mx" }));
+    REQUIRE_THAT(render(core::color_depth_t::palette_256), matchers::equal_to(std::string{ "\033[38;5;196;48;5;21mx" }));
+    REQUIRE_THAT(render(core::color_depth_t::basic_16), matchers::equal_to(std::string{ "\033[91;44mx" }));
+    REQUIRE_THAT(render(core::color_depth_t::mono), matchers::equal_to(std::string{ "x" }));
+
+    // Colors which map to the same palette entry need no new sequence.
+    core::buffer_t buffer{};
+    buffer.m_color_depth = core::color_depth_t::palette_256;
+    buffer.set_style(core::glyph_style_t{ core::true_color_t{ 250, 2, 1 } }).write('a');
+    buffer.set_style(core::glyph_style_t{ core::true_color_t{ 252, 4, 0 } }).write('b');
+    REQUIRE_THAT(std::string{ buffer.view() }, matchers::equal_to(std::string{ "\033[38;5;196mab" }));
+}
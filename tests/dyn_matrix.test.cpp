@@ -0,0 +1,135 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <ferrugo/core/arrays/array.hpp>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+using dyn_matrix = core::dyn_matrix<int>;
+
+TEST_CASE("dyn_matrix - storage is aligned", "[dyn_matrix]")
+{
+    const auto m = core::dyn_matrix<float>(3, 5);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(m.m_data.data()) % 64 == 0);
+    REQUIRE_THAT(m, matchers::equal_to(core::dyn_matrix<float>(3, 5, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 })));
+}
+
+TEST_CASE("dyn_matrix - arithmetic", "[dyn_matrix]")
+{
+    const auto a = dyn_matrix(2, 2, { 1, 2, 11, 12 });
+    const auto b = dyn_matrix(2, 2, { 1, 1, 2, 2 });
+    REQUIRE_THAT((-a), matchers::equal_to(dyn_matrix(2, 2, { -1, -2, -11, -12 })));
+    REQUIRE_THAT((a + b), matchers::equal_to(dyn_matrix(2, 2, { 2, 3, 13, 14 })));
+    REQUIRE_THAT((a - b), matchers::equal_to(dyn_matrix(2, 2, { 0, 1, 9, 10 })));
+    REQUIRE_THAT((a * 2), matchers::equal_to(dyn_matrix(2, 2, { 2, 4, 22, 24 })));
+    REQUIRE_THAT((2 * a), matchers::equal_to(dyn_matrix(2, 2, { 2, 4, 22, 24 })));
+    REQUIRE_THAT((a * 3 / 3), matchers::equal_to(a));
+
+    auto c = a;
+    c += b;
+    c -= a;
+    c *= 3;
+    c /= 3;
+    REQUIRE_THAT(c, matchers::equal_to(b));
+
+    REQUIRE_THROWS_AS(a + dyn_matrix(2, 3), std::invalid_argument);
+}
+
+TEST_CASE("dyn_matrix - multiplication", "[dyn_matrix]")
+{
+    REQUIRE_THAT(
+        (dyn_matrix(2, 3, { 1, 2, 3, 4, 5, 6 }) * dyn_matrix(3, 2, { 7, 8, 9, 10, 11, 12 })),
+        matchers::equal_to(dyn_matrix(2, 2, { 58, 64, 139, 154 })));
+    REQUIRE_THROWS_AS(dyn_matrix(2, 3) * dyn_matrix(2, 3), std::invalid_argument);
+}
+
+TEST_CASE("dyn_matrix - views", "[dyn_matrix]")
+{
+    auto a = dyn_matrix(3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    REQUIRE_THAT(a.transpose(), matchers::equal_to(dyn_matrix(3, 3, { 1, 4, 7, 2, 5, 8, 3, 6, 9 })));
+    REQUIRE_THAT(a.submatrix(1, 1, 2, 2), matchers::equal_to(dyn_matrix(2, 2, { 5, 6, 8, 9 })));
+    REQUIRE_THAT(a.transpose().submatrix(0, 1, 2, 2), matchers::equal_to(dyn_matrix(2, 2, { 4, 7, 5, 8 })));
+    REQUIRE_THROWS_AS(a.submatrix(2, 2, 2, 2), std::out_of_range);
+
+    a.submatrix(0, 0, 2, 2).assign(dyn_matrix(2, 2, { 0, 0, 0, 0 }).ref());
+    REQUIRE_THAT(a, matchers::equal_to(dyn_matrix(3, 3, { 0, 0, 3, 0, 0, 6, 7, 8, 9 })));
+
+    const auto b = dyn_matrix(2, 3, { 1, 2, 3, 4, 5, 6 });
+    REQUIRE_THAT((b * b.transpose()), matchers::equal_to(dyn_matrix(2, 2, { 14, 32, 32, 77 })));
+    REQUIRE_THAT((b.transpose() + dyn_matrix(3, 2)), matchers::equal_to(dyn_matrix(3, 2, { 1, 4, 2, 5, 3, 6 })));
+}
+
+TEST_CASE("dyn_matrix - dot and norm", "[dyn_matrix]")
+{
+    const auto v = core::dyn_matrix<double>(1, 3, { 1, 2, 2 });
+    REQUIRE_THAT(core::dot(v, v), matchers::equal_to(9.0));
+    REQUIRE_THAT(core::norm(v.transpose()), matchers::equal_to(9.0));
+    REQUIRE_THAT(core::length(v), matchers::equal_to(3.0));
+}
+
+TEST_CASE("dyn_matrix - large multiplication matches naive product", "[dyn_matrix]")
+{
+    constexpr std::size_t n = 150;
+    constexpr std::size_t k = 130;
+    constexpr std::size_t m = 140;
+    core::dyn_matrix<double> a(n, k);
+    core::dyn_matrix<double> b(k, m);
+    for (std::size_t i = 0; i < n * k; ++i)
+    {
+        a[i] = static_cast<double>((i * 7) % 13) - 6.0;
+    }
+    for (std::size_t i = 0; i < k * m; ++i)
+    {
+        b[i] = static_cast<double>((i * 5) % 11) - 5.0;
+    }
+
+    core::thread_pool_t pool{ 4 };
+    const auto sequential = core::detail::dyn_multiply<double>(a.ref(), b.ref(), nullptr);
+    const auto parallel = core::detail::dyn_multiply<double>(a.ref(), b.ref(), &pool);
+    REQUIRE_THAT(parallel, matchers::equal_to(sequential));
+
+    for (std::size_t r = 0; r < n; r += 37)
+    {
+        for (std::size_t c = 0; c < m; c += 29)
+        {
+            double expected = 0.0;
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                expected += a[{ r, i }] * b[{ i, c }];
+            }
+            REQUIRE_THAT((sequential[{ r, c }]), matchers::equal_to(expected));
+        }
+    }
+}
+
+TEST_CASE("dyn_matrix - compound assignment from an aliasing view", "[dyn_matrix]")
+{
+    core::dyn_matrix<int> a(3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    a += a.transpose();
+    REQUIRE_THAT(a, matchers::equal_to(core::dyn_matrix<int>(3, 3, { 2, 6, 10, 6, 10, 14, 10, 14, 18 })));
+
+    a -= a.transpose();
+    REQUIRE_THAT(a, matchers::equal_to(core::dyn_matrix<int>(3, 3)));
+
+    core::dyn_matrix<int> b(2, 3, { 1, 2, 3, 4, 5, 6 });
+    b += b;
+    REQUIRE_THAT(b, matchers::equal_to(core::dyn_matrix<int>(2, 3, { 2, 4, 6, 8, 10, 12 })));
+}
+
+TEST_CASE("dyn_matrix - assignment from an aliasing view", "[dyn_matrix]")
+{
+    core::dyn_matrix<int> a(3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    a.mut_ref().assign(a.transpose());
+    REQUIRE_THAT(a, matchers::equal_to(core::dyn_matrix<int>(3, 3, { 1, 4, 7, 2, 5, 8, 3, 6, 9 })));
+
+    core::dyn_matrix<int> b(3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    b.submatrix(1, 1, 2, 2).assign(b.submatrix(0, 0, 2, 2));
+    REQUIRE_THAT(b, matchers::equal_to(core::dyn_matrix<int>(3, 3, { 1, 2, 3, 4, 1, 2, 7, 4, 5 })));
+
+    core::dyn_matrix<int> c(3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    c.submatrix(0, 0, 2, 2).assign(c.submatrix(1, 1, 2, 2));
+    REQUIRE_THAT(c, matchers::equal_to(core::dyn_matrix<int>(3, 3, { 5, 6, 3, 8, 9, 6, 7, 8, 9 })));
+
+    const core::dyn_matrix<int> d{ c.transpose() };
+    REQUIRE_THAT(d, matchers::equal_to(core::dyn_matrix<int>(3, 3, { 5, 8, 7, 6, 9, 8, 3, 6, 9 })));
+}
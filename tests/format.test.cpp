@@ -96,3 +96,85 @@ TEST_CASE("join", "")
         matchers::equal_to("Alice has a cat, a dog, a turtle."sv));
 
 }
+
+TEST_CASE("format - cached format string", "[format]")
+{
+    const auto* lhs = core::detail::format_string_cache::get("{} has {}.");
+    const auto* rhs = core::detail::format_string_cache::get("{} has {}.");
+    REQUIRE(lhs != nullptr);
+    REQUIRE(lhs == rhs);
+    REQUIRE_THAT(core::str(*lhs), matchers::equal_to("{0} has {1}."));
+}
+
+namespace
+{
+
+struct format_slot
+{
+    char text[5];
+};
+
+auto format_in_slot(format_slot& slot, const char (&fmt)[5], int value) -> std::string
+{
+    std::copy(std::begin(fmt), std::end(fmt), std::begin(slot.text));
+    const char(&cached)[5] = slot.text;
+    return core::format(cached)(value);
+}
+
+}  // namespace
+
+TEST_CASE("format - cached format string replaced at the same address", "[format]")
+{
+    format_slot slot{};
+    REQUIRE_THAT(format_in_slot(slot, "A{}A", 1), matchers::equal_to("A1A"sv));
+    REQUIRE_THAT(format_in_slot(slot, "{}BB", 2), matchers::equal_to("2BB"sv));
+    REQUIRE_THAT(format_in_slot(slot, "A{}A", 3), matchers::equal_to("A3A"sv));
+}
+
+TEST_CASE("format - cache size is bounded", "[format]")
+{
+    std::vector<format_slot> slots(core::detail::format_string_cache::max_size + 10);
+    for (std::size_t n = 0; n < slots.size(); ++n)
+    {
+        REQUIRE_THAT(format_in_slot(slots[n], "<{}>", static_cast<int>(n)), matchers::equal_to(core::format("<{}>")(n)));
+    }
+    REQUIRE(core::detail::format_string_cache::size() <= core::detail::format_string_cache::max_size);
+}
+
+TEST_CASE("format - mutable buffers are parsed on every call", "[format]")
+{
+    char fmt[] = "{} has {}.";
+    REQUIRE_THAT(core::format(fmt)("Alice", "a cat"), matchers::equal_to("Alice has a cat."sv));
+    fmt[0] = '[';
+    fmt[1] = ']';
+    REQUIRE_THAT(core::format(fmt)("Alice"), matchers::equal_to("[] has Alice."sv));
+}
+
+TEST_CASE("format - long template", "[format]")
+{
+    REQUIRE_THAT(
+        core::format("<table><tr><td class=\"name\">{}</td><td class=\"value\">{}</td></tr>{{}}</table>")("Alice", 42),
+        matchers::equal_to("<table><tr><td class=\"name\">Alice</td><td class=\"value\">42</td></tr>{}</table>"sv));
+}
+
+TEST_CASE("format - unmatched closing bracket", "[format]")
+{
+    REQUIRE_THROWS_AS(core::detail::format_string("Alice has a cat}"), core::format_error);
+    REQUIRE_THROWS_AS(core::detail::format_string("Alice has {"), core::format_error);
+}
+
+TEST_CASE("format - json escaping", "[format]")
+{
+    REQUIRE_THAT(
+        core::format("{{\"name\": \"{:json}\"}}")(std::string{ "Alice \"the cat\" \\ owner\n\tand a very long tail\x01" }),
+        matchers::equal_to("{\"name\": \"Alice \\\"the cat\\\" \\\\ owner\\n\\tand a very long tail\\u0001\"}"sv));
+    REQUIRE_THAT(core::format("{:json}")("żółw"sv), matchers::equal_to("żółw"sv));
+}
+
+TEST_CASE("format - csv escaping", "[format]")
+{
+    REQUIRE_THAT(core::format("{:csv},{:csv}")("Alice", "a cat"), matchers::equal_to("Alice,a cat"sv));
+    REQUIRE_THAT(
+        core::format("{:csv},{:csv}")("Alice, Bob", "a \"cat\""),
+        matchers::equal_to("\"Alice, Bob\",\"a \"\"cat\"\"\""sv));
+}
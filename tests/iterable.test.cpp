@@ -1 +1,199 @@
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+#include <deque>
+#include <ferrugo/core/ranges.hpp>
+#include <list>
+#include <span>
+#include <vector>
 
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+namespace
+{
+
+// An iterator too large for the inline buffer, counting the live copies.
+struct large_iterator
+{
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int*;
+    using reference = const int&;
+
+    inline static int instances = 0;
+
+    const int* m_ptr = nullptr;
+    std::array<char, 64> m_padding = {};
+
+    large_iterator()
+    {
+        ++instances;
+    }
+
+    explicit large_iterator(const int* ptr) : m_ptr{ ptr }
+    {
+        ++instances;
+    }
+
+    large_iterator(const large_iterator& other) : m_ptr{ other.m_ptr }
+    {
+        ++instances;
+    }
+
+    ~large_iterator()
+    {
+        --instances;
+    }
+
+    large_iterator& operator=(const large_iterator&) = default;
+
+    const int& operator*() const
+    {
+        return *m_ptr;
+    }
+
+    large_iterator& operator++()
+    {
+        ++m_ptr;
+        return *this;
+    }
+
+    large_iterator operator++(int)
+    {
+        auto result = *this;
+        ++m_ptr;
+        return result;
+    }
+
+    bool operator==(const large_iterator& other) const
+    {
+        return m_ptr == other.m_ptr;
+    }
+
+    bool operator!=(const large_iterator& other) const
+    {
+        return m_ptr != other.m_ptr;
+    }
+};
+
+struct large_range
+{
+    std::vector<int> m_values;
+
+    large_iterator begin() const
+    {
+        return large_iterator{ m_values.data() };
+    }
+
+    large_iterator end() const
+    {
+        return large_iterator{ m_values.data() + m_values.size() };
+    }
+};
+
+}  // namespace
+
+TEST_CASE("forward_iterable - iterates over erased ranges", "[iterable]")
+{
+    const core::forward_iterable<int> list = std::list<int>{ 1, 2, 3 };
+    REQUIRE_THAT(list, matchers::elements_are(1, 2, 3));
+
+    const core::iterable<int> vector = std::vector<int>{ 4, 5 };
+    auto it = vector.begin();
+    auto copy = it;
+    ++it;
+    REQUIRE(*copy == 4);
+    REQUIRE(*it == 5);
+    copy = it;
+    REQUIRE(copy == it);
+    REQUIRE(++copy == vector.end());
+}
+
+TEST_CASE("forward_iterable - stores large iterators on the heap", "[iterable]")
+{
+    {
+        const core::forward_iterable<int> range = large_range{ { 1, 2, 3 } };
+        REQUIRE_THAT(range, matchers::elements_are(1, 2, 3));
+        auto it = range.begin();
+        auto moved = std::move(it);
+        it = moved;
+        REQUIRE(*it == 1);
+        REQUIRE(large_iterator::instances == 2);
+    }
+    REQUIRE(large_iterator::instances == 0);
+}
+
+TEST_CASE("random_access_iterable - supports standard algorithms", "[iterable]")
+{
+    const core::random_access_iterable<int> range = std::vector<int>{ 1, 3, 5, 7, 9 };
+    REQUIRE(range.size() == 5);
+    REQUIRE(range[3] == 7);
+    REQUIRE(std::lower_bound(range.begin(), range.end(), 6) - range.begin() == 3);
+    REQUIRE_THAT(std::vector<int>(range.begin() + 1, range.end() - 1), matchers::elements_are(3, 5, 7));
+}
+
+TEST_CASE("random_access_iterable - exposes contiguous storage as a segment", "[iterable]")
+{
+    const std::vector<int> values = { 1, 3, 5, 7, 9 };
+    const core::random_access_iterable<int> range = std::span<const int>{ values };
+    REQUIRE(range.segment().data() == values.data());
+    REQUIRE(range.segment().size() == 5U);
+    REQUIRE_THAT(range.segment(3), matchers::elements_are(7, 9));
+
+    int calls = 0;
+    range.for_each_segment(
+        [&](core::random_access_iterable<int>::segment_type segment)
+        {
+            ++calls;
+            REQUIRE(segment.data() == values.data());
+        });
+    REQUIRE(calls == 1);
+
+    const core::random_access_iterable<int> array = std::array<int, 3>{ 2, 4, 6 };
+    REQUIRE_THAT(array.segment(), matchers::elements_are(2, 4, 6));
+}
+
+TEST_CASE("random_access_iterable - copies out segments of other ranges", "[iterable]")
+{
+    const core::random_access_iterable<int> deque = std::deque<int>{ 1, 2, 3, 4, 5, 6, 7 };
+    REQUIRE(deque.segment().empty());
+
+    std::array<int, 3> out = {};
+    deque.copy_out(2, 3, out.data());
+    REQUIRE_THAT(out, matchers::elements_are(3, 4, 5));
+
+    std::vector<std::size_t> sizes;
+    std::vector<int> all;
+    deque.for_each_segment(
+        [&](core::random_access_iterable<int>::segment_type segment)
+        {
+            sizes.push_back(segment.size());
+            all.insert(all.end(), segment.begin(), segment.end());
+        },
+        3);
+    REQUIRE_THAT(sizes, matchers::elements_are(3U, 3U, 1U));
+    REQUIRE_THAT(all, matchers::elements_are(1, 2, 3, 4, 5, 6, 7));
+
+    // Contiguous, but not of the value type
+    const core::random_access_iterable<int> shorts = std::vector<short>{ 1, 2 };
+    REQUIRE(shorts.segment().empty());
+    REQUIRE(shorts.size() == 2);
+}
+
+TEST_CASE("random_access_iterable - rejects invalid segment arguments", "[iterable]")
+{
+    const core::random_access_iterable<int> vector = std::vector<int>{ 1, 2, 3 };
+    REQUIRE(vector.segment(3).empty());
+    REQUIRE_THROWS_AS(vector.segment(4), std::out_of_range);
+    REQUIRE_THROWS_AS(vector.segment(-1), std::out_of_range);
+
+    const core::random_access_iterable<int> deque = std::deque<int>{ 1, 2, 3 };
+    std::array<int, 4> out = {};
+    REQUIRE_THROWS_AS(deque.copy_out(1, 3, out.data()), std::out_of_range);
+    REQUIRE_THROWS_AS(deque.segment(4), std::out_of_range);
+    REQUIRE_THROWS_AS(deque.for_each_segment([](auto) {}, 0), std::invalid_argument);
+}
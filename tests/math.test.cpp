@@ -0,0 +1,214 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cstring>
+#include <ferrugo/core/math.hpp>
+#include <vector>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+namespace
+{
+
+template <class T>
+std::int64_t ulp_distance(T lhs, T rhs)
+{
+    using bits_t = std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>;
+    if (lhs == rhs || (std::isnan(lhs) && std::isnan(rhs)))
+    {
+        return 0;
+    }
+    bits_t l = 0;
+    bits_t r = 0;
+    std::memcpy(&l, &lhs, sizeof(T));
+    std::memcpy(&r, &rhs, sizeof(T));
+    l = l < 0 ? std::numeric_limits<bits_t>::min() - l : l;
+    r = r < 0 ? std::numeric_limits<bits_t>::min() - r : r;
+    // Differences between doubles of opposite sign do not fit; they are far beyond any tolerance anyway.
+    return (l < 0) != (r < 0) && sizeof(T) == 8 ? std::numeric_limits<std::int64_t>::max()
+                                                : std::abs(static_cast<std::int64_t>(l) - static_cast<std::int64_t>(r));
+}
+
+std::vector<float> grid(float first, float last, std::size_t count)
+{
+    std::vector<float> result(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = first + (last - first) * static_cast<float>(i) / static_cast<float>(count - 1);
+    }
+    return result;
+}
+
+// The reference is evaluated in the next wider type: double for float and long double for double.
+template <class Func, class Ref, class T>
+std::int64_t max_ulp_error(Func func, Ref ref, const std::vector<T>& input, math::accuracy acc)
+{
+    using wide_t = std::conditional_t<std::is_same_v<T, float>, double, long double>;
+    std::vector<T> output(input.size());
+    func(std::span<const T>{ input }, std::span<T>{ output }, acc);
+    std::int64_t result = 0;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        result = std::max(result, ulp_distance(output[i], static_cast<T>(ref(static_cast<wide_t>(input[i])))));
+    }
+    return result;
+}
+
+template <class Func, class Ref>
+double max_abs_error(Func func, Ref ref, const std::vector<float>& input)
+{
+    std::vector<float> output(input.size());
+    func(std::span<const float>{ input }, std::span<float>{ output }, math::accuracy::fast);
+    double result = 0.0;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        result = std::max(result, std::abs(output[i] - ref(static_cast<double>(input[i]))));
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("math - batch trigonometry accuracy", "[math]")
+{
+    const auto angles = grid(-5000.0f, 5000.0f, 100'003);
+    const auto sin_ref = [](double x) { return std::sin(x); };
+    const auto cos_ref = [](double x) { return std::cos(x); };
+    const auto tan_ref = [](double x) { return std::tan(x); };
+    const auto cot_ref = [](double x) { return 1.0 / std::tan(x); };
+
+    REQUIRE(max_ulp_error(math::sin, sin_ref, angles, math::accuracy::ulp1) <= 1);
+    REQUIRE(max_ulp_error(math::cos, cos_ref, angles, math::accuracy::ulp1) <= 1);
+    REQUIRE(max_ulp_error(math::tan, tan_ref, angles, math::accuracy::ulp1) <= 1);
+    REQUIRE(max_ulp_error(math::cot, cot_ref, angles, math::accuracy::ulp1) <= 1);
+
+    REQUIRE(max_ulp_error(math::sin, sin_ref, angles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::cos, cos_ref, angles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::tan, tan_ref, angles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::cot, cot_ref, angles, math::accuracy::ulp4) <= 4);
+
+    REQUIRE(max_abs_error(math::sin, sin_ref, angles) < 1e-5);
+    REQUIRE(max_abs_error(math::cos, cos_ref, angles) < 1e-5);
+
+    const auto huge = std::vector<float>{ 1e6f, -3e7f, 1e30f, std::numeric_limits<float>::infinity() };
+    REQUIRE(max_ulp_error(math::sin, sin_ref, huge, math::accuracy::ulp4) <= 1);
+    REQUIRE(max_ulp_error(math::cos, cos_ref, huge, math::accuracy::ulp1) <= 1);
+}
+
+TEST_CASE("math - batch trigonometry accuracy in double precision", "[math]")
+{
+    std::vector<double> angles;
+    for (std::size_t i = 0; i <= 200'000; ++i)
+    {
+        angles.push_back(-2e4 + 4e4 * static_cast<double>(i) / 200'000.0);
+    }
+    // Most bits cancel in the argument reduction next to multiples of pi/2.
+    for (long k = 1; k < 650'000; k += k < 2'000 ? 1 : 97)
+    {
+        const auto nearest = static_cast<double>(k * 1.57079632679489661923132169163975144L);
+        for (const double x : { nearest, std::nextafter(nearest, 0.0), std::nextafter(nearest, 1e7) })
+        {
+            angles.push_back(x);
+            angles.push_back(-x);
+        }
+    }
+    angles.insert(angles.end(), { 1e6, 2e6, 3e7, 1e300, std::numeric_limits<double>::infinity() });
+    const auto sin_ref = [](long double x) { return std::sin(x); };
+    const auto cos_ref = [](long double x) { return std::cos(x); };
+    const auto tan_ref = [](long double x) { return std::tan(x); };
+    const auto cot_ref = [](long double x) { return 1.0L / std::tan(x); };
+
+    REQUIRE(max_ulp_error(math::sin, sin_ref, angles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::cos, cos_ref, angles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::tan, tan_ref, angles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::cot, cot_ref, angles, math::accuracy::ulp4) <= 4);
+}
+
+TEST_CASE("math - batch inverse trigonometry accuracy", "[math]")
+{
+    const auto values = grid(-1.0f, 1.0f, 100'001);
+    const auto asin_ref = [](double x) { return std::asin(x); };
+    const auto acos_ref = [](double x) { return std::acos(x); };
+
+    REQUIRE(max_ulp_error(math::asin, asin_ref, values, math::accuracy::ulp1) <= 1);
+    REQUIRE(max_ulp_error(math::acos, acos_ref, values, math::accuracy::ulp1) <= 1);
+    REQUIRE(max_ulp_error(math::asin, asin_ref, values, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::acos, acos_ref, values, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_abs_error(math::asin, asin_ref, values) < 1e-5);
+    REQUIRE(max_abs_error(math::acos, acos_ref, values) < 1e-5);
+
+    std::vector<double> doubles(200'001);
+    for (std::size_t i = 0; i < doubles.size(); ++i)
+    {
+        doubles[i] = -1.0 + 2.0 * static_cast<double>(i) / static_cast<double>(doubles.size() - 1);
+    }
+    REQUIRE(max_ulp_error(math::asin, [](long double x) { return std::asin(x); }, doubles, math::accuracy::ulp4) <= 4);
+    REQUIRE(max_ulp_error(math::acos, [](long double x) { return std::acos(x); }, doubles, math::accuracy::ulp4) <= 4);
+
+    std::vector<float> out(2);
+    math::asin(std::span<const float>{ std::vector<float>{ 1.5f, -2.0f } }, std::span<float>{ out });
+    REQUIRE(std::isnan(out[0]));
+    REQUIRE(std::isnan(out[1]));
+}
+
+TEST_CASE("math - batch overloads", "[math]")
+{
+    const std::vector<double> angles = { 0.0, 0.5, 1.0, 2.0, 3.0, -1.0, 100.0 };
+    std::vector<double> out(angles.size());
+    for (auto acc : { math::accuracy::ulp1, math::accuracy::ulp4, math::accuracy::fast })
+    {
+        math::sin(std::span<const double>{ angles }, std::span<double>{ out }, acc);
+        for (std::size_t i = 0; i < angles.size(); ++i)
+        {
+            REQUIRE_THAT(out[i], Catch::Matchers::WithinULP(std::sin(angles[i]), 4));
+        }
+    }
+
+    const std::vector<float> squares = { 0.0f, 1.0f, 2.0f, 9.0f, 1e-3f };
+    std::vector<float> roots(squares.size());
+    const auto written = math::sqrt(std::span<const float>{ squares }, std::span<float>{ roots });
+    REQUIRE_THAT(written.size(), matchers::equal_to(squares.size()));
+    for (std::size_t i = 0; i < squares.size(); ++i)
+    {
+        REQUIRE_THAT(roots[i], matchers::equal_to(std::sqrt(squares[i])));
+    }
+
+    const std::vector<float> mixed = { -1.5f, 2.5f, -0.25f };
+    std::vector<float> result(mixed.size());
+    math::abs(std::span<const float>{ mixed }, std::span<float>{ result });
+    REQUIRE(result == std::vector<float>{ 1.5f, 2.5f, 0.25f });
+    math::floor(std::span<const float>{ mixed }, std::span<float>{ result });
+    REQUIRE(result == std::vector<float>{ -2.0f, 2.0f, -1.0f });
+
+    std::vector<float> too_short(1);
+    REQUIRE_THROWS_AS(math::cos(std::span<const float>{ mixed }, std::span<float>{ too_short }), std::invalid_argument);
+
+    REQUIRE_THAT(math::cot(0.5), Catch::Matchers::WithinRel(1.0 / std::tan(0.5), 1e-15));
+}
+
+TEST_CASE("math - batch overloads with quantities", "[math]")
+{
+    using namespace quants::literals;
+
+    const std::vector<quants::angle_t<float>> angles
+        = { quants::angle_t<float>{ 0.0f }, quants::angle_t<float>{ 1.0f }, quants::angle_t<float>{ -2.0f } };
+    std::vector<float> sines(angles.size());
+    math::sin(std::span<const quants::angle_t<float>>{ angles }, std::span<float>{ sines });
+    for (std::size_t i = 0; i < angles.size(); ++i)
+    {
+        REQUIRE_THAT(sines[i], Catch::Matchers::WithinULP(std::sin(angles[i].get()), 4));
+        REQUIRE_THAT(math::sin(angles[i]), Catch::Matchers::WithinULP(std::sin(angles[i].get()), 0));
+    }
+
+    const std::vector<float> ratios = { 0.0f, 0.5f, 1.0f };
+    std::vector<quants::angle_t<float>> arcs(ratios.size());
+    math::acos(std::span<const float>{ ratios }, std::span<quants::angle_t<float>>{ arcs }, math::accuracy::ulp1);
+    REQUIRE_THAT(arcs[1].get(), Catch::Matchers::WithinULP(std::acos(0.5f), 1));
+
+    const std::vector<quants::area_t<float>> areas = { quants::area_t<float>{ 4.0f }, quants::area_t<float>{ 2.25f } };
+    std::vector<quants::length_t<float>> sides(areas.size());
+    math::sqrt(std::span<const quants::area_t<float>>{ areas }, std::span<quants::length_t<float>>{ sides });
+    REQUIRE_THAT(sides[0].get(), matchers::equal_to(2.0f));
+    REQUIRE_THAT(sides[1].get(), matchers::equal_to(1.5f));
+}
@@ -118,3 +118,268 @@ TEST_CASE("vector unit", "[vector]")
         (core::unit(core::vector_2d<float>{ 2, 2 })),  //
         vector_equal(core::vector_2d<float>{ 0.707107F, 0.707107F }));
 }
+
+TEST_CASE("matrix-matrix multiplication - float and double kernels", "[matrix]")
+{
+    REQUIRE_THAT(
+        (core::square_matrix<float, 2>{ 1, 2, 3, 4 } * core::square_matrix<float, 2>{ 5, 6, 7, 8 }),
+        matchers::equal_to(core::square_matrix<float, 2>{ 19, 22, 43, 50 }));
+    REQUIRE_THAT(
+        (core::square_matrix<double, 2>{ 1, 2, 3, 4 } * core::square_matrix<double, 2>{ 5, 6, 7, 8 }),
+        matchers::equal_to(core::square_matrix<double, 2>{ 19, 22, 43, 50 }));
+    REQUIRE_THAT(
+        (core::square_matrix<float, 3>{ 1, 2, 3, 4, 5, 6, 7, 8, 9 } * core::square_matrix<float, 3>{ 9, 8, 7, 6, 5, 4, 3, 2, 1 }),
+        matchers::equal_to(core::square_matrix<float, 3>{ 30, 24, 18, 84, 69, 54, 138, 114, 90 }));
+
+    const auto lhs = core::square_matrix<float, 4>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    const auto rhs = core::square_matrix<float, 4>{ 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+    const auto expected = core::square_matrix<float, 4>{
+        80, 70, 60, 50, 240, 214, 188, 162, 400, 358, 316, 274, 560, 502, 444, 386,
+    };
+    REQUIRE_THAT((lhs * rhs), matchers::equal_to(expected));
+    REQUIRE_THAT(
+        (core::square_matrix<double, 4>{ lhs } * core::square_matrix<double, 4>{ rhs }),
+        matchers::equal_to(core::square_matrix<double, 4>{ expected }));
+}
+
+TEST_CASE("matrix-matrix multiplication - non-square", "[matrix]")
+{
+    REQUIRE_THAT(
+        (core::matrix<double, core::size<2, 3>>{ 1, 2, 3, 4, 5, 6 } * core::matrix<double, core::size<3, 2>>{ 7, 8, 9, 10, 11, 12 }),
+        matchers::equal_to(core::square_matrix<double, 2>{ 58, 64, 139, 154 }));
+}
+
+TEST_CASE("vector-matrix multiplication", "[vector]")
+{
+    const auto m = core::square_matrix_3d<float>{ 0, 1, 0, 0, -1, 0, 0, 0, 0, 0, 1, 0, 10, 20, 30, 1 };
+    REQUIRE_THAT((core::vector_3d<float>{ 1, 2, 3 } * m), vector_equal(core::vector_3d<float>{ 8, 21, 33 }));
+}
+
+TEST_CASE("transform points", "[vector]")
+{
+    const auto m = core::square_matrix_3d<float>{ 0, 1, 0, 0, -1, 0, 0, 0, 0, 0, 1, 0, 10, 20, 30, 1 };
+    const std::vector<core::vector_3d<float>> points = { { 1, 2, 3 }, { 0, 0, 0 }, { -1, 1, 2 } };
+    std::vector<core::vector_3d<float>> result(points.size());
+    core::transform_points(points.data(), points.data() + points.size(), result.data(), m);
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        REQUIRE_THAT(result[i], vector_equal(points[i] * m));
+    }
+
+    const auto md = core::square_matrix_3d<double>{ m };
+    std::vector<core::vector_3d<double>> points_d = { { 1, 2, 3 }, { -1, 1, 2 } };
+    core::transform_points(points_d.data(), points_d.data() + points_d.size(), points_d.data(), md);
+    REQUIRE_THAT(points_d[0], vector_equal(core::vector_3d<double>{ 8, 21, 33 }));
+    REQUIRE_THAT(points_d[1], vector_equal(core::vector_3d<double>{ 9, 19, 32 }));
+}
+
+TEST_CASE("matrix determinant", "[matrix]")
+{
+    REQUIRE_THAT((core::det(matrix{ 1, 2, 3, 4 })), matchers::equal_to(-2));
+    REQUIRE_THAT((core::det(core::square_matrix<int, 3>{ 2, 0, 1, 1, 3, 2, 1, 1, 2 })), matchers::equal_to(6));
+    REQUIRE_THAT(
+        (core::det(core::square_matrix<int, 4>{ 1, 0, 2, -1, 3, 0, 0, 5, 2, 1, 4, -3, 1, 0, 5, 0 })),
+        matchers::equal_to(30));
+    REQUIRE_THAT(
+        (core::det(core::square_matrix<double, 4>{ 0, 2, 0, 0, 1, 0, 0, 0, 0, 0, 0, 3, 0, 0, 4, 0 })),
+        Catch::Matchers::WithinAbs(24.0, 1e-9));
+    REQUIRE_THAT(
+        (core::det(core::square_matrix<double, 4>{ 1, 2, 3, 4, 2, 4, 6, 8, 0, 1, 0, 1, 1, 0, 1, 0 })),
+        matchers::equal_to(0.0));
+    // Rows of very different magnitudes are not mistaken for linear dependence.
+    REQUIRE_THAT(
+        (core::det(core::square_matrix<double, 4>{ 1e10, 0, 0, 0, 0, 1e-8, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 })),
+        Catch::Matchers::WithinRel(100.0, 1e-12));
+    REQUIRE_THAT(
+        (core::det(core::square_matrix<double, 4>{ 1e10, 1, 0, 0, 1, 1e-8, 0, 0, 0, 0, 1, 2, 0, 0, 3, 4 })),
+        Catch::Matchers::WithinRel((100.0 - 1.0) * -2.0, 1e-12));
+}
+
+TEST_CASE("matrix inversion", "[matrix]")
+{
+    REQUIRE_FALSE(core::invert(matrix{ 1, 2, 2, 4 }));
+
+    const auto m = core::square_matrix<double, 5>{ 4, 1, 0, 2, 1, 1, 3, 1, 0, 0, 0, 1, 5, 1, 2, 2, 0, 1, 6, 1, 1, 0, 2, 1, 7 };
+    const auto inverse = core::invert(m);
+    REQUIRE(inverse);
+    const auto identity = m * *inverse;
+    for (std::size_t r = 0; r < 5; ++r)
+    {
+        for (std::size_t c = 0; c < 5; ++c)
+        {
+            REQUIRE_THAT((identity[{ r, c }]), Catch::Matchers::WithinAbs(r == c ? 1.0 : 0.0, 1e-9));
+        }
+    }
+
+    REQUIRE_FALSE(core::invert(core::square_matrix<float, 4>{ 1, 2, 3, 4, 2, 4, 6, 8, 0, 1, 0, 1, 1, 0, 1, 0 }));
+
+    // Singular, but elimination leaves rounding errors instead of zero pivots.
+    const auto rank_two = core::square_matrix<double, 4>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    REQUIRE(core::lu{ rank_two }.singular());
+    REQUIRE_FALSE(core::invert(rank_two));
+    REQUIRE_FALSE(core::solve(rank_two, core::vector<double, 4>{ 1, 2, 3, 4 }));
+    REQUIRE_FALSE(core::invert(core::square_matrix<float, 5>{ 0.1F, 0.2F, 0.3F, 0.4F, 0.5F, 0.3F, 0.6F, 0.9F, 1.2F, 1.5F,
+                                                             1.0F, 0.0F, 1.0F, 0.0F, 1.0F, 0.0F, 1.0F, 0.0F, 1.0F, 0.0F,
+                                                             0.7F, 0.1F, 0.2F, 0.9F, 0.4F }));
+    // A small but regular matrix is not affected by the scale of the tolerance.
+    REQUIRE(core::invert(core::square_matrix<double, 4>{ 1e-9, 0, 0, 0, 0, 1e-9, 0, 0, 0, 0, 1e-9, 0, 0, 0, 0, 1e-9 }));
+    const auto scaled = core::square_matrix<float, 4>{ 1e4F, 0, 0, 0, 0, 1e-3F, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    const auto scaled_inverse = core::invert(scaled);
+    REQUIRE(scaled_inverse);
+    REQUIRE_THAT(((*scaled_inverse)[{ 0, 0 }]), Catch::Matchers::WithinRel(1e-4F, 1e-6F));
+    REQUIRE_THAT(((*scaled_inverse)[{ 1, 1 }]), Catch::Matchers::WithinRel(1e3F, 1e-6F));
+}
+
+TEST_CASE("linear system", "[matrix]")
+{
+    const auto a = core::square_matrix<double, 3>{ 2, 1, -1, -3, -1, 2, -2, 1, 2 };
+    const auto x = core::solve(a, core::vector_3d<double>{ 8, -11, -3 });
+    REQUIRE(x);
+    REQUIRE_THAT(*x, vector_equal(core::vector_3d<double>{ 2, 3, -1 }));
+
+    const auto decomposition = core::lu{ a };
+    REQUIRE_FALSE(decomposition.singular());
+    REQUIRE_THAT(decomposition.det(), Catch::Matchers::WithinAbs(-1.0, 1e-9));
+}
+
+TEST_CASE("element-wise expressions", "[matrix]")
+{
+    using big = core::square_matrix<int, 8>;
+    big a{};
+    big b{};
+    for (std::size_t n = 0; n < big::volume; ++n)
+    {
+        a[n] = static_cast<int>(n);
+        b[n] = 2 * static_cast<int>(n);
+    }
+
+    const auto expr = core::lazy(a) + b * 2 - a / 2;
+    STATIC_REQUIRE(core::is_matrix_expr<std::decay_t<decltype(expr)>>{});
+    STATIC_REQUIRE(std::is_same_v<decltype(matrix{} + matrix{}), matrix>);
+
+    const big result = expr;
+    for (std::size_t n = 0; n < big::volume; ++n)
+    {
+        REQUIRE_THAT(result[n], matchers::equal_to(static_cast<int>(n + 4 * n - n / 2)));
+    }
+    REQUIRE_THAT(core::eval(-(core::lazy(b) - a)), matchers::equal_to(a - b));
+    REQUIRE_THAT(core::eval(2 * core::lazy(a)), matchers::equal_to(b));
+
+    // With every matrix operand lazy, the expression only refers to a and b and reads them when evaluated.
+    const auto single_pass = core::lazy(a) + core::lazy(b) * 2 - core::lazy(a) / 2;
+    STATIC_REQUIRE(sizeof(single_pass) < sizeof(big));
+    b[1] = 100;
+    REQUIRE_THAT(single_pass[1], matchers::equal_to(1 + 200 - 0));
+    b[1] = 2;
+    REQUIRE_THAT(core::eval(single_pass), matchers::equal_to(result));
+
+    big c = a;
+    c += core::lazy(b) - a;
+    REQUIRE_THAT(c, matchers::equal_to(b));
+    c -= b;
+    REQUIRE_THAT(c, matchers::equal_to(big{}));
+
+    c = a;
+    c = c + c;
+    REQUIRE_THAT(c, matchers::equal_to(b));
+
+    REQUIRE_THAT(core::eval(core::lazy(a) + b) * a, matchers::equal_to((a + b) * a));
+    REQUIRE_THAT(core::det(core::lazy(a) - a), matchers::equal_to(0));
+    REQUIRE_THAT(
+        core::distance(core::vector<double, 16>{}, core::vector<double, 16>{ 3, 4 }), Catch::Matchers::WithinAbs(5.0, 1e-9));
+}
+
+namespace
+{
+
+constexpr auto translation(double x, double y) -> core::square_matrix_2d<double>
+{
+    return { 1, 0, 0, 0, 1, 0, x, y, 1 };
+}
+
+constexpr auto scaling(double factor) -> core::square_matrix_2d<double>
+{
+    return { factor, 0, 0, 0, factor, 0, 0, 0, 1 };
+}
+
+constexpr auto camera = scaling(2.0) * translation(3.0, -1.0);
+
+}  // namespace
+
+TEST_CASE("constexpr algebra", "[matrix]")
+{
+    STATIC_REQUIRE(matrix{ 1, 2, 3, 4 } + matrix{ 4, 3, 2, 1 } == matrix{ 5, 5, 5, 5 });
+    STATIC_REQUIRE(-matrix{ 1, 2, 3, 4 } * 2 == matrix{ -2, -4, -6, -8 });
+    STATIC_REQUIRE(matrix{ 1, 2, 3, 4 } * matrix{ 0, 1, 1, 0 } == matrix{ 2, 1, 4, 3 });
+    STATIC_REQUIRE(core::square_matrix<float, 4>{ 1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 4 }
+                       * core::square_matrix<float, 4>{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }
+                   == core::square_matrix<float, 4>{ 1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 4 });
+    STATIC_REQUIRE(core::eval(core::square_matrix<int, 4>{} + core::square_matrix<int, 4>{})[0] == 0);
+
+    STATIC_REQUIRE(core::det(matrix{ 1, 2, 3, 4 }) == -2);
+    STATIC_REQUIRE(core::det(core::square_matrix<int, 4>{ 1, 0, 2, -1, 3, 0, 0, 5, 2, 1, 4, -3, 1, 0, 5, 0 }) == 30);
+    STATIC_REQUIRE(
+        *core::invert(core::square_matrix<double, 2>{ 2, 0, 0, 4 }) == core::square_matrix<double, 2>{ 0.5, 0, 0, 0.25 });
+    STATIC_REQUIRE(
+        *core::invert(core::square_matrix<double, 4>{ 2, 0, 0, 0, 0, 4, 0, 0, 0, 0, 8, 0, 0, 0, 0, 1 })
+        == core::square_matrix<double, 4>{ 0.5, 0, 0, 0, 0, 0.25, 0, 0, 0, 0, 0.125, 0, 0, 0, 0, 1 });
+    STATIC_REQUIRE(!core::invert(matrix{ 1, 2, 2, 4 }));
+    STATIC_REQUIRE(
+        *core::solve(core::square_matrix<double, 2>{ 2, 0, 0, 4 }, core::vector_2d<double>{ 2, 8 })
+        == core::vector_2d<double>{ 1, 2 });
+
+    STATIC_REQUIRE(core::dot(core::vector_3d<int>{ 1, 2, 3 }, core::vector_3d<int>{ 4, 5, 6 }) == 32);
+    STATIC_REQUIRE(
+        core::cross(core::vector_3d<int>{ 1, 0, 0 }, core::vector_3d<int>{ 0, 1, 0 }) == core::vector_3d<int>{ 0, 0, 1 });
+    STATIC_REQUIRE(core::length(core::vector_2d<double>{ 3, 4 }) == 5.0);
+    STATIC_REQUIRE(core::distance(core::vector_2d<double>{ 1, 1 }, core::vector_2d<double>{ 4, 5 }) == 5.0);
+    STATIC_REQUIRE(core::unit(core::vector_2d<double>{ 0, 3 }) == core::vector_2d<double>{ 0, 1 });
+    STATIC_REQUIRE(
+        core::projection(core::vector_2d<double>{ 2, 3 }, core::vector_2d<double>{ 1, 0 })
+        == core::vector_2d<double>{ 2, 0 });
+
+    STATIC_REQUIRE(core::vector_2d<double>{ 1, 1 } * camera == core::vector_2d<double>{ 5, 1 });
+    STATIC_REQUIRE(math::sqrt(2.0) * math::sqrt(2.0) - 2.0 < 1e-15);
+    STATIC_REQUIRE(math::sqrt(1e300) == 1e150);
+    REQUIRE_THAT(math::sqrt(2.0), matchers::equal_to(std::sqrt(2.0)));
+}
+
+namespace
+{
+
+auto local_sum()
+{
+    core::square_matrix_3d<double> a{};
+    core::square_matrix_3d<double> b{};
+    for (std::size_t n = 0; n < a.volume; ++n)
+    {
+        a[n] = static_cast<double>(n);
+        b[n] = 1.0;
+    }
+    return a + b * 2.0;
+}
+
+}  // namespace
+
+TEST_CASE("element-wise operators on matrices return values", "[matrix]")
+{
+    using big = core::square_matrix<int, 8>;
+    big a{};
+    const big b{};
+    auto c = a + b;
+    auto d = -a * 2;
+    STATIC_REQUIRE(std::is_same_v<decltype(c), big>);
+    STATIC_REQUIRE(std::is_same_v<decltype(d), big>);
+    a[0] = 100;
+    REQUIRE(c[0] == 0);
+    REQUIRE(d[0] == 0);
+
+    const auto sum = local_sum();
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(sum)>, core::square_matrix_3d<double>>);
+    REQUIRE(sum[15] == 17.0);
+
+    // Temporaries passed to lazy() are held by value.
+    const auto expr = core::lazy(big{}) + a;
+    a[0] = 1;
+    REQUIRE(core::eval(expr)[0] == 1);
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <ctime>
+#include <ferrugo/core/presenter.hpp>
+#include <string>
+#include <thread>
+
+using namespace ferrugo;
+
+namespace
+{
+
+struct pipe_t
+{
+    int read_fd = -1;
+    int write_fd = -1;
+
+    pipe_t()
+    {
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        read_fd = fds[0];
+        write_fd = fds[1];
+    }
+
+    ~pipe_t()
+    {
+        ::close(read_fd);
+        ::close(write_fd);
+    }
+
+    std::string drain()
+    {
+        const int flags = ::fcntl(read_fd, F_GETFL);
+        ::fcntl(read_fd, F_SETFL, flags | O_NONBLOCK);
+        std::string result;
+        char buffer[4096];
+        for (ssize_t size = 0; (size = ::read(read_fd, buffer, sizeof(buffer))) > 0;)
+        {
+            result.append(buffer, static_cast<std::size_t>(size));
+        }
+        return result;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("presenter_t - updates with a fixed step and presents frames", "[presenter]")
+{
+    pipe_t output{};
+    pipe_t input{};
+    core::presenter_config_t config{};
+    config.frame_period = std::chrono::milliseconds{ 5 };
+    config.update_step = std::chrono::milliseconds{ 2 };
+    config.output_fd = output.write_fd;
+    config.input_fd = input.read_fd;
+
+    std::chrono::nanoseconds simulated{};
+    int frame = 0;
+    core::presenter_t presenter{ core::extent_t{ 8, 2 },
+                                 [&](std::chrono::nanoseconds step) { simulated += step; },
+                                 [&](const core::area_t::mut_ref_type& ref)
+                                 { ref[core::location_t{ ++frame % 8, 1 }] = core::glyph_t{ '*' }; },
+                                 config };
+    REQUIRE(::write(input.write_fd, "q", 1) == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+    presenter.stop();
+
+    const auto stats = presenter.stats();
+    REQUIRE(stats.rendered >= 2);
+    REQUIRE(stats.presented >= 1);
+    REQUIRE(stats.presented + stats.dropped <= stats.rendered);
+    REQUIRE(stats.updates >= 10);
+    REQUIRE(simulated == stats.updates * config.update_step);
+    REQUIRE(presenter.take_input() == "q");
+    REQUIRE(presenter.take_input().empty());
+
+    const std::string bytes = output.drain();
+    REQUIRE(bytes.find("\033[2J") != std::string::npos);
+    REQUIRE(bytes.find('*') != std::string::npos);
+}
+
+TEST_CASE("presenter_t - drops frames while the terminal does not keep up", "[presenter]")
+{
+    pipe_t output{};
+    core::presenter_config_t config{};
+    config.frame_period = std::chrono::milliseconds{ 2 };
+    config.output_fd = output.write_fd;
+    config.flush_timeout = std::chrono::milliseconds{ 10 };
+
+    int frame = 0;
+    core::presenter_t presenter{ core::extent_t{ 200, 100 },
+                                 [](std::chrono::nanoseconds) {},
+                                 [&](const core::area_t::mut_ref_type& ref)
+                                 { ref.fill(core::glyph_t{ static_cast<char32_t>('a' + ++frame % 26) }); },
+                                 config };
+    // Nothing reads the pipe, which fills up after the first frame or two.
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+    REQUIRE(presenter.running());
+    const auto stats = presenter.stats();
+    REQUIRE(stats.rendered >= 10);
+    // Each frame is presented, dropped, being written or waiting.
+    REQUIRE(stats.rendered <= stats.presented + stats.dropped + 2);
+    REQUIRE(stats.dropped > stats.rendered / 2);
+    presenter.stop();
+}
+
+TEST_CASE("presenter_t - rethrows from stop", "[presenter]")
+{
+    pipe_t output{};
+    core::presenter_config_t config{};
+    config.output_fd = output.write_fd;
+    core::presenter_t presenter{ core::extent_t{ 4, 4 },
+                                 [](std::chrono::nanoseconds) {},
+                                 [](const core::area_t::mut_ref_type&) { throw std::runtime_error{ "render failed" }; },
+                                 config };
+    presenter.wait();
+    REQUIRE_THROWS_AS(presenter.stop(), std::runtime_error);
+}
+
+TEST_CASE("presenter_t - finishes the frame being written when stopped", "[presenter]")
+{
+    pipe_t output{};
+    core::presenter_config_t config{};
+    config.output_fd = output.write_fd;
+
+    // The same frame every time: only the first one produces output, more than the pipe holds.
+    const core::extent_t extent{ 400, 300 };
+    core::presenter_t presenter{ extent,
+                                 [](std::chrono::nanoseconds) {},
+                                 [](const core::area_t::mut_ref_type& ref) { ref.fill(core::glyph_t{ 'x' }); },
+                                 config };
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    REQUIRE(presenter.stats().presented == 0);
+
+    std::atomic<bool> stopped = false;
+    std::thread stopper{ [&]()
+                         {
+                             presenter.stop();
+                             stopped = true;
+                         } };
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+    std::string bytes;
+    while (!stopped)
+    {
+        bytes += output.drain();
+    }
+    stopper.join();
+    bytes += output.drain();
+    REQUIRE(std::count(bytes.begin(), bytes.end(), 'x') == extent.width * extent.height);
+}
+
+TEST_CASE("presenter_t - stops polling an input descriptor which is not open", "[presenter]")
+{
+    pipe_t output{};
+    core::presenter_config_t config{};
+    config.output_fd = output.write_fd;
+    config.input_fd = 900;
+    REQUIRE(::fcntl(config.input_fd, F_GETFD) == -1);
+
+    core::presenter_t presenter{
+        core::extent_t{ 4, 4 }, [](std::chrono::nanoseconds) {}, [](const core::area_t::mut_ref_type&) {}, config
+    };
+    const std::clock_t start = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 200 });
+    const double cpu_seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    presenter.stop();
+    // Polling the descriptor again and again would keep a core busy for the whole time.
+    REQUIRE(cpu_seconds < 0.1);
+    REQUIRE(presenter.take_input().empty());
+}
+
+TEST_CASE("presenter_t - releases its descriptors when construction fails", "[presenter]")
+{
+    const int first_free = pipe_t{}.read_fd;
+    core::presenter_config_t config{};
+    config.output_fd = 900;
+    REQUIRE_THROWS_AS(
+        (core::presenter_t{
+            core::extent_t{ 4, 4 }, [](std::chrono::nanoseconds) {}, [](const core::area_t::mut_ref_type&) {}, config }),
+        std::system_error);
+    REQUIRE(pipe_t{}.read_fd == first_free);
+}
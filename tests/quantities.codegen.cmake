@@ -0,0 +1,50 @@
+# Compiles SOURCE to assembly and checks that every quants_NAME function compiles to the same instructions as its raw_NAME
+# counterpart, in the same order and with the same operands. Register names and labels are normalized away, so that
+# only a different choice of registers or a renumbered jump target is tolerated.
+
+execute_process(
+  COMMAND ${COMPILER} -std=c++20 -O2 -S -I${INCLUDE_DIR} ${SOURCE} -o ${OUTPUT}
+  RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL 0)
+  message(FATAL_ERROR "failed to compile ${SOURCE}")
+endif()
+
+file(STRINGS ${OUTPUT} LINES)
+
+set(CURRENT "")
+set(NAMES "")
+foreach(LINE IN LISTS LINES)
+  if(LINE MATCHES "^_?(raw|quants)_([a-z_]+):")
+    set(CURRENT "${CMAKE_MATCH_1}_${CMAKE_MATCH_2}")
+    set(${CURRENT} "")
+    set(${CURRENT}_COUNT 0)
+    if(CMAKE_MATCH_1 STREQUAL "raw")
+      list(APPEND NAMES ${CMAKE_MATCH_2})
+    endif()
+  elseif(LINE MATCHES "^[_A-Za-z].*:" OR LINE MATCHES "^[ \t]*\\.cfi_endproc")
+    set(CURRENT "")
+  elseif(NOT CURRENT STREQUAL "" AND LINE MATCHES "^[ \t]+[a-z]")
+    string(REGEX REPLACE "[ \t]*#.*" "" INSTRUCTION "${LINE}")
+    string(REGEX REPLACE "%[a-z0-9]+" "%reg" INSTRUCTION "${INSTRUCTION}")
+    string(REGEX REPLACE "\\.L[A-Za-z0-9_]+" ".L" INSTRUCTION "${INSTRUCTION}")
+    string(REGEX REPLACE "[ \t]+" " " INSTRUCTION "${INSTRUCTION}")
+    string(STRIP "${INSTRUCTION}" INSTRUCTION)
+    string(APPEND ${CURRENT} "    ${INSTRUCTION}\n")
+    math(EXPR ${CURRENT}_COUNT "${${CURRENT}_COUNT} + 1")
+  endif()
+endforeach()
+
+if(NAMES STREQUAL "")
+  message(FATAL_ERROR "no raw_* functions found in ${OUTPUT}")
+endif()
+
+foreach(NAME IN LISTS NAMES)
+  if(NOT DEFINED quants_${NAME})
+    message(SEND_ERROR "${NAME}: quants_${NAME} not found in ${OUTPUT}")
+  elseif(NOT raw_${NAME} STREQUAL quants_${NAME})
+    message(SEND_ERROR "${NAME}: quants_${NAME} differs from raw_${NAME}\n"
+                       "raw_${NAME}:\n${raw_${NAME}}quants_${NAME}:\n${quants_${NAME}}")
+  else()
+    message(STATUS "${NAME}: ${quants_${NAME}_COUNT} instructions, same as raw")
+  endif()
+endforeach()
@@ -0,0 +1,99 @@
+// Pairs of loops written over raw double and over quants::value_t. quantities.codegen.cmake compiles this file with -O2
+// and requires each raw_NAME / quants_NAME pair to compile to the same instruction stream.
+
+#include <cstddef>
+#include <ferrugo/core/quantities.hpp>
+
+using namespace ferrugo;
+
+extern "C"
+{
+    void raw_step(double* x, double* v, const double* a, std::size_t n, double dt)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            v[i] += a[i] * dt;
+            x[i] += v[i] * dt;
+        }
+    }
+
+    void quants_step(
+        quants::length_t<double>* x,
+        quants::velocity_t<double>* v,
+        const quants::acceleration_t<double>* a,
+        std::size_t n,
+        quants::time_t<double> dt)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            v[i] += a[i] * dt;
+            x[i] += v[i] * dt;
+        }
+    }
+
+    // The sums start from an argument: GCC places the zero of a class-type accumulator (even a struct holding just a
+    // double) ahead of the length check and that of a plain double behind it, which is not what is compared here.
+    double raw_energy(const double* m, const double* v, std::size_t n, double initial)
+    {
+        double result = initial;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            result += 0.5 * m[i] * v[i] * v[i];
+        }
+        return result;
+    }
+
+    quants::energy_t<double> quants_energy(
+        const quants::mass_t<double>* m,
+        const quants::velocity_t<double>* v,
+        std::size_t n,
+        quants::energy_t<double> initial)
+    {
+        quants::energy_t<double> result = initial;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            result += 0.5 * m[i] * v[i] * v[i];
+        }
+        return result;
+    }
+
+    void raw_speed(const double* km, const double* h, double* out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = km[i] / h[i] * (1000.0 / 3600.0);
+        }
+    }
+
+    void quants_speed(
+        const quants::length_t<double, std::kilo>* distance,
+        const quants::time_t<double, quants::scales::hour>* duration,
+        quants::velocity_t<double>* out,
+        std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = distance[i] / duration[i];
+        }
+    }
+
+    std::size_t raw_count_below(const double* x, std::size_t n, double limit)
+    {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            result += x[i] < limit ? 1 : 0;
+        }
+        return result;
+    }
+
+    std::size_t quants_count_below(const quants::length_t<double>* x, std::size_t n, quants::length_t<double> limit)
+    {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            result += x[i] < limit ? 1 : 0;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,218 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <ferrugo/core/quantities.hpp>
+#include <sstream>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+TEST_CASE("quants::array - dimension-correct arithmetic", "[quantities]")
+{
+    using namespace quants::literals;
+
+    // 37 elements: both full registers and the scalar tail are used.
+    quants::length_array<double> distance(37);
+    quants::time_array<double> duration(37);
+    for (std::size_t n = 0; n < distance.size(); ++n)
+    {
+        distance.set(n, quants::length_t<double>{ 3.0 * n });
+        duration.set(n, quants::time_t<double>{ 1.0 + n });
+    }
+
+    const quants::velocity_array<double> velocity = distance / duration;
+    REQUIRE_THAT(velocity.size(), matchers::equal_to(std::size_t{ 37 }));
+    for (std::size_t n = 0; n < velocity.size(); ++n)
+    {
+        REQUIRE(velocity[n] == distance[n] / duration[n]);
+    }
+
+    // Nested operations are fused into one pass; the expression reads the operands only when evaluated.
+    const auto travelled = velocity * duration + 2.0_length;
+    STATIC_REQUIRE(std::is_same_v<decltype(quants::eval(travelled)), quants::length_array<double>>);
+    REQUIRE_THAT(travelled[5].get(), Catch::Matchers::WithinRel(17.0));
+
+    const auto area = quants::eval(distance * distance);
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(area)>, quants::area_array<double>>);
+    REQUIRE(area[4] == 144.0_area);
+
+    const auto frequency = quants::eval(2.0 / duration);
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(frequency)>, quants::frequency_array<double>>);
+    REQUIRE(frequency[1] == quants::frequency_t<double>{ 1.0 });
+
+    const auto ratio = quants::eval(distance / distance[1]);
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(ratio)>, quants::scalar_array<double>>);
+    REQUIRE_THAT(ratio[2].get(), matchers::equal_to(2.0));
+
+    const quants::length_array<double> negated = -distance;
+    REQUIRE(negated[2] == -6.0_length);
+    REQUIRE(std::signbit(quants::eval(-quants::length_array<double>(1))[0].get()));
+    const auto wrapped = quants::eval(-quants::length_array<unsigned>(2, quants::length_t<unsigned>{ 3 }));
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(wrapped)>, quants::length_array<unsigned>>);
+    REQUIRE_THAT(wrapped[1].get(), matchers::equal_to(0U - 3U));
+
+    // Integer scalars are converted to the element type, so the expression stays on the vector path.
+    const auto doubled = distance * 2;
+    STATIC_REQUIRE(std::is_same_v<decltype(doubled)::element_type, double>);
+    STATIC_REQUIRE(decltype(doubled)::simd_type<double>);
+    REQUIRE(doubled[3] == 18.0_length);
+    STATIC_REQUIRE(decltype(2 * distance + 1.0_m)::simd_type<double>);
+}
+
+TEST_CASE("quants::array - assignment reuses storage of the same size", "[quantities]")
+{
+    using namespace quants::literals;
+
+    quants::length_array<double> distance(37, 1.0_m);
+    const quants::length_array<double> offset(37, 0.5_m);
+    const double* data = distance.data();
+
+    distance = distance * 2 + offset;
+    REQUIRE(distance.data() == data);
+    REQUIRE(distance[36] == 2.5_m);
+
+    distance = offset * 3;
+    REQUIRE(distance.data() == data);
+    REQUIRE(distance[0] == 1.5_m);
+
+    REQUIRE_THROWS_AS(distance = offset + quants::length_array<double>(4), std::invalid_argument);
+    distance = quants::length_array<double>(4, 1.0_m) * 2;
+    REQUIRE(distance.size() == 4);
+    REQUIRE(distance[3] == 2.0_m);
+}
+
+TEST_CASE("quants::array - compound assignment and spans", "[quantities]")
+{
+    using namespace quants::literals;
+
+    std::vector<float> storage = { 1.F, 2.F, 3.F, 4.F, 5.F };
+    const auto positions = quants::span<float, quants::quantities::length>{ storage };
+    const auto step = quants::length_array<float>{ quants::length_t<float>{ 0.5F },
+                                                   quants::length_t<float>{ 0.5F },
+                                                   quants::length_t<float>{ 0.5F },
+                                                   quants::length_t<float>{ 0.5F },
+                                                   quants::length_t<float>{ 0.5F } };
+
+    positions += step;
+    positions *= 2.F;
+    REQUIRE(storage == std::vector<float>{ 3.F, 5.F, 7.F, 9.F, 11.F });
+
+    positions -= quants::length_t<float>{ 1.F };
+    positions /= 2.F;
+    REQUIRE(storage == std::vector<float>{ 1.F, 2.F, 3.F, 4.F, 5.F });
+
+    auto total = quants::length_array<float>(5);
+    total += positions;
+    total += quants::span<const float, quants::quantities::length>{ positions };
+    REQUIRE(total[4] == quants::length_t<float>{ 10.F });
+
+    REQUIRE_THROWS_AS(total + quants::length_array<float>(4), std::invalid_argument);
+    REQUIRE_THROWS_AS(total -= quants::length_array<float>(6), std::invalid_argument);
+
+    const auto mixed = quants::eval(quants::length_array<int>(3, quants::length_t<int>{ 2 }) * 1.5);
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(mixed)>, quants::length_array<double>>);
+    REQUIRE(mixed[0] == 3.0_length);
+
+    // A temporary operand is moved into the expression.
+    const auto scaled = quants::length_array<float>(4, quants::length_t<float>{ 1.F }) * 3.F;
+    total = scaled + step[0];
+    REQUIRE(total.size() == 4);
+    REQUIRE(total[3] == quants::length_t<float>{ 3.5F });
+}
+
+TEST_CASE("quants - scaled units", "[quantities]")
+{
+    using namespace quants::literals;
+
+    STATIC_REQUIRE(std::is_same_v<decltype(1.0_km), quants::length_t<double, std::kilo>>);
+    STATIC_REQUIRE(std::is_same_v<decltype(1.0_km + 1.0_m), quants::length_t<double>>);
+    STATIC_REQUIRE(std::is_same_v<decltype(1.0_m + 1.0_mm), quants::length_t<double, std::milli>>);
+    STATIC_REQUIRE(std::is_same_v<decltype(1.0_km / 1.0_h), quants::velocity_t<double, quants::scales::kilometer_per_hour>>);
+    STATIC_REQUIRE(std::is_same_v<decltype(1.0_MPa * 1.0_mm * 1.0_mm), quants::force_t<double>>);
+
+    REQUIRE_THAT((1.5_km + 250.0_m).get(), Catch::Matchers::WithinRel(1750.0));
+    REQUIRE(1.0_km == 1000.0_m);
+    REQUIRE(999.0_m < 1.0_km);
+    REQUIRE_THAT(2.0_ms / 4.0_us, Catch::Matchers::WithinRel(500.0));
+
+    // Crossing scales converts; combining them does not.
+    const quants::velocity_t<double> speed = 72.0_km / 1.0_h;
+    REQUIRE_THAT(speed.get(), Catch::Matchers::WithinRel(20.0));
+    REQUIRE_THAT((12.0_MPa * 2.0_mm * 5.0_mm).get(), Catch::Matchers::WithinRel(120.0));
+    REQUIRE_THAT((1.0 / 4.0_ms).get(), Catch::Matchers::WithinRel(0.25));
+    REQUIRE_THAT(quants::frequency_t<double>{ 1.0 / 4.0_ms }.get(), Catch::Matchers::WithinRel(250.0));
+
+    auto distance = 1.0_km;
+    distance += 500.0_m;
+    distance -= 250.0_m;
+    REQUIRE_THAT(distance.get(), Catch::Matchers::WithinRel(1.25));
+
+    // Integer values convert implicitly only to finer scales.
+    const auto millimeters = quants::length_t<int, std::milli>{ 5 } + quants::length_t<int>{ 2 };
+    STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(millimeters)>, quants::length_t<int, std::milli>>);
+    REQUIRE_THAT(millimeters.get(), matchers::equal_to(2005));
+    STATIC_REQUIRE(std::is_convertible_v<quants::length_t<int>, quants::length_t<int, std::milli>>);
+    STATIC_REQUIRE(!std::is_convertible_v<quants::length_t<int, std::milli>, quants::length_t<int>>);
+    REQUIRE_THAT(quants::unit_cast<std::ratio<1>>(millimeters).get(), matchers::equal_to(2));
+
+    // Arrays hold base units; scaled operands are converted on the way in.
+    quants::length_array<double> offsets(9, 1.0_m);
+    offsets += 2.0_cm;
+    REQUIRE_THAT(offsets[8].get(), Catch::Matchers::WithinRel(1.02));
+    // ... after taking the element type, so that integer millimeters are not truncated to whole meters.
+    offsets += quants::length_t<int, std::milli>{ 500 };
+    REQUIRE_THAT(offsets[8].get(), Catch::Matchers::WithinRel(1.52));
+    const auto shortened = quants::eval(offsets - quants::length_t<int, std::milli>{ 20 });
+    REQUIRE_THAT(shortened[0].get(), Catch::Matchers::WithinRel(1.5));
+}
+
+namespace
+{
+
+constexpr auto integrate(quants::length_t<double> x, quants::velocity_t<double> v, int steps)
+{
+    using namespace quants::literals;
+    for (int i = 0; i < steps; ++i)
+    {
+        x += v * 0.5_s;
+        v -= 1.0_mps;
+    }
+    return x;
+}
+
+}  // namespace
+
+TEST_CASE("quants::value_t - constexpr and zero overhead", "[quantities]")
+{
+    using namespace quants::literals;
+    using length = quants::length_t<double>;
+
+    STATIC_REQUIRE(sizeof(length) == sizeof(double));
+    STATIC_REQUIRE(alignof(length) == alignof(double));
+    STATIC_REQUIRE(std::is_trivially_copyable_v<length>);
+    STATIC_REQUIRE(std::is_standard_layout_v<length>);
+    STATIC_REQUIRE(sizeof(quants::length_t<float, std::kilo>) == sizeof(float));
+
+    STATIC_REQUIRE(noexcept(length{ 1.0 }));
+    STATIC_REQUIRE(noexcept(1.0_m + 1.0_km));
+    STATIC_REQUIRE(noexcept(1.0_m / 1.0_s));
+    STATIC_REQUIRE(noexcept(std::declval<length&>() += 1.0_mm));
+    STATIC_REQUIRE(noexcept(std::declval<length&>() *= 2.0));
+    STATIC_REQUIRE(noexcept(1.0_km < 1.0_m));
+
+    STATIC_REQUIRE(integrate(0.0_m, 4.0_mps, 4) == 5.0_m);
+    STATIC_REQUIRE((2.0_N * 3.0_m).get() == 6.0);
+    STATIC_REQUIRE(quants::length_t<double>{ 1.5_km } == 1500.0_m);
+    STATIC_REQUIRE(quants::unit_cast<std::kilo>(quants::length_t<int>{ 2500 }).get() == 2);
+    STATIC_REQUIRE(-(1.0_m) < +(0.0_m));
+}
+
+TEST_CASE("quants::quantity_t - names", "[quantities]")
+{
+    using namespace quants::literals;
+
+    std::ostringstream os;
+    os << quants::quantities::angle{} << " " << quants::quantities::electric_current{} << " " << 2.0_km;
+    REQUIRE(os.str() == "{angle+1} {electric_current+1} 2 [1000] {length+1}");
+}
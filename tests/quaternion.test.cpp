@@ -0,0 +1,114 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <ferrugo/core/arrays/quaternion.hpp>
+#include <random>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+namespace
+{
+
+template <class T>
+auto random_rigid_transform(std::mt19937& gen) -> core::rigid_transform<T>
+{
+    std::uniform_real_distribution<T> dist{ -1, 1 };
+    const auto axis = core::unit(core::vector_3d<T>{ dist(gen), dist(gen), dist(gen) });
+    return core::rigid_transform<T>{ core::quaternion<T>::from_axis_angle(axis, 3 * dist(gen)),
+                                     core::vector_3d<T>{ 5 * dist(gen), 5 * dist(gen), 5 * dist(gen) } };
+}
+
+template <class T, std::size_t R, std::size_t C>
+void require_close(
+    const core::matrix<T, core::size<R, C>>& actual, const core::matrix<T, core::size<R, C>>& expected, T eps)
+{
+    for (std::size_t n = 0; n < R * C; ++n)
+    {
+        REQUIRE_THAT(actual[n], Catch::Matchers::WithinAbs(expected[n], eps));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("quaternion - rotation", "[quaternion]")
+{
+    const auto q = core::quaternion<double>::from_axis_angle(core::vector_3d<double>{ 0, 0, 1 }, std::acos(-1.0) / 2);
+    require_close(core::vector_3d<double>{ 1, 0, 0 } * q, core::vector_3d<double>{ 0, 1, 0 }, 1e-15);
+    require_close(core::vector_3d<double>{ 0, 1, 0 } * q, core::vector_3d<double>{ -1, 0, 0 }, 1e-15);
+    require_close(core::vector_3d<double>{ 1, 0, 0 } * q, core::vector_3d<double>{ 1, 0, 0 } * core::to_matrix(q), 1e-15);
+    require_close(core::vector_3d<double>{ 1, 2, 3 } * (q * core::inverse(q)), core::vector_3d<double>{ 1, 2, 3 }, 1e-15);
+
+    STATIC_REQUIRE(core::quaternion<int>{} * core::quaternion<int>{ 1, 0, 0, 0 } == core::quaternion<int>{ 1, 0, 0, 0 });
+    STATIC_REQUIRE(core::conjugate(core::quaternion<int>{ 1, 2, 3, 4 }) == core::quaternion<int>{ -1, -2, -3, 4 });
+
+    auto drifted = core::quaternion<double>{ 0, 0, 0, 2 };
+    REQUIRE(core::renormalize(drifted) == core::quaternion<double>{});
+}
+
+TEST_CASE("quaternion - composition matches matrix multiplication", "[quaternion]")
+{
+    std::mt19937 gen{ 3 };
+    for (int i = 0; i < 20; ++i)
+    {
+        const auto a = random_rigid_transform<float>(gen);
+        const auto b = random_rigid_transform<float>(gen);
+        require_close(
+            core::to_matrix(a.rotation * b.rotation), core::to_matrix(a.rotation) * core::to_matrix(b.rotation), 1e-5F);
+        require_close(core::to_matrix(a * b), core::to_matrix(a) * core::to_matrix(b), 1e-4F);
+
+        const auto c = random_rigid_transform<double>(gen);
+        const auto d = random_rigid_transform<double>(gen);
+        require_close(core::to_matrix(c * d), core::to_matrix(c) * core::to_matrix(d), 1e-12);
+
+        const auto p = core::vector_3d<double>{ 1.5, -2.0, 0.25 };
+        require_close(p * c * d, p * (c * d), 1e-12);
+        require_close(p * c * core::inverse(c), p, 1e-12);
+    }
+}
+
+TEST_CASE("quaternion - conversion from matrix", "[quaternion]")
+{
+    std::mt19937 gen{ 5 };
+    for (int i = 0; i < 50; ++i)
+    {
+        const auto t = random_rigid_transform<double>(gen);
+        const auto m = core::to_matrix(t);
+        const auto back = core::to_rigid_transform(m);
+        require_close(core::to_matrix(back), m, 1e-12);
+        require_close(back.translation, t.translation, 1e-12);
+    }
+
+    // 180 degree rotations exercise the branches that do not rely on the trace.
+    using axis_type = core::vector_3d<double>;
+    for (const auto& axis : { axis_type{ 1, 0, 0 }, axis_type{ 0, 1, 0 }, axis_type{ 0, 0, 1 } })
+    {
+        const auto q = core::quaternion<double>::from_axis_angle(axis, std::acos(-1.0));
+        require_close(core::to_matrix(core::to_quaternion(core::to_matrix(q))), core::to_matrix(q), 1e-12);
+    }
+}
+
+TEST_CASE("quaternion - batch point transform", "[quaternion]")
+{
+    std::mt19937 gen{ 11 };
+    std::uniform_real_distribution<float> dist{ -10, 10 };
+    const auto t = random_rigid_transform<float>(gen);
+    const auto m = core::to_matrix(t);
+
+    std::vector<core::vector_3d<float>> points(37);
+    for (auto& p : points)
+    {
+        p = core::vector_3d<float>{ dist(gen), dist(gen), dist(gen) };
+    }
+    std::vector<core::vector_3d<float>> aos(points.size());
+    core::transform_points(points.data(), points.data() + points.size(), aos.data(), m);
+
+    auto soa = core::soa_vectors<float, 3>{ points.begin(), points.end() };
+    core::transform_points(soa, m);
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        require_close(aos[i], points[i] * t, 1e-4F);
+        require_close(soa[i], points[i] * t, 1e-4F);
+    }
+}
@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <ferrugo/core/raster.hpp>
+#include <vector>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+TEST_CASE("rasterize_braille - sets a dot per lit pixel", "[raster]")
+{
+    // 5x5 pixels: 3x2 cells, the last column and row only partly covered
+    std::vector<float> pixels(25, 0.F);
+    const auto set = [&](int x, int y) { pixels[y * 5 + x] = 1.F; };
+    set(0, 0);
+    set(1, 1);
+    set(0, 3);
+    set(1, 3);
+    set(4, 4);
+
+    core::area_t area{ { 4, 3 } };
+    const auto style = core::glyph_style_t{ core::true_color_t{ 0, 255, 0 } };
+    core::rasterize_braille(core::image_ref_t<float>{ pixels.data(), { 5, 5 } }, 0.5F, style, area.mut_ref());
+
+    const auto ref = area.ref();
+    const char32_t dots = 0x2800 + 0x01 + 0x10 + 0x40 + 0x80;
+    REQUIRE(ref[core::location_t{ 0, 0 }] == (core::glyph_t{ core::character_t{ dots }, style }));
+    REQUIRE(ref[core::location_t{ 1, 0 }] == (core::glyph_t{ core::character_t{ U' ' }, style }));
+    REQUIRE(ref[core::location_t{ 2, 1 }] == (core::glyph_t{ core::character_t{ char32_t{ 0x2801 } }, style }));
+    // Outside of the image
+    REQUIRE(ref[core::location_t{ 3, 0 }] == core::glyph_t{});
+    REQUIRE(ref[core::location_t{ 0, 2 }] == core::glyph_t{});
+}
+
+TEST_CASE("rasterize_braille - matches a scalar reference across SIMD widths", "[raster]")
+{
+    const core::extent_t size{ 157, 13 };
+    std::vector<float> pixels(static_cast<std::size_t>(size.width * size.height));
+    for (std::size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = static_cast<float>((i * 7919) % 101) / 100.F;
+    }
+    core::area_t area{ { 80, 4 } };
+    core::rasterize_braille(core::image_ref_t<float>{ pixels.data(), size }, 0.3F, {}, area.mut_ref());
+
+    static constexpr int bits[4][2] = { { 0x01, 0x08 }, { 0x02, 0x10 }, { 0x04, 0x20 }, { 0x40, 0x80 } };
+    for (int cy = 0; cy < 4; ++cy)
+    {
+        for (int cx = 0; cx < 79; ++cx)
+        {
+            int code = 0;
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 2; ++c)
+                {
+                    const int x = 2 * cx + c;
+                    const int y = 4 * cy + r;
+                    if (x < size.width && y < size.height && pixels[y * size.width + x] > 0.3F)
+                    {
+                        code |= bits[r][c];
+                    }
+                }
+            }
+            REQUIRE(area.ref().row(cy)[cx].m_code_point == (code != 0 ? 0x2800 + code : U' '));
+        }
+    }
+}
+
+TEST_CASE("rasterize_half_blocks - colors the halves of each cell", "[raster]")
+{
+    const std::vector<core::true_color_t> colormap = { { 0, 0, 0 }, { 128, 0, 0 }, { 255, 0, 0 } };
+    const std::vector<float> pixels = { 0.F, 0.5F, 1.F, 2.F, 0.26F, -1.F, 0.74F, 0.F };
+    core::area_t area{ { 4, 2 } };
+    core::rasterize_half_blocks(core::image_ref_t<float>{ pixels.data(), { 4, 2 } }, colormap, area.mut_ref());
+
+    const auto ref = area.ref();
+    REQUIRE(ref[core::location_t{ 0, 0 }] == (core::glyph_t{ core::character_t{ U'▀' }, { colormap[0], colormap[1] } }));
+    REQUIRE(ref[core::location_t{ 1, 0 }] == (core::glyph_t{ core::character_t{ U'▀' }, { colormap[1], colormap[0] } }));
+    REQUIRE(ref[core::location_t{ 2, 0 }] == (core::glyph_t{ core::character_t{ U'▀' }, { colormap[2], colormap[1] } }));
+    REQUIRE(ref[core::location_t{ 3, 0 }] == (core::glyph_t{ core::character_t{ U'▀' }, { colormap[2], colormap[0] } }));
+    REQUIRE(ref[core::location_t{ 0, 1 }] == core::glyph_t{});
+
+    const std::vector<core::true_color_t> rgb = { { 1, 2, 3 }, { 4, 5, 6 } };
+    core::rasterize_half_blocks(core::image_ref_t<core::true_color_t>{ rgb.data(), { 1, 2 } }, area.mut_ref());
+    REQUIRE(ref[core::location_t{ 0, 0 }] == (core::glyph_t{ core::character_t{ U'▀' }, { rgb[0], rgb[1] } }));
+    REQUIRE_THROWS_AS(
+        core::rasterize_half_blocks(core::image_ref_t<float>{ pixels.data(), { 4, 2 } }, {}, area.mut_ref()),
+        std::invalid_argument);
+}
+
+TEST_CASE("rasterize - updates only the cells covering the dirty rectangle", "[raster]")
+{
+    std::vector<float> pixels(16 * 16, 1.F);
+    core::area_t area{ { 8, 4 } };
+    core::rasterize_braille(
+        core::image_ref_t<float>{ pixels.data(), { 16, 16 } },
+        0.5F,
+        {},
+        area.mut_ref(),
+        core::bounds_t{ { 3, 5 }, { 2, 1 } });
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 8; ++x)
+        {
+            const bool dirty = y == 1 && (x == 1 || x == 2);
+            REQUIRE(area.ref().row(y)[x].m_code_point == (dirty ? 0x28FF : U' '));
+        }
+    }
+}
+
+TEST_CASE("downsample - averages blocks", "[raster]")
+{
+    std::vector<float> pixels(11 * 5);
+    for (std::size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = static_cast<float>(i);
+    }
+    std::vector<float> out(5 * 2);
+    const auto extent = core::downsample(core::image_ref_t<float>{ pixels.data(), { 11, 5 } }, 2, 2, out.data());
+    REQUIRE(extent == (core::extent_t{ 5, 2 }));
+    REQUIRE(out[0] == (0.F + 1.F + 11.F + 12.F) / 4.F);
+    REQUIRE(out[4] == (8.F + 9.F + 19.F + 20.F) / 4.F);
+    REQUIRE(out[5] == (22.F + 23.F + 33.F + 34.F) / 4.F);
+
+    std::vector<float> out3(3 * 1);
+    const auto extent3 = core::downsample(core::image_ref_t<float>{ pixels.data(), { 11, 5 } }, 3, 5, out3.data());
+    REQUIRE(extent3 == (core::extent_t{ 3, 1 }));
+    REQUIRE(std::abs(out3[1] - 26.F) < 1e-4F);
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <ferrugo/core/arrays/array.hpp>
+#include <random>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+namespace
+{
+
+// Odd count so that both the vector body and the scalar tail are exercised.
+constexpr std::size_t point_count = 37;
+
+template <class T, std::size_t D>
+auto random_points(std::mt19937& gen) -> std::vector<core::vector<T, D>>
+{
+    std::uniform_real_distribution<T> dist{ -10, 10 };
+    std::vector<core::vector<T, D>> result(point_count);
+    for (auto& v : result)
+    {
+        for (std::size_t d = 0; d < D; ++d)
+        {
+            v[d] = dist(gen);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("soa_vectors - layout and conversion", "[soa_vectors]")
+{
+    std::mt19937 gen{ 7 };
+    const auto points = random_points<float, 3>(gen);
+    const auto soa = core::soa_vectors<float, 3>{ points.begin(), points.end() };
+
+    REQUIRE_THAT(soa.size(), matchers::equal_to(point_count));
+    for (std::size_t d = 0; d < 3; ++d)
+    {
+        REQUIRE(reinterpret_cast<std::uintptr_t>(soa.component(d)) % 64 == 0);
+    }
+    REQUIRE_THAT(soa[5], matchers::equal_to(points[5]));
+    REQUIRE_THROWS_AS(soa.at(point_count), std::out_of_range);
+
+    std::vector<core::vector<float, 3>> aos(point_count);
+    soa.copy_to(aos.begin());
+    REQUIRE(aos == points);
+
+    auto other = core::soa_vectors<float, 3>{ { 1, 2, 3 } };
+    other.push_back({ 4, 5, 6 });
+    other.set(0, { 0, 0, 1 });
+    REQUIRE_THAT(other.size(), matchers::equal_to(2u));
+    REQUIRE_THAT(other[0], matchers::equal_to(core::vector<float, 3>{ 0, 0, 1 }));
+    REQUIRE_THAT(other[1], matchers::equal_to(core::vector<float, 3>{ 4, 5, 6 }));
+}
+
+TEST_CASE("soa_vectors - batch kernels match the per-vector functions", "[soa_vectors]")
+{
+    std::mt19937 gen{ 11 };
+    const auto a = random_points<double, 3>(gen);
+    const auto b = random_points<double, 3>(gen);
+    const auto lhs = core::soa_vectors<double, 3>{ a.begin(), a.end() };
+    const auto rhs = core::soa_vectors<double, 3>{ b.begin(), b.end() };
+    const auto axis = core::vector_3d<double>{ 1, 2, -1 };
+
+    const auto dots = core::dot(lhs, rhs);
+    const auto norms = core::norm(lhs);
+    const auto lengths = core::length(lhs);
+    const auto distances = core::distance(lhs, rhs);
+    const auto to_axis = core::distance(lhs, axis);
+    const auto crosses = core::cross(lhs, rhs);
+    const auto projections = core::projection(lhs, axis);
+    auto normalized = lhs;
+    core::normalize(normalized);
+
+    for (std::size_t n = 0; n < point_count; ++n)
+    {
+        REQUIRE_THAT(dots[n], Catch::Matchers::WithinRel(core::dot(a[n], b[n]), 1e-12));
+        REQUIRE_THAT(norms[n], Catch::Matchers::WithinRel(core::norm(a[n]), 1e-12));
+        REQUIRE_THAT(lengths[n], Catch::Matchers::WithinRel(core::length(a[n]), 1e-12));
+        REQUIRE_THAT(distances[n], Catch::Matchers::WithinRel(core::distance(a[n], b[n]), 1e-12));
+        REQUIRE_THAT(to_axis[n], Catch::Matchers::WithinRel(core::distance(a[n], axis), 1e-12));
+        REQUIRE_THAT(core::length(normalized[n]), Catch::Matchers::WithinAbs(1.0, 1e-12));
+        for (std::size_t d = 0; d < 3; ++d)
+        {
+            REQUIRE_THAT(crosses[n][d], Catch::Matchers::WithinAbs(core::cross(a[n], b[n])[d], 1e-9));
+            REQUIRE_THAT(projections[n][d], Catch::Matchers::WithinAbs(core::projection(a[n], axis)[d], 1e-9));
+        }
+    }
+}
+
+TEST_CASE("soa_vectors - edge cases", "[soa_vectors]")
+{
+    auto points = core::soa_vectors<float, 2>{ { 0, 0 }, { 3, 4 }, { 1, 0 } };
+    core::normalize(points, 10.0f);
+    REQUIRE_THAT(points[0], matchers::equal_to(core::vector_2d<float>{ 0, 0 }));
+    REQUIRE_THAT(points[1][0], Catch::Matchers::WithinAbs(6.0f, 1e-5f));
+    REQUIRE_THAT(points[1][1], Catch::Matchers::WithinAbs(8.0f, 1e-5f));
+
+    const auto crosses = core::cross(points, core::vector_2d<float>{ 0, 1 });
+    REQUIRE_THAT(crosses[2], Catch::Matchers::WithinAbs(10.0f, 1e-5f));
+
+    REQUIRE_THROWS_AS(core::dot(points, core::soa_vectors<float, 2>{ { 1, 1 } }), std::invalid_argument);
+}
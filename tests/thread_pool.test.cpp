@@ -0,0 +1,44 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ferrugo/core/thread_pool.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace ferrugo;
+
+TEST_CASE("thread_pool_t - parallel_for calls every index once", "[thread_pool]")
+{
+    core::thread_pool_t pool{ 4 };
+    REQUIRE(pool.size() == 4);
+    for (std::size_t count : { 0, 1, 3, 1000 })
+    {
+        std::vector<int> calls(count, 0);
+        pool.parallel_for(count, [&](std::size_t i) { ++calls[i]; });
+        REQUIRE(calls == std::vector<int>(count, 1));
+    }
+}
+
+TEST_CASE("thread_pool_t - nested loops run on the calling thread", "[thread_pool]")
+{
+    core::thread_pool_t pool{ 3 };
+    std::vector<std::vector<int>> calls(8, std::vector<int>(8, 0));
+    pool.parallel_for(8, [&](std::size_t i) { pool.parallel_for(8, [&](std::size_t j) { ++calls[i][j]; }); });
+    REQUIRE(calls == std::vector<std::vector<int>>(8, std::vector<int>(8, 1)));
+}
+
+TEST_CASE("thread_pool_t - rethrows the first exception", "[thread_pool]")
+{
+    core::thread_pool_t pool{ 4 };
+    REQUIRE_THROWS_AS(pool.parallel_for(
+                          100,
+                          [](std::size_t i)
+                          {
+                              if (i == 17)
+                              {
+                                  throw std::runtime_error{ "failed" };
+                              }
+                          }),
+                      std::runtime_error);
+    int sum = 0;
+    pool.parallel_for(1, [&](std::size_t) { ++sum; });
+    REQUIRE(sum == 1);
+}
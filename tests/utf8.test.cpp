@@ -0,0 +1,84 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ferrugo/core/ansi.hpp>
+#include <ferrugo/core/utf8.hpp>
+
+#include "matchers.hpp"
+
+using namespace ferrugo;
+
+TEST_CASE("utf8_encode / utf8_decode - round trip", "[utf8]")
+{
+    for (const char32_t ch : { U'\0', U'a', U'\x7F', U'\x80', U'ł', U'\x7FF', U'\x800', U'☢', U'\xFFFD', U'\xFFFF',
+                               U'\x10000', U'🙂', U'\x10FFFF' })
+    {
+        char buffer[4] = {};
+        const std::size_t size = core::utf8_encode(ch, buffer);
+        REQUIRE(size != 0);
+        const auto decoded = core::utf8_decode(buffer, buffer + size);
+        REQUIRE(decoded.status == core::utf8_status::ok);
+        REQUIRE(decoded.size == size);
+        REQUIRE(decoded.code_point == ch);
+    }
+}
+
+TEST_CASE("utf8_encode - rejects non-scalar values", "[utf8]")
+{
+    char buffer[4] = {};
+    REQUIRE(core::utf8_encode(0xD800, buffer) == 0);
+    REQUIRE(core::utf8_encode(0xDFFF, buffer) == 0);
+    REQUIRE(core::utf8_encode(0x110000, buffer) == 0);
+}
+
+TEST_CASE("utf8_decode - rejects malformed sequences", "[utf8]")
+{
+    const auto status
+        = [](std::string_view text) { return core::utf8_decode(text.data(), text.data() + text.size()).status; };
+    REQUIRE(status("\x80") == core::utf8_status::invalid);
+    REQUIRE(status("\xC0\xAF") == core::utf8_status::invalid);
+    REQUIRE(status("\xE0\x80\xAF") == core::utf8_status::invalid);
+    REQUIRE(status("\xED\xA0\x80") == core::utf8_status::invalid);
+    REQUIRE(status("\xF4\x90\x80\x80") == core::utf8_status::invalid);
+    REQUIRE(status("\xF8\x88\x80\x80\x80") == core::utf8_status::invalid);
+    REQUIRE(status("\xE2\x98") == core::utf8_status::incomplete);
+    REQUIRE(status("\xE2(\xA2") == core::utf8_status::invalid);
+}
+
+TEST_CASE("utf8_find_invalid - locates the first malformed byte past the ASCII fast path", "[utf8]")
+{
+    const std::string ascii(100, 'x');
+    REQUIRE(core::utf8_valid(ascii));
+    REQUIRE(core::utf8_valid(ascii + "☢" + ascii + "🙂"));
+
+    const std::string text = ascii + "ł" + ascii + "\xC0\xAF" + ascii;
+    REQUIRE(core::utf8_find_invalid(text) - text.data() == 202);
+}
+
+TEST_CASE("utf8_to_u32 / u32_to_utf8 - convert whole strings", "[utf8]")
+{
+    const std::string ascii = "The quick brown fox jumps over the lazy dog";
+    const std::string text = ascii + " ⠺⠽⠯⠗ ☢ " + ascii;
+    const std::u32string decoded = core::utf8_to_u32(text);
+    REQUIRE(decoded.size() == 2 * ascii.size() + 8);
+    REQUIRE(decoded.substr(0, ascii.size()) == core::utf8_to_u32(ascii));
+    REQUIRE(decoded[ascii.size() + 1] == U'⠺');
+    REQUIRE(core::u32_to_utf8(decoded) == text);
+
+    REQUIRE(core::utf8_to_u32("a\xFF" "b") == U"a\xFFFD" "b");
+    REQUIRE(core::u32_to_utf8(std::u32string{ U'a', char32_t{ 0xD800 } }) == "a\xEF\xBF\xBD");
+}
+
+TEST_CASE("multibyte_string - decodes without a locale", "[utf8]")
+{
+    const core::multibyte_string str{ std::string(40, '-') + "⠺⠽⠯⠗ ☢" };
+    REQUIRE(str.size() == 46);
+    REQUIRE(str[0] == core::multibyte{ U'-' });
+    REQUIRE(char32_t(str[40]) == U'⠺');
+    REQUIRE(char32_t(str[45]) == U'☢');
+    REQUIRE_THAT(std::string(str), matchers::equal_to(std::string(40, '-') + "⠺⠽⠯⠗ ☢"));
+
+    const core::multibyte_string invalid{ "a\xC0\xAF" };
+    REQUIRE(invalid.size() == 3);
+    REQUIRE(char32_t(invalid[1]) == core::replacement_character);
+
+    REQUIRE_THROWS_AS(char32_t(core::multibyte{ "\xE2\x98", "\xE2\x98" + 2 }), std::runtime_error);
+}